@@ -0,0 +1,17 @@
+/**
+ * @file amulibc_config.h
+ * @brief
+ *
+ * @author  CJM28241
+ * @date    10/18/2026
+ */
+
+
+#ifndef AMULIBC_CONFIG_H_
+#define AMULIBC_CONFIG_H_
+
+#define __AMU_HOST__					// build the host post-processing modules, see README
+#define __AMU_REMOTE_DEVICE__
+
+
+#endif /* AMULIBC_CONFIG_H_ */
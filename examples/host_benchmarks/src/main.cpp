@@ -0,0 +1,1823 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <thread>
+#include <vector>
+#include <amulib.h>
+
+#define BENCH_SWEEPS			100000
+#define BENCH_POINTS			100
+#define BENCH_DUTS				400
+#define BENCH_SWEEPS_PER_DUT	25
+#define BENCH_TSENSOR_READINGS	1000000
+#define BENCH_TSENSOR_LATENCY	1000000
+#define BENCH_ARCHIVE_SWEEPS	20000
+#define BENCH_TVAC_DEVICES		8
+#define BENCH_TVAC_SECONDS		86400
+#define BENCH_TRACE_SWEEPS		2000
+#define BENCH_TRACE_ADDRESS		0x10
+#define BENCH_SCHED_DEVICES		24
+#define BENCH_SCHED_SECONDS		600
+#define BENCH_TIMESYNC_SAMPLES	60
+#define BENCH_TIMESYNC_POINTS	1000000
+#define BENCH_PERIODIC_DEVICES	4
+#define BENCH_PERIODIC_SECONDS	600
+#define BENCH_PERIODIC_CONV_US	400			// conversion time per channel
+#define BENCH_CAL_DEVICES		16
+#define BENCH_CAL_ADDRESS		0x20
+#define BENCH_CAL_SETTLE_MS		500			// source meter settling time per step
+#define BENCH_CAL_CONV_MS		50			// averaged conversion of one calibration sample
+#define BENCH_ADC_ADDRESS		0x40			// two devices, with and without AMU_CAP_ADC_RAW
+#define BENCH_IDENT_DEVICES		60
+#define BENCH_IDENT_ADDRESS		0x10
+#define BENCH_DISC_BUSES		3
+#define BENCH_DISC_DEVICES		20			// per bus
+#define BENCH_DISC_LEGACY		4			// every 4th device runs firmware without the identity block
+#define BENCH_SWCFG_ADDRESS		0x30
+#define BENCH_SWCFG_MAX_POINTS	1000
+#define BENCH_SWCFG_DELAY_US	200			// settling time per point the cell needs
+#define BENCH_SWCFG_CONV_US		250			// conversion of one point
+#define BENCH_SWCFG_SWEEPS		100
+#define BENCH_STATS_SWEEPS		20000
+#define BENCH_STATS_MEAS		1000000
+
+#define DIODE_VT				0.025852		// thermal voltage at 300K
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+/**
+ * @brief Single-diode cell used to generate synthetic sweeps
+ */
+struct bench_cell_t {
+	double iph;			// photocurrent (A)
+	double i0;			// saturation current (A)
+	double n;			// ideality factor
+	double rs;			// series resistance (ohm)
+	double rsh;			// shunt resistance (ohm)
+};
+
+static double seconds_since(bench_clock_t::time_point start) {
+	return std::chrono::duration<double>(bench_clock_t::now() - start).count();
+}
+
+/**
+ * @brief Current of the cell at voltage v, solved with Newton's method on the implicit single-diode equation
+ */
+static double cell_current(const bench_cell_t& c, double v) {
+	double i = c.iph;
+
+	for (int k = 0; k < 50; k++) {
+		double e = exp((v + i * c.rs) / (c.n * DIODE_VT));
+		double f = c.iph - c.i0 * (e - 1.0) - (v + i * c.rs) / c.rsh - i;
+		double df = -c.i0 * e * c.rs / (c.n * DIODE_VT) - c.rs / c.rsh - 1.0;
+		double step = f / df;
+		i -= step;
+		if (fabs(step) < 1e-12)
+			break;
+	}
+
+	return i;
+}
+
+static double cell_voc(const bench_cell_t& c) {
+	double lo = 0.0, hi = 2.0;
+
+	for (int k = 0; k < 60; k++) {
+		double mid = 0.5 * (lo + hi);
+		if (cell_current(c, mid) > 0.0) lo = mid; else hi = mid;
+	}
+
+	return 0.5 * (lo + hi);
+}
+
+/**
+ * @brief Fills packets with sweeps from 0V to just past Voc of randomly varied cells, with measurement noise
+ */
+static void make_sweeps(std::vector<ivsweep_packet_t>& packets, std::vector<ivsweep_config_t>& configs, std::vector<bench_cell_t>& cells) {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<double> u(-1.0, 1.0);
+	std::normal_distribution<float> noise(0.0f, 1e-5f);
+
+	for (size_t s = 0; s < packets.size(); s++) {
+		bench_cell_t& c = cells[s];
+		c.iph = 0.040 * (1.0 + 0.1 * u(rng));
+		c.i0 = 1e-12 * pow(10.0, u(rng));
+		c.n = 1.3 + 0.2 * u(rng);
+		c.rs = 0.5 + 0.3 * u(rng);
+		c.rsh = 2000.0 * (1.0 + 0.5 * u(rng));
+
+		double vend = cell_voc(c) * 1.02;
+
+		configs[s].numPoints = BENCH_POINTS;
+		configs[s].am0 = 0.1367f;
+		configs[s].area = 4.0f;
+
+		for (uint16_t j = 0; j < BENCH_POINTS; j++) {
+			double v = vend * j / (BENCH_POINTS - 1);
+			packets[s].voltage[j] = (float)v;
+			packets[s].current[j] = (float)cell_current(c, v) + noise(rng);
+		}
+	}
+}
+
+static void bench_analytics(const std::vector<ivsweep_packet_t>& packets, const std::vector<ivsweep_config_t>& configs, const std::vector<bench_cell_t>& cells) {
+	std::vector<ivsweep_meta_t> metas(packets.size());
+	unsigned hw = std::thread::hardware_concurrency();
+	double pmax_err = 0.0, voc_err = 0.0;
+
+	printf("\nIV analytics, %u sweeps of %u points\n", (unsigned)packets.size(), BENCH_POINTS);
+
+	std::vector<unsigned> thread_counts = { 1 };
+
+	if (hw > 1)
+		thread_counts.push_back(hw);
+
+	for (unsigned threads : thread_counts) {
+		bench_clock_t::time_point start = bench_clock_t::now();
+		amu_iv_analyze_batch(packets.data(), configs.data(), packets.size(), metas.data(), threads);
+		double t = seconds_since(start);
+		printf("  %2u threads: %10.0f sweeps/s\n", threads, packets.size() / t);
+	}
+
+	// reference maximum power from a dense sweep of the model for the first 100 cells
+	for (size_t s = 0; s < 100; s++) {
+		double voc = cell_voc(cells[s]);
+		double pmax = 0.0;
+
+		for (int j = 0; j <= 10000; j++) {
+			double v = voc * j / 10000.0;
+			double p = v * cell_current(cells[s], v);
+			if (p > pmax) pmax = p;
+		}
+
+		pmax_err = fmax(pmax_err, fabs(metas[s].pmax - pmax) / pmax);
+		voc_err = fmax(voc_err, fabs(metas[s].voc - voc) / voc);
+	}
+
+	printf("  max relative error: pmax %.2e, voc %.2e\n", pmax_err, voc_err);
+}
+
+/**
+ * @brief Sweeps of BENCH_DUTS cells degrading a little between sweeps, as in a radiation campaign
+ */
+static void make_degrading_sweeps(std::vector<ivsweep_packet_t>& packets, std::vector<ivsweep_config_t>& configs, std::vector<ivsweep_meta_t>& metas, std::vector<uint32_t>& dut_ids, std::vector<bench_cell_t>& cells) {
+	std::mt19937 rng(5678);
+	std::uniform_real_distribution<double> u(-1.0, 1.0);
+	std::normal_distribution<float> noise(0.0f, 1e-5f);
+	size_t s = 0;
+
+	for (uint32_t d = 0; d < BENCH_DUTS; d++) {
+		bench_cell_t c;
+		c.iph = 0.040 * (1.0 + 0.1 * u(rng));
+		c.i0 = 1e-12 * pow(10.0, u(rng));
+		c.n = 1.3 + 0.2 * u(rng);
+		c.rs = 0.5 + 0.3 * u(rng);
+		c.rsh = 2000.0 * (1.0 + 0.5 * u(rng));
+
+		for (uint32_t k = 0; k < BENCH_SWEEPS_PER_DUT; k++, s++) {
+			double vend = cell_voc(c) * 1.02;
+
+			cells[s] = c;
+			dut_ids[s] = d;
+			configs[s].numPoints = BENCH_POINTS;
+			metas[s].tsensor_start = metas[s].tsensor_end = (float)(DIODE_VT / 8.617333262e-5 - 273.15);
+
+			for (uint16_t j = 0; j < BENCH_POINTS; j++) {
+				double v = vend * j / (BENCH_POINTS - 1);
+				packets[s].voltage[j] = (float)v;
+				packets[s].current[j] = (float)cell_current(c, v) + noise(rng);
+			}
+
+			c.iph *= 0.995;
+			c.i0 *= 1.05;
+			c.rsh *= 0.97;
+		}
+	}
+}
+
+static void bench_diode_fit(void) {
+	size_t count = BENCH_DUTS * BENCH_SWEEPS_PER_DUT;
+	std::vector<ivsweep_packet_t> packets(count);
+	std::vector<ivsweep_config_t> configs(count);
+	std::vector<ivsweep_meta_t> metas(count);
+	std::vector<uint32_t> dut_ids(count);
+	std::vector<bench_cell_t> cells(count);
+	std::vector<amu_diode_fit_t> fits(count);
+	AMUThreadPool pool;
+
+	make_degrading_sweeps(packets, configs, metas, dut_ids, cells);
+
+	printf("\nSingle-diode fit, %u DUTs x %u sweeps of %u points, %u threads\n", BENCH_DUTS, BENCH_SWEEPS_PER_DUT, BENCH_POINTS, pool.size());
+
+	for (int warm = 0; warm < 2; warm++) {
+		bench_clock_t::time_point start = bench_clock_t::now();
+		amu_diode_fit_stats_t st = amu_diode_fit_batch(packets.data(), configs.data(), metas.data(), warm ? dut_ids.data() : NULL, count, fits.data(), &pool);
+		double t = seconds_since(start);
+		double rs_err = 0.0, n_err = 0.0;
+
+		for (size_t s = 0; s < count; s++) {
+			if (fits[s].converged) {
+				rs_err = fmax(rs_err, fabs(fits[s].params.rs - cells[s].rs) / cells[s].rs);
+				n_err = fmax(n_err, fabs(fits[s].params.n - cells[s].n) / cells[s].n);
+			}
+		}
+
+		printf("  %s: %8.0f fits/s, %u/%u converged, %.1f iterations/fit (max %u), %u steals\n", warm ? "warm" : "cold",
+			count / t, st.converged, st.fits, (double)st.iterations / st.fits, st.max_iterations, (unsigned)pool.steals());
+		printf("        max rmse %.2e A, max relative error: rs %.2e, n %.2e\n", st.max_rmse, rs_err, n_err);
+	}
+}
+
+/**
+ * @brief Latency of single PT100 conversions, each code depending on the previous result, and bulk throughput over raw readings of three sensors
+ */
+static void bench_tsensor(void) {
+	std::vector<adc_channels_t> raw(BENCH_TSENSOR_READINGS);
+	std::vector<float> temperature(BENCH_TSENSOR_READINGS * 3);
+	std::vector<int32_t> temperature_q16(BENCH_TSENSOR_READINGS * 3);
+	std::mt19937 rng(91011);
+	std::uniform_int_distribution<int32_t> code(1000000, 12000000);		// about -150 C to 300 C
+	amu_tsensor_cal_t cal = {};
+	amu_tsensor_fixed_t fixed;
+	double max_err = 0.0;
+
+	cal.type = AMU_TSENSOR_TYPE_PT100_RTD;
+	cal.gain = 400.0f / 16777216.0f;
+	amu_tsensor_fixed_init(&fixed, &cal);
+
+	for (adc_channels_t& r : raw) {
+		for (uint8_t ch = 0; ch < 3; ch++)
+			r.val.tsensors[ch] = (uint32_t)code(rng);
+	}
+
+	printf("\nTemperature sensors, PT100, %u readings x 3 sensors\n", BENCH_TSENSOR_READINGS);
+
+	bench_clock_t::time_point start = bench_clock_t::now();
+	int32_t c = 6000000;
+	float t = 0.0f;
+	for (uint32_t n = 0; n < BENCH_TSENSOR_LATENCY; n++) {
+		t = amu_tsensor_temperature(&cal, c);
+		c = 6000000 + (int32_t)(t * 16.0f);
+	}
+	printf("  float latency: %6.1f ns/sample (%.3f C)\n", seconds_since(start) * 1e9 / BENCH_TSENSOR_LATENCY, t);
+
+	start = bench_clock_t::now();
+	c = 6000000;
+	int32_t q = 0;
+	for (uint32_t n = 0; n < BENCH_TSENSOR_LATENCY; n++) {
+		q = amu_tsensor_temperature_q16(&fixed, c);
+		c = 6000000 + (q >> 12);
+	}
+	printf("  fixed latency: %6.1f ns/sample (%.3f C)\n", seconds_since(start) * 1e9 / BENCH_TSENSOR_LATENCY, AMU_TSENSOR_Q16_TO_FLOAT(q));
+
+	start = bench_clock_t::now();
+	amu_tsensor_convert(&cal, raw.data(), raw.size(), 3, temperature.data());
+	printf("  float bulk:    %6.1f M samples/s\n", raw.size() * 3 / seconds_since(start) / 1e6);
+
+	start = bench_clock_t::now();
+	amu_tsensor_convert_q16(&fixed, raw.data(), raw.size(), 3, temperature_q16.data());
+	printf("  fixed bulk:    %6.1f M samples/s\n", raw.size() * 3 / seconds_since(start) / 1e6);
+
+	for (size_t n = 0; n < temperature.size(); n++)
+		max_err = fmax(max_err, fabs(AMU_TSENSOR_Q16_TO_FLOAT(temperature_q16[n]) - temperature[n]));
+
+	printf("  max difference fixed to float: %.2e C\n", max_err);
+}
+
+/**
+ * @brief Writes sweeps to an archive in the temp directory, then maps it and scans every current array
+ */
+static bool bench_archive(const std::vector<ivsweep_packet_t>& packets, const std::vector<ivsweep_config_t>& configs) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "amulib_bench.amusweep";
+	AMUSweepArchiveWriter writer;
+	AMUSweepArchive archive;
+	amu_dut_t dut = {};
+	ivsweep_meta_t meta = {};
+	size_t count = (packets.size() < BENCH_ARCHIVE_SWEEPS) ? packets.size() : BENCH_ARCHIVE_SWEEPS;
+	double isc = 0.0;
+	size_t bad = 0;
+
+	std::filesystem::remove(path);
+
+	printf("\nSweep archive, %u sweeps of %u points, all arrays\n", (unsigned)count, BENCH_POINTS);
+
+	bench_clock_t::time_point start = bench_clock_t::now();
+	if (!writer.open(path.string().c_str())) {
+		printf("  cannot create %s\n", path.string().c_str());
+		return false;
+	}
+	for (size_t s = 0; s < count; s++) {
+		snprintf(dut.serial, sizeof(dut.serial), "%u", (unsigned)(s / BENCH_SWEEPS_PER_DUT));
+		writer.append(&dut, &configs[s], &meta, &packets[s], BENCH_POINTS);
+	}
+	writer.close();
+	double t = seconds_since(start);
+	double mbytes = std::filesystem::file_size(path) / 1e6;
+	printf("  write:  %8.1f MB/s (%.1f MB)\n", mbytes / t, mbytes);
+
+	start = bench_clock_t::now();
+	if (!archive.open(path.string().c_str())) {
+		printf("  cannot map %s\n", path.string().c_str());
+		return false;
+	}
+	printf("  open:   %8.2f ms, %u sweeps indexed\n", seconds_since(start) * 1e3, (unsigned)archive.size());
+
+	start = bench_clock_t::now();
+	for (size_t s = 0; s < archive.size(); s++) {
+		amu_archive_sweep_t sweep = archive.sweep(s);
+		isc += sweep.current[0];
+	}
+	t = seconds_since(start);
+	printf("  index:  %8.2f M sweeps/s (isc sum %.3f)\n", archive.size() / t / 1e6, isc);
+
+	start = bench_clock_t::now();
+	double p = 0.0;
+	for (size_t s = 0; s < archive.size(); s++) {
+		amu_archive_sweep_t sweep = archive.sweep(s);
+		for (uint16_t j = 0; j < sweep.numPoints; j++)
+			p += sweep.voltage[j] * sweep.current[j];
+	}
+	t = seconds_since(start);
+	printf("  scan:   %8.0f sweeps/s, %.2f GB/s of IV data (power sum %.3f)\n", archive.size() / t, archive.size() * BENCH_POINTS * 2 * sizeof(float) / t / 1e9, p);
+
+	start = bench_clock_t::now();
+	for (size_t s = 0; s < archive.size(); s++)
+		bad += !archive.verify(s);
+	t = seconds_since(start);
+	printf("  verify: %8.1f MB/s, %u bad records\n", mbytes / t, (unsigned)bad);
+
+	archive.close();
+	std::filesystem::remove(path);
+
+	return bad == 0;
+}
+
+/**
+ * @brief A day of 1 Hz TVAC logging from BENCH_TVAC_DEVICES devices into a time series store, then time window queries
+ */
+static bool bench_timeseries(void) {
+	static const uint8_t channels[] = { AMU_ADC_CH_VOLTAGE, AMU_ADC_CH_CURRENT, AMU_ADC_CH_TSENSOR0, AMU_ADC_CH_TSENSOR1, AMU_ADC_CH_TEMP, AMU_ADC_CH_AVDD };
+	const size_t num_channels = sizeof(channels) / sizeof(channels[0]);
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "amulib_bench.amuts";
+	std::mt19937 rng(1213);
+	std::uniform_int_distribution<int> jitter(-2, 2);
+	std::normal_distribution<float> noise(0.0f, 1.0f);
+	std::vector<float> truth;
+	AMUTimeSeriesWriter writer;
+	AMUTimeSeries store;
+	uint64_t csv_bytes = 0;
+	char line[32];
+
+	std::filesystem::remove(path);
+
+	printf("\nTime series store, %u devices x %u channels at 1 Hz for %u s\n", BENCH_TVAC_DEVICES, (unsigned)num_channels, BENCH_TVAC_SECONDS);
+
+	if (!writer.open(path.string().c_str())) {
+		printf("  cannot create %s\n", path.string().c_str());
+		return false;
+	}
+
+	double encode_time = 0.0;
+	std::vector<float> reading(BENCH_TVAC_DEVICES * num_channels);
+	for (uint32_t s = 0; s < BENCH_TVAC_SECONDS; s++) {
+		int64_t t = 1760000000000LL + s * 1000LL + jitter(rng);		// ms, logger timing jitter
+		float chamber = 20.0f + 60.0f * (float)sin(2.0 * M_PI * s / 21600.0);		// 6 h thermal cycles
+
+		csv_bytes += sizeof("2026-10-18T12:00:00.000000");		// ISO timestamp and newline, as the data logger writes them
+
+		for (uint8_t d = 0; d < BENCH_TVAC_DEVICES; d++) {
+			for (size_t ch = 0; ch < num_channels; ch++) {
+				float& v = reading[d * num_channels + ch];
+
+				switch (channels[ch]) {
+				case AMU_ADC_CH_VOLTAGE: v = 2.6f - 0.006f * chamber + 1e-4f * noise(rng); break;
+				case AMU_ADC_CH_CURRENT: v = 0.04f + 2e-5f * chamber + 1e-6f * noise(rng); break;
+				case AMU_ADC_CH_AVDD: v = 3.3f + 2e-4f * noise(rng); break;
+				default: v = chamber + d + 0.01f * noise(rng); break;
+				}
+
+				csv_bytes += snprintf(line, sizeof(line), ",%.4f", v);
+				v = strtof(line + 1, NULL);				// readings come back as text with 4 decimals
+			}
+		}
+		truth.push_back(reading[2]);
+
+		bench_clock_t::time_point start = bench_clock_t::now();
+		for (uint8_t d = 0; d < BENCH_TVAC_DEVICES; d++) {
+			for (size_t ch = 0; ch < num_channels; ch++)
+				writer.append(AMU_TS_COLUMN(d + 1, channels[ch]), t, reading[d * num_channels + ch]);
+		}
+		encode_time += seconds_since(start);
+	}
+	writer.close();
+
+	uint64_t points = (uint64_t)BENCH_TVAC_SECONDS * BENCH_TVAC_DEVICES * num_channels;
+	uint64_t bytes = std::filesystem::file_size(path);
+	printf("  append: %8.1f M points/s\n", points / encode_time / 1e6);
+	printf("  size:   %8.2f bytes/point, %.1fx smaller than int64+float, %.1fx smaller than CSV\n", (double)bytes / points, points * 12.0 / bytes, (double)csv_bytes / bytes);
+
+	bench_clock_t::time_point start = bench_clock_t::now();
+	if (!store.open(path.string().c_str())) {
+		printf("  cannot open %s\n", path.string().c_str());
+		return false;
+	}
+	printf("  open:   %8.2f ms, %u chunks in %u columns\n", seconds_since(start) * 1e3, (unsigned)store.chunks(), (unsigned)store.columns().size());
+
+	std::vector<int64_t> ts;
+	std::vector<float> vs;
+	uint16_t column = AMU_TS_COLUMN(1, AMU_ADC_CH_TSENSOR0);
+	int64_t first, last;
+	store.timeRange(column, &first, &last);
+
+	start = bench_clock_t::now();
+	bool ok = store.query(column, first, last, ts, vs);
+	double t_all = seconds_since(start);
+	size_t mismatches = (vs.size() == truth.size()) ? 0 : truth.size();
+	for (size_t n = 0; !mismatches && (n < vs.size()); n++)
+		mismatches += (vs[n] != truth[n]);
+	printf("  column: %8.2f ms for %u points, %.1f M points/s, %s\n", t_all * 1e3, (unsigned)vs.size(), vs.size() / t_all / 1e6, (ok && !mismatches) ? "lossless" : "MISMATCH");
+
+	const uint32_t queries = 1000;
+	size_t found = 0;
+	start = bench_clock_t::now();
+	for (uint32_t q = 0; q < queries; q++) {
+		int64_t from = first + (int64_t)(rng() % (BENCH_TVAC_SECONDS - 3600)) * 1000;
+		ts.clear();
+		vs.clear();
+		store.query(AMU_TS_COLUMN(1 + q % BENCH_TVAC_DEVICES, channels[q % num_channels]), from, from + 3600 * 1000, ts, vs);
+		found += vs.size();
+	}
+	printf("  1 h window: %6.1f us/query, %u points each\n", seconds_since(start) * 1e6 / queries, (unsigned)(found / queries));
+
+	store.close();
+	std::filesystem::remove(path);
+
+	return ok && !mismatches;
+}
+
+/**
+ * @brief Stand-in for a device on the bus, always has a sweep of BENCH_POINTS points ready
+ */
+static int8_t sim_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	static uint16_t sequence = 0;
+
+	if (address != BENCH_TRACE_ADDRESS)
+		return -1;
+	if (!read) {
+		if (reg == AMU_REG_DATA_PTR_SWEEP_STATUS)
+			sequence++;
+		return 0;
+	}
+
+	memset(data, 0, len);
+
+	if (reg == AMU_REG_DATA_PTR_SWEEP_STATUS) {
+		amu_sweep_status_t status = {};
+		status.sequence = sequence;
+		status.state = AMU_SWEEP_BUF_READY;
+		status.numPoints = BENCH_POINTS;
+		memcpy(data, &status, (len < sizeof(status)) ? len : sizeof(status));
+	}
+	else if ((reg == AMU_REG_DATA_PTR_VOLTAGE) || (reg == AMU_REG_DATA_PTR_CURRENT)) {
+		float* f = (float*)data;
+		for (size_t j = 0; j < len / sizeof(float); j++)
+			f[j] = (reg == AMU_REG_DATA_PTR_VOLTAGE) ? 0.027f * j : 0.04f - 1e-12f * expf(0.027f * j / 0.034f) + 1e-6f * (sequence % 7);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief The sweep readout of AMU::readSweepBuffer(), through the transfer layer the AMU class and SCPI use
+ */
+static void trace_read_sweep(ivsweep_packet_t* packet, bool timestamps) {
+	amu_sweep_status_t status;
+
+	amu_dev_transfer(BENCH_TRACE_ADDRESS, AMU_REG_DATA_PTR_SWEEP_STATUS, (uint8_t*)&status, sizeof(status), AMU_TWI_TRANSFER_READ);
+	if (timestamps)
+		amu_dev_transfer(BENCH_TRACE_ADDRESS, AMU_REG_DATA_PTR_TIMESTAMP, (uint8_t*)packet->timestamp, sizeof(uint32_t) * BENCH_POINTS, AMU_TWI_TRANSFER_READ);
+	amu_dev_transfer(BENCH_TRACE_ADDRESS, AMU_REG_DATA_PTR_VOLTAGE, (uint8_t*)packet->voltage, sizeof(float) * BENCH_POINTS, AMU_TWI_TRANSFER_READ);
+	amu_dev_transfer(BENCH_TRACE_ADDRESS, AMU_REG_DATA_PTR_CURRENT, (uint8_t*)packet->current, sizeof(float) * BENCH_POINTS, AMU_TWI_TRANSFER_READ);
+	amu_dev_transfer(BENCH_TRACE_ADDRESS, AMU_REG_DATA_PTR_SWEEP_STATUS, (uint8_t*)&status.sequence, sizeof(uint16_t), AMU_TWI_TRANSFER_WRITE);
+}
+
+/**
+ * @brief Records a session of sweep readouts against sim_transfer, then replays it without the device
+ */
+static bool bench_trace(void) {
+	std::filesystem::path path = std::filesystem::temp_directory_path() / "amulib_bench.amutrace";
+	amu_device_t* dev = (amu_device_t*)amu_dev_init(AMUTraceRecorder::transfer);
+	amu_transfer_fptr_t transport = dev->transfer;
+	static ivsweep_packet_t packet;
+	std::vector<ivsweep_meta_t> recorded(BENCH_TRACE_SWEEPS), replayed(BENCH_TRACE_SWEEPS);
+	size_t mismatches = 0;
+
+	printf("\nTrace record and replay, %u sweep readouts\n", BENCH_TRACE_SWEEPS);
+
+	dev->transfer = AMUTraceRecorder::transfer;
+	if (!AMUTraceRecorder::start(path.string().c_str(), sim_transfer)) {
+		printf("  cannot create %s\n", path.string().c_str());
+		dev->transfer = transport;
+		return false;
+	}
+
+	bench_clock_t::time_point start = bench_clock_t::now();
+	for (uint32_t n = 0; n < BENCH_TRACE_SWEEPS; n++) {
+		trace_read_sweep(&packet, false);
+		amu_iv_analyze(packet.voltage, packet.current, BENCH_POINTS, NULL, &recorded[n]);
+	}
+	double t_record = seconds_since(start);
+	uint32_t transfers = AMUTraceRecorder::transfers();
+	AMUTraceRecorder::stop();
+
+	double mbytes = std::filesystem::file_size(path) / 1e6;
+	printf("  record: %8.0f transfers/s, %u transfers, %.2f MB\n", transfers / t_record, transfers, mbytes);
+
+	start = bench_clock_t::now();
+	if (!AMUTraceReplay::load(path.string().c_str())) {
+		printf("  cannot load %s\n", path.string().c_str());
+		dev->transfer = transport;
+		return false;
+	}
+	printf("  load:   %8.2f ms\n", seconds_since(start) * 1e3);
+
+	dev->transfer = AMUTraceReplay::transfer;
+
+	start = bench_clock_t::now();
+	for (uint32_t n = 0; n < BENCH_TRACE_SWEEPS; n++) {
+		trace_read_sweep(&packet, false);
+		amu_iv_analyze(packet.voltage, packet.current, BENCH_POINTS, NULL, &replayed[n]);
+		mismatches += (memcmp(&recorded[n], &replayed[n], sizeof(ivsweep_meta_t)) != 0);
+	}
+	double t_replay = seconds_since(start);
+	bool ok = (AMUTraceReplay::divergences() == 0) && (mismatches == 0);
+	printf("  replay: %8.0f transfers/s, %.0f MB/s, %u divergences, %u results differ\n", AMUTraceReplay::position() / t_replay, mbytes / t_replay, AMUTraceReplay::divergences(), (unsigned)mismatches);
+
+	// a readout path that also fetches the timestamps no longer matches the recorded session
+	AMUTraceReplay::rewind();
+	trace_read_sweep(&packet, true);
+	printf("  changed path: %u divergent calls in one readout\n", AMUTraceReplay::divergences());
+	ok &= (AMUTraceReplay::divergences() != 0);
+
+	AMUTraceReplay::unload();
+	dev->transfer = transport;
+	std::filesystem::remove(path);
+
+	return ok;
+}
+
+/**
+ * @brief Simulated bus for the scheduler, every bus operation advances a shared clock by its modelled bus time
+ */
+static struct {
+	const amu_sched_t* sched;
+	uint64_t clock_us;
+	uint64_t bus_us;
+	uint64_t complete_us[256];
+	uint32_t actual_us[256];
+} sim_bus;
+
+static uint32_t sim_millis(void) {
+	return (uint32_t)(sim_bus.clock_us / 1000);
+}
+
+static void sim_bus_use(uint32_t us) {
+	sim_bus.clock_us += us;
+	sim_bus.bus_us += us;
+}
+
+static void sim_cal_delay(uint32_t ms) {
+	sim_bus.clock_us += (uint64_t)ms * 1000;
+}
+
+static int8_t sim_trigger(uint8_t address) {
+	sim_bus_use(amu_sched_bus_us(sim_bus.sched, 1));
+	sim_bus.complete_us[address] = sim_bus.clock_us + sim_bus.actual_us[address];
+	return 0;
+}
+
+static uint8_t sim_busy(uint8_t address) {
+	sim_bus_use(amu_sched_bus_us(sim_bus.sched, 1));
+	return sim_bus.clock_us < sim_bus.complete_us[address];
+}
+
+static int8_t sim_readout(uint8_t address, void* ctx) {
+	const amu_sched_t* sched = (const amu_sched_t*)ctx;
+
+	for (uint8_t i = 0; i < sched->num; i++) {
+		if (sched->dev[i].address == address)
+			sim_bus_use(amu_sched_bus_us(sched, sched->dev[i].readout_bytes));
+	}
+	return 0;
+}
+
+/**
+ * @brief Sweeps per minute of BENCH_SCHED_DEVICES devices on a simulated 400 kHz bus, triggered together and read in turn, against the scheduler
+ */
+static void bench_sched_case(const char* name, uint8_t numPoints, uint8_t arrays) {
+	static amu_sched_t sched;
+	std::mt19937 rng(1415);
+	std::uniform_int_distribution<int> delay(1, 3), averages(1, 4);
+	std::uniform_real_distribution<double> error(0.85, 1.15);
+	ivsweep_config_t config = {};
+
+	amu_sched_init(&sched, sim_readout, &sched, AMU_SCHED_DEFAULT_BUS_HZ);
+	sched.ops.trigger = sim_trigger;
+	sched.ops.busy = sim_busy;
+	sched.ops.millis = sim_millis;
+	sim_bus.sched = &sched;
+
+	config.numPoints = numPoints;
+	config.sweep_averages = 1;
+	for (uint8_t d = 0; d < BENCH_SCHED_DEVICES; d++) {
+		uint8_t address = 0x10 + d;
+		config.delay = (uint8_t)delay(rng);
+		config.adc_averages = (uint8_t)averages(rng);
+		amu_sched_add(&sched, address, &config, (uint16_t)(arrays * sizeof(float) * numPoints));
+		sim_bus.actual_us[address] = (uint32_t)(amu_sched_sweep_us(&sched, &config) * error(rng));		// the model is off by up to 15%
+	}
+
+	// baseline: trigger every device, poll until all are done, read them out one after the other
+	uint64_t end_us = BENCH_SCHED_SECONDS * 1000000ULL;
+	uint32_t sweeps = 0;
+	sim_bus.clock_us = sim_bus.bus_us = 0;
+	while (sim_bus.clock_us < end_us) {
+		for (uint8_t d = 0; d < sched.num; d++)
+			sim_trigger(sched.dev[d].address);
+		for (uint8_t d = 0; d < sched.num; d++) {
+			while (sim_busy(sched.dev[d].address))
+				sim_bus.clock_us += 1000;
+		}
+		for (uint8_t d = 0; d < sched.num; d++)
+			sim_readout(sched.dev[d].address, &sched);
+		sweeps += sched.num;
+	}
+	double naive = sweeps * 60.0 / (sim_bus.clock_us / 1e6);
+	double naive_bus = (double)sim_bus.bus_us / sim_bus.clock_us;
+
+	sim_bus.clock_us = sim_bus.bus_us = 0;
+	amu_sched_start(&sched);
+	while (sim_bus.clock_us < end_us) {
+		uint32_t wait = amu_sched_poll(&sched);
+		sim_bus.clock_us += (uint64_t)wait * 1000;
+	}
+	double scheduled = amu_sched_sweeps(&sched) * 60.0 / (sim_bus.clock_us / 1e6);
+
+	// upper bound, each device sweeping back to back or the bus never idle
+	double device_bound = 0.0, bus_load = 0.0;
+	for (uint8_t d = 0; d < sched.num; d++) {
+		double cycle_s = (sim_bus.actual_us[sched.dev[d].address] + sched.dev[d].readout_us) / 1e6;
+		device_bound += 60.0 / cycle_s;
+		bus_load += sched.dev[d].readout_us / 1e6;
+	}
+	double bound = fmin(device_bound, 60.0 / bus_load * sched.num);
+
+	printf("  %-22s together %6.0f/min (bus %2.0f%%), scheduled %6.0f/min (bus %2.0f%%), bound %6.0f/min\n", name, naive, naive_bus * 100.0, scheduled, (double)sim_bus.bus_us / sim_bus.clock_us * 100.0, bound);
+}
+
+static void bench_sched(void) {
+	printf("\nSweep scheduler, %u devices on a simulated 400 kHz bus for %u s\n", BENCH_SCHED_DEVICES, BENCH_SCHED_SECONDS);
+
+	bench_sched_case("100 points, IV:", 100, 2);
+	bench_sched_case("250 points, 5 arrays:", 250, 5);
+}
+
+/**
+ * @brief Device clock 50 ppm fast and a day off, sampled every 10 s with up to 3 ms of bus latency, then mapped back to host time
+ */
+static void bench_timesync(void) {
+	std::mt19937 rng(1617);
+	std::uniform_int_distribution<int> latency(0, 3);
+	amu_timesync_t sync;
+	const double rate = 1.0 + 50e-6;
+	const uint64_t device_offset = 86400000ULL + 12345ULL;
+	double max_err = 0.0;
+
+	auto device_clock = [&](double host_ms) { return (uint32_t)(uint64_t)(host_ms * rate + device_offset); };
+
+	printf("\nClock model, 50 ppm drift, %u samples 10 s apart\n", BENCH_TIMESYNC_SAMPLES);
+
+	amu_timesync_reset(&sync);
+	double host = 1000.0;
+	for (uint32_t n = 0; n < BENCH_TIMESYNC_SAMPLES; n++) {
+		double before = host;
+		double read = before + latency(rng) * 0.5;		// clock read somewhere within the round trip
+		double after = read + latency(rng) * 0.5;
+		amu_timesync_add(&sync, (uint32_t)before, device_clock(read), (uint32_t)after);
+		host = after + 10000.0;
+	}
+
+	std::vector<uint32_t> stamps(BENCH_TIMESYNC_POINTS);
+	std::vector<double> truth(BENCH_TIMESYNC_POINTS);
+	for (uint32_t n = 0; n < BENCH_TIMESYNC_POINTS; n++) {
+		truth[n] = host + n * 0.6;			// ten minutes past the last sample
+		stamps[n] = device_clock(truth[n]);
+	}
+
+	bench_clock_t::time_point start = bench_clock_t::now();
+	amu_timesync_map(&sync, stamps.data(), stamps.data(), stamps.size());
+	double t = seconds_since(start);
+
+	for (uint32_t n = 0; n < BENCH_TIMESYNC_POINTS; n++)
+		max_err = fmax(max_err, fabs((double)stamps[n] - truth[n]));
+
+	printf("  drift estimate: %.2f ppm, %u samples used\n", amu_timesync_drift_ppm(&sync), sync.used);
+	printf("  map: %.2f ns/timestamp, max error %.1f ms\n", t * 1e9 / BENCH_TIMESYNC_POINTS, max_err);
+}
+
+/**
+ * @brief Simulated multi-channel query, the bus and the device conversion of every channel advance the shared clock
+ */
+static uint32_t periodic_conv_us;
+
+static uint32_t periodic_bus_us(size_t len) {
+	return (uint32_t)(((len + AMU_SCHED_TXN_BYTES) * 9 * 1000000ULL) / AMU_SCHED_DEFAULT_BUS_HZ) + AMU_SCHED_TXN_OVERHEAD_US;
+}
+
+static int8_t sim_periodic_measure(amu_periodic_t*, uint8_t, uint16_t channels, float* values) {
+	uint8_t n = 0;
+
+	for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++) {
+		if (channels & (1 << ch)) {
+			values[ch] = (float)ch;
+			n++;
+		}
+	}
+
+	// active channel mask, command, one busy poll and the readback
+	sim_bus_use(periodic_bus_us(sizeof(uint16_t)) + periodic_bus_us(1) + periodic_bus_us(1) + periodic_bus_us(n * sizeof(float)));
+	sim_bus.clock_us += n * periodic_conv_us;
+	return 0;
+}
+
+/**
+ * @brief Simulated devices for the default measure path, answering the active channel mask, the query, busy polls and the readback
+ */
+static struct {
+	uint16_t channels[0x80];
+	uint64_t busy_until_us[0x80];
+	float transfer[0x80][AMU_ADC_CH_NUM];
+} sim_periodic;
+
+static int8_t sim_periodic_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	sim_bus_use(periodic_bus_us(len));
+
+	if (address >= 0x80)
+		return -1;
+
+	if (!read) {
+		if ((reg == AMU_REG_SYSTEM_ADC_ACTIVE_CHANNELS) && (len == sizeof(uint16_t)))
+			memcpy(&sim_periodic.channels[address], data, sizeof(uint16_t));
+		else if ((reg == AMU_REG_CMD) && (data[0] == (uint8_t)(CMD_EXEC_MEAS_ACTIVE_CHANNELS | CMD_READ))) {
+			uint8_t n = 0;
+			for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++) {
+				if (sim_periodic.channels[address] & (1 << ch))
+					sim_periodic.transfer[address][n++] = (float)ch;
+			}
+			sim_periodic.busy_until_us[address] = sim_bus.clock_us + n * periodic_conv_us;
+		}
+		return 0;
+	}
+
+	if (reg == AMU_REG_CMD)
+		data[0] = (sim_bus.clock_us < sim_periodic.busy_until_us[address]) ? 1 : 0;
+	else if (reg == AMU_REG_TRANSFER_PTR)
+		memcpy(data, sim_periodic.transfer[address], std::min(len, sizeof(sim_periodic.transfer[address])));
+	return 0;
+}
+
+static uint32_t periodic_wrong;			// measurements delivered with a value that is not its channel number
+
+static void periodic_deliver(const amu_periodic_job_t* job, const float* values, uint32_t) {
+	for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++) {
+		if ((job->channels & (1 << ch)) && (values[ch] != (float)ch))
+			periodic_wrong++;
+	}
+	(*(uint32_t*)job->ctx)++;
+}
+
+/**
+ * @brief Temperatures at 1 Hz, V/I at 50 Hz and the sun sensor at 10 Hz on every device
+ *
+ * default_ops measures through the amu_dev_* functions of the library against sim_periodic_transfer,
+ * otherwise sim_periodic_measure models the same transactions directly.
+ */
+static bool bench_periodic_case(const char* name, uint8_t devices, bool shared, uint32_t conv_us, bool default_ops = false) {
+	static amu_periodic_t periodic;
+	amu_device_t* dev = (amu_device_t*)amu_dev_init(sim_periodic_transfer);
+	amu_transfer_fptr_t transport = dev->transfer;
+	uint32_t delivered = 0;
+	const uint16_t masks[3] = { AMU_CH_EN_TSENSOR0 | AMU_CH_EN_TSENSOR1 | AMU_CH_EN_TSENSOR2, AMU_CH_EN_VOLTAGE | AMU_CH_EN_CURRENT, AMU_CH_EN_SS_TL | AMU_CH_EN_SS_BL | AMU_CH_EN_SS_BR | AMU_CH_EN_SS_TR };
+	const uint32_t periods[3] = { 1000, 20, 100 };
+
+	sim_bus.clock_us = sim_bus.bus_us = 0;
+	periodic_conv_us = conv_us;
+
+	amu_periodic_init(&periodic);
+	if (!default_ops)
+		periodic.ops.measure = sim_periodic_measure;
+	periodic.ops.millis = sim_millis;
+
+	dev->transfer = sim_periodic_transfer;
+	dev->millis = sim_millis;
+	dev->delay = sim_cal_delay;
+	memset(&sim_periodic, 0, sizeof(sim_periodic));
+	periodic_wrong = 0;
+
+	// without sharing every job gets an address of its own, like separate polling loops per rate
+	for (uint8_t d = 0; d < devices; d++) {
+		for (uint8_t j = 0; j < 3; j++)
+			amu_periodic_add(&periodic, (uint8_t)(0x10 + (shared ? d : d * 3 + j)), masks[j], periods[j], periodic_deliver, &delivered);
+	}
+
+	amu_periodic_start(&periodic);
+	while (sim_bus.clock_us < BENCH_PERIODIC_SECONDS * 1000000ULL) {
+		uint32_t wait = amu_periodic_poll(&periodic);
+		sim_bus.clock_us += (uint64_t)wait * 1000;
+	}
+
+	uint16_t max_late = 0;
+	for (uint8_t i = 0; i < periodic.num; i++)
+		max_late = (periodic.job[i].max_late > max_late) ? periodic.job[i].max_late : max_late;
+
+	printf("  %-26s %7.1f queries/s, bus %4.1f%%, %7.1f measurements/s, worst lateness %2u ms, %u periods missed%s\n", name,
+		periodic.queries / (double)BENCH_PERIODIC_SECONDS, (double)sim_bus.bus_us / sim_bus.clock_us * 100.0,
+		delivered / (double)BENCH_PERIODIC_SECONDS, max_late, amu_periodic_missed(&periodic), periodic_wrong ? ", WRONG VALUES" : "");
+
+	dev->transfer = transport;
+	dev->millis = NULL;
+	dev->delay = NULL;
+
+	return periodic_wrong == 0;
+}
+
+static bool bench_periodic(void) {
+	bool ok = true;
+
+	printf("\nPeriodic measurements, 1/50/10 Hz jobs per device on a simulated 400 kHz bus for %u s\n", BENCH_PERIODIC_SECONDS);
+
+	ok &= bench_periodic_case("4 devices, one per job:", BENCH_PERIODIC_DEVICES, false, BENCH_PERIODIC_CONV_US);
+	ok &= bench_periodic_case("4 devices, shared:", BENCH_PERIODIC_DEVICES, true, BENCH_PERIODIC_CONV_US);
+	ok &= bench_periodic_case("10 devices, shared:", 10, true, BENCH_PERIODIC_CONV_US);
+	ok &= bench_periodic_case("10 devices, 1 ms/channel:", 10, true, 1000);
+	ok &= bench_periodic_case("4 devices, amu_dev_* path:", BENCH_PERIODIC_DEVICES, true, BENCH_PERIODIC_CONV_US, true);
+
+	return ok;
+}
+
+/**
+ * @brief Simulated rack for the calibration engine
+ *
+ * The HRADC of each device has its own offset and gain error, and applies its offset and gain registers
+ * on-chip as the AD7124 does: data = ZERO + (modulator - (offset - ZERO)) * 0.75 * gain / 0x400000. The
+ * zero-scale calibration sets the offset register from the input, the full-scale calibration the gain
+ * register so the input reads AMU_CAL_FULL_SCALE of the range. The last device has a bad contact that
+ * attenuates the reference during its full-scale calibration, the check has to keep it from saving.
+ */
+static struct {
+	float reference;
+	std::mt19937 rng;
+	struct {
+		uint8_t transfer[8];
+		uint8_t pga[2];
+		uint64_t busy_until_us;
+		int32_t offset_error;		// codes
+		double gain_error;
+		int32_t offset[8];			// offset and gain registers of the voltage channel per PGA
+		uint32_t gain[8];
+		bool saved[8];
+		int32_t saved_offset[8];
+		uint32_t saved_gain[8];
+	} dev[BENCH_CAL_DEVICES];
+} sim_cal;
+
+#define SIM_CAL_GAIN_RESET		0x555555UL		// gain register of a gain of 1
+#define SIM_CAL_BAD_CONTACT		0.996			// reference seen by the last device during its full-scale calibration
+
+static float sim_cal_range(uint8_t pga) {
+	return 20.0f / (float)(1 << pga);
+}
+
+static uint32_t sim_cal_settle(float value, void*) {
+	sim_cal.reference = value;
+	return BENCH_CAL_SETTLE_MS;
+}
+
+/**
+ * @brief Data code of an input, without noise
+ */
+static double sim_cal_data(uint8_t d, uint8_t pga, int32_t offset, uint32_t gain, double input) {
+	const auto& dev = sim_cal.dev[d];
+	double modulator = input / sim_cal_range(pga) * dev.gain_error * AMU_ADC_CODE_ZERO + dev.offset_error;
+	return AMU_ADC_CODE_ZERO + (modulator - (offset - AMU_ADC_CODE_ZERO)) * 0.75 * gain / 0x400000;
+}
+
+static int8_t sim_cal_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	std::uniform_int_distribution<int> noise(-2, 2);
+
+	if ((address < BENCH_CAL_ADDRESS) || (address >= BENCH_CAL_ADDRESS + BENCH_CAL_DEVICES))
+		return -1;
+
+	uint8_t d = address - BENCH_CAL_ADDRESS;
+	auto& dev = sim_cal.dev[d];
+	sim_bus_use(periodic_bus_us(len));
+
+	if (read) {
+		memset(data, 0, len);
+		if (reg == AMU_REG_CMD)
+			data[0] = (sim_bus.clock_us < dev.busy_until_us) ? 1 : 0;
+		else if (reg == AMU_REG_TRANSFER_PTR)
+			memcpy(data, dev.transfer, (len < sizeof(dev.transfer)) ? len : sizeof(dev.transfer));
+		return 0;
+	}
+
+	if (reg == AMU_REG_TRANSFER_PTR) {
+		memcpy(dev.transfer, data, (len < sizeof(dev.transfer)) ? len : sizeof(dev.transfer));
+		return 0;
+	}
+	if (reg != AMU_REG_CMD)
+		return 0;
+
+	uint32_t busy_ms = 1;
+	uint8_t cmd = data[0];
+	uint8_t pga = dev.pga[0] & 7;
+	double reference = sim_cal.reference;
+
+	if (cmd == (uint8_t)CMD_ADC_CH_PGA)
+		dev.pga[dev.transfer[0] & 1] = dev.transfer[1];
+	else if (cmd == (uint8_t)(CMD_ADC_CH_PGA_VMAX | CMD_READ)) {
+		float range = sim_cal_range(dev.transfer[0]);
+		memcpy(dev.transfer, &range, sizeof(float));
+	}
+	else if (cmd == (uint8_t)CMD_ADC_CH_CAL_RESET) {
+		dev.offset[pga] = AMU_ADC_CODE_ZERO;
+		dev.gain[pga] = SIM_CAL_GAIN_RESET;
+	}
+	else if (cmd == (uint8_t)CMD_ADC_CH_CAL_ZERO_SCALE) {
+		double modulator = reference / sim_cal_range(pga) * dev.gain_error * AMU_ADC_CODE_ZERO + dev.offset_error;
+		dev.offset[pga] = AMU_ADC_CODE_ZERO + (int32_t)llround(modulator) + noise(sim_cal.rng);
+		busy_ms = 4 * BENCH_CAL_CONV_MS;
+	}
+	else if (cmd == (uint8_t)CMD_ADC_CH_CAL_FULL_SCALE) {
+		if (d == BENCH_CAL_DEVICES - 1)
+			reference *= SIM_CAL_BAD_CONTACT;
+		double code = sim_cal_data(d, pga, dev.offset[pga], dev.gain[pga], reference) - AMU_ADC_CODE_ZERO + noise(sim_cal.rng);
+		dev.gain[pga] = (uint32_t)llround(dev.gain[pga] * (AMU_CAL_FULL_SCALE * AMU_ADC_CODE_ZERO) / code);
+		busy_ms = 4 * BENCH_CAL_CONV_MS;
+	}
+	else if (cmd == (uint8_t)(CMD_ADC_CH_OFFSET_COEFF | CMD_READ))
+		memcpy(dev.transfer, &dev.offset[pga], sizeof(int32_t));
+	else if (cmd == (uint8_t)(CMD_ADC_CH_GAIN_COEFF | CMD_READ))
+		memcpy(dev.transfer, &dev.gain[pga], sizeof(uint32_t));
+	else if (cmd == (uint8_t)(CMD_MEAS_CH_VOLTAGE | CMD_READ)) {
+		double code = sim_cal_data(d, pga, dev.offset[pga], dev.gain[pga], reference) + noise(sim_cal.rng);
+		float value = (float)((code - AMU_ADC_CODE_ZERO) / AMU_ADC_CODE_ZERO * sim_cal_range(pga));
+		memcpy(dev.transfer, &value, sizeof(float));
+		busy_ms = BENCH_CAL_CONV_MS;
+	}
+	else if (cmd == (uint8_t)CMD_ADC_CH_CAL_SAVE) {
+		dev.saved[pga] = true;
+		dev.saved_offset[pga] = dev.offset[pga];
+		dev.saved_gain[pga] = dev.gain[pga];
+		busy_ms = 20;
+	}
+
+	dev.busy_until_us = sim_bus.clock_us + busy_ms * 1000ULL;
+	return 0;
+}
+
+/**
+ * @brief All 8 voltage ranges of a rack of BENCH_CAL_DEVICES devices, one device after the other against all at once
+ *
+ * The saved coefficients are judged by the simulated transfer function at half of each range, not by
+ * the measurements the engine checks itself with.
+ */
+static bool bench_calibration(void) {
+	amu_device_t* dev = (amu_device_t*)amu_dev_init(sim_cal_transfer);
+	amu_transfer_fptr_t transport = dev->transfer;
+	amu_cal_source_t source = { sim_cal_settle, NULL, NULL };
+	std::uniform_int_distribution<int> offset(-3000, 3000);
+	std::uniform_real_distribution<double> gain(0.99, 1.01);
+	uint8_t addresses[BENCH_CAL_DEVICES];
+	double sequential_s = 0.0, parallel_s;
+	double worst_saved = 0.0;
+	float worst_check = 0.0f;
+	uint32_t rejected = 0, unexpected = 0;
+
+	printf("\nCalibration of %u devices, 8 voltage ranges, zero and full scale, %u check steps of %u samples, %u ms settling\n", BENCH_CAL_DEVICES, AMU_CAL_POINTS, AMU_CAL_SAMPLES, BENCH_CAL_SETTLE_MS);
+
+	sim_cal.rng.seed(1819);
+	for (uint8_t d = 0; d < BENCH_CAL_DEVICES; d++) {
+		addresses[d] = BENCH_CAL_ADDRESS + d;
+		sim_cal.dev[d].offset_error = offset(sim_cal.rng);
+		sim_cal.dev[d].gain_error = gain(sim_cal.rng);
+		for (uint8_t pga = 0; pga < 8; pga++) {
+			sim_cal.dev[d].offset[pga] = AMU_ADC_CODE_ZERO + offset(sim_cal.rng);		// left by an earlier calibration
+			sim_cal.dev[d].gain[pga] = (uint32_t)(SIM_CAL_GAIN_RESET * gain(sim_cal.rng));
+		}
+	}
+
+	dev->transfer = sim_cal_transfer;
+	dev->millis = sim_millis;
+	dev->delay = sim_cal_delay;
+
+	for (uint8_t d = 0; d < BENCH_CAL_DEVICES; d++) {
+		AMUCalibration one(source);
+		one.setDevices(&addresses[d], 1);
+		sim_bus.clock_us = 0;
+		if ((one.calibrateRanges(AMU_ADC_CH_VOLTAGE, 0, 7, false) != 0) != (d == BENCH_CAL_DEVICES - 1))
+			unexpected++;
+		sequential_s += sim_bus.clock_us / 1e6;
+	}
+
+	AMUCalibration rack(source);
+	rack.setDevices(addresses, BENCH_CAL_DEVICES);
+	sim_bus.clock_us = sim_bus.bus_us = 0;
+	rack.calibrateRanges(AMU_ADC_CH_VOLTAGE, 0, 7, true);
+	parallel_s = sim_bus.clock_us / 1e6;
+
+	for (const amu_cal_result_t& r : rack.results()) {
+		uint8_t d = r.address - BENCH_CAL_ADDRESS;
+		const auto& truth = sim_cal.dev[d];
+		bool bad = (d == BENCH_CAL_DEVICES - 1);
+
+		if (r.result == AMU_CAL_ERROR_CHECK)
+			rejected++;
+		if (((r.result != 0) != bad) || (truth.saved[r.pga] == bad) || (r.offset != truth.offset[r.pga]) || (r.gain != truth.gain[r.pga]))
+			unexpected++;
+
+		if (!bad) {
+			double half = 0.5 * sim_cal_range(r.pga);
+			double code = sim_cal_data(d, r.pga, truth.saved_offset[r.pga], truth.saved_gain[r.pga], half);
+			double error = fabs((code - AMU_ADC_CODE_ZERO) / AMU_ADC_CODE_ZERO * sim_cal_range(r.pga) - half) / sim_cal_range(r.pga);
+			worst_saved = fmax(worst_saved, error);
+			worst_check = fmaxf(worst_check, r.max_error);
+		}
+	}
+
+	if (worst_saved > AMU_CAL_TOLERANCE)
+		unexpected++;
+
+	printf("  one at a time: %7.1f s\n", sequential_s);
+	printf("  all at once:   %7.1f s (%.1fx), bus %2.0f%%, %u ranges calibrated\n", parallel_s, sequential_s / parallel_s, (double)sim_bus.bus_us / sim_bus.clock_us * 100.0, (unsigned)rack.results().size());
+	printf("  saved ranges within %.1f ppm of range at half scale, check within %.1f ppm, %u of 8 ranges of the bad contact rejected and not saved%s\n",
+		worst_saved * 1e6, worst_check * 1e6, rejected, unexpected ? ", FAILED" : "");
+
+	dev->transfer = transport;
+	dev->millis = NULL;
+	dev->delay = NULL;
+
+	return unexpected == 0;
+}
+
+/**
+ * @brief Simulated devices for AMU::readADCChannels(), every channel at its own PGA
+ *
+ * The channel of a channel command is only what the host last wrote to the transfer register, as on
+ * the device, so a query that does not send its channel reads another one.
+ */
+static struct {
+	bool raw_block;							// reports AMU_CAP_ADC_RAW
+	amu_ext_addr_t ext;
+	uint8_t transfer[AMU_SERIALNUM_STR_LEN];
+	uint8_t pga[AMU_ADC_CH_NUM];
+	float input[AMU_ADC_CH_NUM];
+	adc_channels_t raw;
+	uint32_t transfers;
+} sim_adc[2];
+
+static float sim_adc_range(uint8_t channel, uint8_t pga) {
+	if (channel == AMU_ADC_CH_VOLTAGE)
+		return sim_cal_range(pga);
+	if (channel == AMU_ADC_CH_CURRENT)
+		return 0.5f / (float)(1 << pga);
+	return AMU_ADC_VREF / (float)(1 << pga);
+}
+
+static int8_t sim_adc_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	if ((address < BENCH_ADC_ADDRESS) || (address >= BENCH_ADC_ADDRESS + 2))
+		return -1;
+
+	auto& dev = sim_adc[address - BENCH_ADC_ADDRESS];
+	const uint8_t* src = NULL;
+	size_t avail = 0;
+	amu_capabilities_t caps = {};
+
+	dev.transfers++;
+
+	if (!read) {
+		if (reg == AMU_REG_DATA_PTR_EXT_ADDR)
+			memcpy(&dev.ext, data, sizeof(amu_ext_addr_t));
+		else if (reg == AMU_REG_TRANSFER_PTR)
+			memcpy(dev.transfer, data, std::min(len, sizeof(dev.transfer)));
+		else if (reg == AMU_REG_CMD) {
+			uint8_t channel = dev.transfer[0];
+			float range;
+
+			memset(dev.transfer, 0, sizeof(dev.transfer));
+			if (data[0] == (uint8_t)(CMD_SYSTEM_SERIAL_NUM | CMD_READ))
+				snprintf((char*)dev.transfer, sizeof(dev.transfer), "ADC%u", address);
+			else if (data[0] == (uint8_t)(CMD_ADC_CH_PGA | CMD_READ))
+				dev.transfer[0] = dev.pga[channel % AMU_ADC_CH_NUM];
+			else if (data[0] == (uint8_t)(CMD_ADC_CH_PGA_VMAX | CMD_READ)) {
+				range = sim_adc_range(AMU_ADC_CH_VOLTAGE, channel);
+				memcpy(dev.transfer, &range, sizeof(float));
+			}
+			else if (data[0] == (uint8_t)(CMD_ADC_CH_PGA_IMAX | CMD_READ)) {
+				range = sim_adc_range(AMU_ADC_CH_CURRENT, channel);
+				memcpy(dev.transfer, &range, sizeof(float));
+			}
+		}
+		return 0;
+	}
+
+	memset(data, 0, len);
+
+	if (reg == AMU_REG_TRANSFER_PTR) {
+		src = dev.transfer;
+		avail = sizeof(dev.transfer);
+	}
+	else if ((reg >= AMU_REG_ADC_DATA) && (reg < AMU_REG_ADC_DATA + sizeof(adc_channels_t))) {
+		src = (const uint8_t*)&dev.raw + (reg - AMU_REG_ADC_DATA);
+		avail = sizeof(uint32_t);
+	}
+	else if ((reg == AMU_REG_DATA_PTR_EXT_DATA) && (dev.ext.reg == AMU_REG_EXT_CAPABILITIES)) {
+		caps.version = AMU_CAPABILITIES_VERSION;
+		caps.length = sizeof(amu_capabilities_t);
+		caps.flags = dev.raw_block ? AMU_CAP_ADC_RAW : 0;
+		caps.maxPoints = IVSWEEP_MAX_POINTS;
+		caps.sweepConfigVersion = 1;
+		src = (const uint8_t*)&caps;
+		avail = sizeof(caps);
+	}
+	else if ((reg == AMU_REG_DATA_PTR_EXT_DATA) && (dev.ext.reg == AMU_REG_EXT_ADC_RAW) && dev.raw_block && (dev.ext.offset < sizeof(adc_channels_t))) {
+		src = (const uint8_t*)&dev.raw + dev.ext.offset;
+		avail = sizeof(adc_channels_t) - dev.ext.offset;
+	}
+
+	if (src)
+		memcpy(data, src, std::min(len, avail));
+	return 0;
+}
+
+/**
+ * @brief AMU::readADCChannels() against devices with every channel at another PGA, through the block and one register at a time
+ */
+static bool bench_adc_readout(void) {
+	amu_device_t* dev = (amu_device_t*)amu_dev_init(sim_adc_transfer);
+	amu_transfer_fptr_t transport = dev->transfer;
+	double worst = 0.0;
+	bool ok = true;
+
+	printf("\nAMU::readADCChannels(), 16 channels at 8 PGA settings\n");
+
+	dev->transfer = sim_adc_transfer;
+	dev->millis = sim_millis;
+	dev->delay = sim_cal_delay;
+	AMU::clearADCCalibrationCache();
+
+	for (uint8_t d = 0; d < 2; d++) {
+		auto& sim = sim_adc[d];
+		AMU amu;
+		float values[AMU_ADC_CH_NUM];
+		uint32_t load, read;
+		int8_t result;
+
+		memset(&sim, 0, sizeof(sim));
+		sim.raw_block = (d == 0);
+		for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++) {
+			sim.pga[ch] = (uint8_t)((ch * 3 + d) % 8);
+			sim.input[ch] = sim_adc_range(ch, sim.pga[ch]) * ((ch & 1) ? -0.61f : 0.37f);
+			sim.raw.channel[ch] = (uint32_t)(AMU_ADC_CODE_ZERO + llround(sim.input[ch] / sim_adc_range(ch, sim.pga[ch]) * AMU_ADC_CODE_ZERO));
+		}
+
+		amu.begin(BENCH_ADC_ADDRESS + d, sim_adc_transfer);
+
+		sim.transfers = 0;
+		result = amu.loadADCCalibration();
+		load = sim.transfers;
+
+		sim.transfers = 0;
+		result |= amu.readADCChannels(values);
+		read = sim.transfers;
+
+		for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++)
+			worst = fmax(worst, fabs(values[ch] - sim.input[ch]) / sim_adc_range(ch, sim.pga[ch]));
+
+		ok &= (result == 0);
+		printf("  %-26s %3u transfers to load the scaling, %2u per read\n", sim.raw_block ? "AMU_REG_EXT_ADC_RAW:" : "AMU_REG_ADC_DATA_*:", load, read);
+	}
+
+	ok &= (worst < 1e-6);
+	printf("  worst error %.2f ppm of range%s\n", worst * 1e6, ok ? "" : ", FAILED");
+
+	AMU::clearADCCalibrationCache();
+	dev->transfer = transport;
+	dev->millis = NULL;
+	dev->delay = NULL;
+
+	return ok;
+}
+
+/**
+ * @brief Simulated devices answering the legacy identity queries and the identity block
+ */
+static struct {
+	amu_ext_addr_t ext;
+	uint8_t transfer[AMU_SERIALNUM_STR_LEN];
+	uint64_t busy_until_us;
+	amu_identity_t identity;
+} sim_ident[BENCH_IDENT_DEVICES];
+
+static void sim_ident_build(uint8_t d, float area) {
+	amu_identity_t* id = &sim_ident[d].identity;
+
+	memset(id, 0, sizeof(amu_identity_t));
+	id->header.version = AMU_IDENTITY_VERSION;
+	id->header.length = sizeof(amu_identity_t);
+	snprintf(id->firmware, AMU_FIRMWARE_STR_LEN, "amu-v3.2.1");
+	snprintf(id->serial, AMU_SERIALNUM_STR_LEN, "0x5E%08X%04X", 0x1000u + d, 0xA5u);
+	id->hardware_revision = 3;
+	id->sweep_config.numPoints = 100;
+	id->sweep_config.am0 = 1366.1f;
+	id->sweep_config.area = area;
+	snprintf(id->dut.manufacturer, AMU_DUT_MANUFACTURER_STR_LEN, "SolAero");
+	snprintf(id->dut.serial, AMU_DUT_SERIALNUM_STR_LEN, "ZTJ-%03u", d);
+	id->header.crc = amu_crc32((const uint8_t*)id + sizeof(amu_identity_header_t), sizeof(amu_identity_t) - sizeof(amu_identity_header_t));
+}
+
+static int8_t sim_ident_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	if ((address < BENCH_IDENT_ADDRESS) || (address >= BENCH_IDENT_ADDRESS + BENCH_IDENT_DEVICES))
+		return -1;
+
+	auto& dev = sim_ident[address - BENCH_IDENT_ADDRESS];
+	const uint8_t* src = NULL;
+	size_t avail = 0;
+
+	sim_bus_use(periodic_bus_us(len));
+
+	if (!read) {
+		if (reg == AMU_REG_DATA_PTR_EXT_ADDR)
+			memcpy(&dev.ext, data, sizeof(amu_ext_addr_t));
+		else if ((reg == AMU_REG_CMD) && (data[0] == (uint8_t)(CMD_SYSTEM_FIRMWARE | CMD_READ)))
+			memcpy(dev.transfer, dev.identity.firmware, AMU_FIRMWARE_STR_LEN);
+		else if ((reg == AMU_REG_CMD) && (data[0] == (uint8_t)(CMD_SYSTEM_SERIAL_NUM | CMD_READ)))
+			memcpy(dev.transfer, dev.identity.serial, AMU_SERIALNUM_STR_LEN);
+		if (reg == AMU_REG_CMD)
+			dev.busy_until_us = sim_bus.clock_us + 1000;
+		return 0;
+	}
+
+	memset(data, 0, len);
+	if (reg == AMU_REG_CMD) {
+		data[0] = (sim_bus.clock_us < dev.busy_until_us) ? 1 : 0;
+		return 0;
+	}
+
+	switch (reg) {
+		case AMU_REG_TRANSFER_PTR:					src = dev.transfer; avail = sizeof(dev.transfer); break;
+		case AMU_REG_SYSTEM_HARDWARE_REVISION:		src = &dev.identity.hardware_revision; avail = 1; break;
+		case AMU_REG_DUT:							src = (const uint8_t*)&dev.identity.dut; avail = sizeof(amu_dut_t); break;
+		case AMU_REG_DATA_PTR_SWEEP_CONFIG:			src = (const uint8_t*)&dev.identity.sweep_config; avail = sizeof(ivsweep_config_t); break;
+		case AMU_REG_DATA_PTR_EXT_DATA:
+			if ((dev.ext.reg == AMU_REG_EXT_IDENTITY) && (dev.ext.offset < sizeof(amu_identity_t))) {
+				src = (const uint8_t*)&dev.identity + dev.ext.offset;
+				avail = sizeof(amu_identity_t) - dev.ext.offset;
+			}
+			break;
+		default: break;
+	}
+
+	if (src)
+		memcpy(data, src, (len < avail) ? len : avail);
+	return 0;
+}
+
+/**
+ * @brief Startup of BENCH_IDENT_DEVICES devices, separate identity reads against the identity block and its cache
+ */
+static bool bench_identity(void) {
+	amu_device_t* dev = (amu_device_t*)amu_dev_init(sim_ident_transfer);
+	amu_transfer_fptr_t transport = dev->transfer;
+	static amu_identity_cache_t cache, saved;
+	amu_identity_t identity;
+	bool changed[BENCH_IDENT_DEVICES] = {};
+	uint32_t mismatched = 0;
+	int8_t failed = 0;
+	double legacy_ms, cold_ms, warm_ms, restored_ms;
+
+	printf("\nStartup identity of %u devices on a simulated 400 kHz bus\n", BENCH_IDENT_DEVICES);
+
+	for (uint8_t d = 0; d < BENCH_IDENT_DEVICES; d++)
+		sim_ident_build(d, 0.0004f);
+
+	dev->transfer = sim_ident_transfer;
+	dev->millis = sim_millis;
+	dev->delay = sim_cal_delay;
+
+	// what AMU::begin() did per device: firmware and serial queries, then three register reads
+	sim_bus.clock_us = sim_bus.bus_us = 0;
+	for (uint8_t d = 0; d < BENCH_IDENT_DEVICES; d++) {
+		uint8_t address = BENCH_IDENT_ADDRESS + d;
+		uint8_t revision;
+		ivsweep_config_t config;
+
+		failed |= amu_dev_query_command(address, (CMD_t)CMD_SYSTEM_FIRMWARE, 0, AMU_FIRMWARE_STR_LEN);
+		failed |= amu_dev_query_command(address, (CMD_t)CMD_SYSTEM_SERIAL_NUM, 0, AMU_SERIALNUM_STR_LEN);
+		failed |= amu_dev_transfer(address, (uint8_t)AMU_REG_SYSTEM_HARDWARE_REVISION, &revision, sizeof(uint8_t), AMU_TWI_TRANSFER_READ);
+		failed |= amu_dev_transfer(address, (uint8_t)AMU_REG_DUT, (uint8_t*)&identity.dut, sizeof(amu_dut_t), AMU_TWI_TRANSFER_READ);
+		failed |= amu_dev_transfer(address, (uint8_t)AMU_REG_DATA_PTR_SWEEP_CONFIG, (uint8_t*)&config, sizeof(ivsweep_config_t), AMU_TWI_TRANSFER_READ);
+	}
+	legacy_ms = sim_bus.clock_us / 1000.0;
+
+	// cached reads are expected to hit for every device that did not change
+	auto read_all = [&](amu_identity_cache_t* c, bool cached) {
+		sim_bus.clock_us = 0;
+		for (uint8_t d = 0; d < BENCH_IDENT_DEVICES; d++) {
+			int8_t result = amu_identity_read(BENCH_IDENT_ADDRESS + d, c, &identity);
+			if (result < 0)
+				failed |= 1;
+			if ((result != ((cached && !changed[d]) ? 1 : 0)) || (memcmp(&identity, &sim_ident[d].identity, sizeof(amu_identity_t)) != 0))
+				mismatched++;
+		}
+		return sim_bus.clock_us / 1000.0;
+	};
+
+	amu_identity_cache_init(&cache);
+	cold_ms = read_all(&cache, false);
+	warm_ms = read_all(&cache, true);
+
+	// next run: the cache comes back from disk and two devices were reconfigured in between
+	memcpy(&saved, &cache, sizeof(amu_identity_cache_t));
+	changed[7] = changed[42] = true;
+	sim_ident_build(7, 0.0008f);
+	sim_ident_build(42, 0.0008f);
+	amu_identity_cache_init(&cache);
+	failed |= !amu_identity_cache_load(&cache, &saved, sizeof(amu_identity_cache_t));
+	restored_ms = read_all(&cache, true);
+
+	printf("  separate reads:      %7.1f ms (%.2f ms/device)\n", legacy_ms, legacy_ms / BENCH_IDENT_DEVICES);
+	printf("  identity block:      %7.1f ms (%.1fx)\n", cold_ms, legacy_ms / cold_ms);
+	printf("  cached, unchanged:   %7.1f ms (%.1fx)\n", warm_ms, legacy_ms / warm_ms);
+	printf("  restored, 2 changed: %7.1f ms (%.1fx), %u hits, %u full reads, %u mismatched%s\n", restored_ms, legacy_ms / restored_ms,
+		cache.hits, cache.misses, mismatched, failed ? ", FAILED" : "");
+
+	dev->transfer = transport;
+	dev->millis = NULL;
+	dev->delay = NULL;
+
+	return !failed && (mismatched == 0);
+}
+
+/**
+ * @brief Simulated buses for discovery, each with its own clock so buses scanned from different threads do not interfere
+ */
+static struct {
+	uint64_t clock_us;
+	bool present[0x80];
+	uint8_t revision[0x80];
+	uint32_t serial[0x80];
+	bool legacy[0x80];						// firmware without the extended window, EXT_DATA returns stale transfer bytes
+	amu_ext_addr_t ext[0x80];
+	uint8_t transfer[0x80][AMU_SERIALNUM_STR_LEN];
+	uint64_t busy_until_us[0x80];
+} sim_disc[BENCH_DISC_BUSES];
+
+static int8_t sim_disc_transfer(uint8_t b, uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	auto& bus = sim_disc[b];
+
+	bus.clock_us += periodic_bus_us(len);
+	if ((address >= 0x80) || !bus.present[address])
+		return -1;			// NACK
+
+	char serial[AMU_SERIALNUM_STR_LEN] = {};
+	snprintf(serial, sizeof(serial), "0x5E%02X%06X", b, bus.serial[address]);
+
+	if (!read) {
+		if ((reg == AMU_REG_DATA_PTR_EXT_ADDR) && (len == sizeof(amu_ext_addr_t)))
+			memcpy(&bus.ext[address], data, sizeof(amu_ext_addr_t));
+		else if (reg == AMU_REG_CMD) {
+			if (data[0] == (uint8_t)(CMD_SYSTEM_SERIAL_NUM | CMD_READ))
+				memcpy(bus.transfer[address], serial, AMU_SERIALNUM_STR_LEN);
+			bus.busy_until_us[address] = bus.clock_us + 1000;
+		}
+		return 0;
+	}
+
+	if (len == 0)
+		return 0;
+	memset(data, 0, len);
+
+	if (reg == AMU_REG_CMD)
+		data[0] = (bus.clock_us < bus.busy_until_us[address]) ? 1 : 0;
+	else if (reg == AMU_REG_TRANSFER_PTR)
+		memcpy(data, bus.transfer[address], (len < AMU_SERIALNUM_STR_LEN) ? len : AMU_SERIALNUM_STR_LEN);
+	else if (reg == AMU_REG_SYSTEM_HARDWARE_REVISION)
+		data[0] = bus.revision[address];
+	else if ((reg == AMU_REG_DATA_PTR_EXT_DATA) && bus.legacy[address])
+		memset(data, 0xA5, len);
+	else if ((reg == AMU_REG_DATA_PTR_EXT_DATA) && (bus.ext[address].reg == AMU_REG_EXT_IDENTITY)) {
+		amu_identity_t identity = {};
+		identity.header.version = AMU_IDENTITY_VERSION;
+		identity.header.length = sizeof(amu_identity_t);
+		memcpy(identity.serial, serial, AMU_SERIALNUM_STR_LEN);
+		identity.hardware_revision = bus.revision[address];
+		identity.header.crc = amu_crc32((const uint8_t*)&identity + sizeof(amu_identity_header_t), sizeof(amu_identity_t) - sizeof(amu_identity_header_t));
+		if (bus.ext[address].offset < sizeof(amu_identity_t))
+			memcpy(data, (const uint8_t*)&identity + bus.ext[address].offset, std::min(len, sizeof(amu_identity_t) - bus.ext[address].offset));
+	}
+	return 0;
+}
+
+template <uint8_t B> static int8_t sim_disc_bus(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	return sim_disc_transfer(B, address, reg, data, len, read);
+}
+
+static const amu_transfer_fptr_t sim_disc_buses[BENCH_DISC_BUSES] = { sim_disc_bus<0>, sim_disc_bus<1>, sim_disc_bus<2> };
+
+static uint32_t sim_disc_millis(void) { return (uint32_t)(sim_disc[0].clock_us / 1000); }
+static void sim_disc_delay(uint32_t ms) { sim_disc[0].clock_us += (uint64_t)ms * 1000; }
+
+static void disc_count(amu_discovery_t* discovery, const amu_discovery_entry_t*, uint8_t event) {
+	((uint32_t*)discovery->ctx)[event]++;
+}
+
+/**
+ * @brief BENCH_DISC_BUSES buses of BENCH_DISC_DEVICES devices, probing and identifying them against the discovery engine
+ */
+static bool bench_discovery(void) {
+	amu_device_t* dev = (amu_device_t*)amu_dev_init(sim_disc_buses[0]);
+	amu_transfer_fptr_t transport = dev->transfer;
+	static amu_discovery_t discovery[BENCH_DISC_BUSES];
+	uint32_t events[BENCH_DISC_BUSES][4] = {};		// per bus, the buses are scanned from separate threads
+	uint8_t range = AMU_DISCOVERY_LAST_ADDRESS - AMU_DISCOVERY_FIRST_ADDRESS;
+	std::mt19937 rng(47);
+	double legacy_ms, scan_ms = 0.0, parallel_ms = 0.0, rescan_us, window_us;
+	uint32_t rescans = 0, mismatched = 0;
+
+	printf("\nDiscovery of %u buses with %u devices each, 0x%02X-0x%02X on a simulated 400 kHz bus\n", BENCH_DISC_BUSES, BENCH_DISC_DEVICES,
+		AMU_DISCOVERY_FIRST_ADDRESS, AMU_DISCOVERY_LAST_ADDRESS - 1);
+
+	for (uint8_t b = 0; b < BENCH_DISC_BUSES; b++) {
+		for (uint8_t n = 0; n < BENCH_DISC_DEVICES; ) {
+			uint8_t address = AMU_DISCOVERY_FIRST_ADDRESS + rng() % range;
+			if ((address == AMU_TWI_ALLCALL_ADDRESS) || sim_disc[b].present[address])
+				continue;
+			sim_disc[b].present[address] = true;
+			sim_disc[b].revision[address] = 3;
+			sim_disc[b].serial[address] = rng() & 0xFFFFFF;
+			sim_disc[b].legacy[address] = ((n % BENCH_DISC_LEGACY) == 0);
+			n++;
+		}
+	}
+
+	// the old way on one bus: probe the range, then query the serial number and read the hardware revision of each device
+	dev->transfer = sim_disc_buses[0];
+	dev->millis = sim_disc_millis;
+	dev->delay = sim_disc_delay;
+	sim_disc[0].clock_us = 0;
+	uint8_t found = amu_scan_for_devices(AMU_DISCOVERY_FIRST_ADDRESS, AMU_DISCOVERY_LAST_ADDRESS);
+	for (uint8_t i = 0; i < found; i++) {
+		uint8_t revision;
+		amu_dev_query_command(amu_get_device_address(i), (CMD_t)CMD_SYSTEM_SERIAL_NUM, 0, AMU_SERIALNUM_STR_LEN);
+		amu_dev_transfer(amu_get_device_address(i), (uint8_t)AMU_REG_SYSTEM_HARDWARE_REVISION, &revision, sizeof(uint8_t), AMU_TWI_TRANSFER_READ);
+	}
+	legacy_ms = sim_disc[0].clock_us / 1000.0 * BENCH_DISC_BUSES;
+
+	for (uint8_t b = 0; b < BENCH_DISC_BUSES; b++) {
+		amu_discovery_init(&discovery[b], sim_disc_buses[b], AMU_DISCOVERY_FIRST_ADDRESS, AMU_DISCOVERY_LAST_ADDRESS);
+		discovery[b].on_change = disc_count;
+		discovery[b].ctx = events[b];
+		sim_disc[b].clock_us = 0;
+	}
+
+	// one thread per bus, the buses share nothing
+	AMUThreadPool pool(BENCH_DISC_BUSES);
+	pool.parallel_for(BENCH_DISC_BUSES, [&](size_t b) { amu_discovery_scan(&discovery[b]); });
+
+	for (uint8_t b = 0; b < BENCH_DISC_BUSES; b++) {
+		double ms = sim_disc[b].clock_us / 1000.0;
+		scan_ms += ms;
+		parallel_ms = fmax(parallel_ms, ms);
+
+		for (uint8_t i = 0; i < discovery[b].num; i++) {
+			const amu_discovery_entry_t* e = &discovery[b].entry[i];
+			char serial[AMU_SERIALNUM_STR_LEN] = {};
+			if (!sim_disc[b].legacy[e->address])
+				snprintf(serial, sizeof(serial), "0x5E%02X%06X", b, sim_disc[b].serial[e->address]);
+			if (!sim_disc[b].present[e->address] || strcmp(serial, e->serial) || (e->has_serial == sim_disc[b].legacy[e->address]) || (e->hardware_revision != 3))
+				mismatched++;
+		}
+		mismatched += BENCH_DISC_DEVICES - discovery[b].num;
+		sim_disc[b].clock_us = 0;
+	}
+
+	// hot-plug check with no change, known devices only
+	for (uint8_t b = 0; b < BENCH_DISC_BUSES; b++)
+		amu_discovery_rescan(&discovery[b], 0);
+	rescan_us = (double)sim_disc[0].clock_us;
+
+	// one device unplugged and one plugged in elsewhere on bus 1, found by windows of 8 addresses per check
+	uint8_t gone = discovery[1].entry[0].address, added = 0;
+	for (uint8_t a = AMU_DISCOVERY_FIRST_ADDRESS; a < AMU_DISCOVERY_LAST_ADDRESS; a++) {
+		if (!sim_disc[1].present[a] && (a != AMU_TWI_ALLCALL_ADDRESS))
+			added = a;
+	}
+	sim_disc[1].present[gone] = false;
+	sim_disc[1].present[added] = true;
+	sim_disc[1].clock_us = 0;
+	events[1][AMU_DISCOVERY_ADDED] = events[1][AMU_DISCOVERY_REMOVED] = 0;
+	while ((events[1][AMU_DISCOVERY_ADDED] == 0) && (rescans < 64)) {
+		amu_discovery_rescan(&discovery[1], 8);
+		rescans++;
+	}
+	window_us = sim_disc[1].clock_us / (double)rescans;
+
+	printf("  probe + query each device: %7.1f ms for all buses\n", legacy_ms);
+	printf("  scan + fingerprint:        %7.1f ms one bus after the other (%.1fx), %.1f ms in parallel (%.1fx), %u mismatched\n",
+		scan_ms, legacy_ms / scan_ms, parallel_ms, legacy_ms / parallel_ms, mismatched);
+	printf("  rescan, no change:         %7.0f us per bus\n", rescan_us);
+	printf("  rescan, window of 8:       %7.0f us per check, %u removed at once, added found after %u checks\n",
+		window_us, events[1][AMU_DISCOVERY_REMOVED], rescans);
+
+	dev->transfer = transport;
+	dev->millis = NULL;
+	dev->delay = NULL;
+	amu_set_device_addresses(NULL, 0);
+
+	return mismatched == 0;
+}
+
+/**
+ * @brief Simulated devices with and without AMU_REG_EXT_SWEEP_CONFIG_V2, sweeping a single-diode cell
+ */
+static struct {
+	bool v2;
+	amu_ext_addr_t ext;
+	ivsweep_config_t config;
+	ivsweep_config_v2_t config_v2;
+	float voltage[BENCH_SWCFG_MAX_POINTS];
+	float current[BENCH_SWCFG_MAX_POINTS];
+} sim_swcfg[2];
+
+static int8_t sim_swcfg_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	if ((address < BENCH_SWCFG_ADDRESS) || (address >= BENCH_SWCFG_ADDRESS + 2))
+		return -1;
+
+	auto& dev = sim_swcfg[address - BENCH_SWCFG_ADDRESS];
+	amu_capabilities_t caps = { AMU_CAPABILITIES_VERSION, sizeof(amu_capabilities_t), AMU_CAP_SWEEP_CONFIG_V2, BENCH_SWCFG_MAX_POINTS, AMU_SWEEP_CONFIG_VERSION };
+	uint16_t points = dev.v2 ? dev.config_v2.numPoints : dev.config.numPoints;
+	const uint8_t* src = NULL;
+	size_t avail = 0;
+
+	sim_bus_use(periodic_bus_us(len));
+
+	if (!read) {
+		if (reg == AMU_REG_DATA_PTR_EXT_ADDR)
+			memcpy(&dev.ext, data, sizeof(amu_ext_addr_t));
+		else if (reg == AMU_REG_DATA_PTR_SWEEP_CONFIG) {
+			memcpy(&dev.config, data, std::min(len, sizeof(ivsweep_config_t)));
+			amu_sweep_config_from_v1(&dev.config_v2, &dev.config);
+		}
+		else if (dev.v2 && (reg == AMU_REG_DATA_PTR_EXT_DATA) && (dev.ext.reg == AMU_REG_EXT_SWEEP_CONFIG_V2) && (dev.ext.offset < sizeof(ivsweep_config_v2_t))) {
+			memcpy((uint8_t*)&dev.config_v2 + dev.ext.offset, data, std::min(len, sizeof(ivsweep_config_v2_t) - dev.ext.offset));
+			dev.config_v2.numPoints = std::min<uint16_t>(dev.config_v2.numPoints, BENCH_SWCFG_MAX_POINTS);
+			amu_sweep_config_to_v1(&dev.config, &dev.config_v2);
+		}
+		return 0;
+	}
+
+	memset(data, 0, len);		// what firmware without the register answers
+
+	switch (reg) {
+		case AMU_REG_DATA_PTR_SWEEP_CONFIG:		src = (const uint8_t*)&dev.config; avail = sizeof(ivsweep_config_t); break;
+		case AMU_REG_DATA_PTR_VOLTAGE:			src = (const uint8_t*)dev.voltage; avail = points * sizeof(float); break;
+		case AMU_REG_DATA_PTR_CURRENT:			src = (const uint8_t*)dev.current; avail = points * sizeof(float); break;
+		case AMU_REG_DATA_PTR_EXT_DATA:
+			if (dev.v2 && (dev.ext.reg == AMU_REG_EXT_CAPABILITIES) && (dev.ext.offset < sizeof(caps))) {
+				src = (const uint8_t*)&caps + dev.ext.offset;
+				avail = sizeof(caps) - dev.ext.offset;
+			}
+			else if (dev.v2 && (dev.ext.reg == AMU_REG_EXT_SWEEP_CONFIG_V2) && (dev.ext.offset < sizeof(ivsweep_config_v2_t))) {
+				src = (const uint8_t*)&dev.config_v2 + dev.ext.offset;
+				avail = sizeof(ivsweep_config_v2_t) - dev.ext.offset;
+			}
+			break;
+		default: break;
+	}
+
+	if (src)
+		memcpy(data, src, std::min(len, avail));
+	return 0;
+}
+
+/**
+ * @brief Runs the configured sweep of a simulated device, each point takes its delay plus one conversion
+ */
+static void sim_swcfg_sweep(uint8_t d, const bench_cell_t& cell, double vend, std::mt19937& rng) {
+	auto& dev = sim_swcfg[d];
+	std::normal_distribution<float> noise(0.0f, 1e-5f);
+	uint16_t points = dev.v2 ? dev.config_v2.numPoints : dev.config.numPoints;
+	uint32_t delay_us = dev.v2 ? dev.config_v2.delay_us : dev.config.delay * 1000u;
+
+	for (uint16_t j = 0; j < points; j++) {
+		double v = vend * j / (points - 1);
+		dev.voltage[j] = (float)v;
+		dev.current[j] = (float)cell_current(cell, v) + noise(rng);
+	}
+
+	sim_bus.clock_us += (uint64_t)points * (delay_us + BENCH_SWCFG_CONV_US);
+}
+
+/**
+ * @brief IV sweeps of the same cell at the finest settings v1 and v2 sweep configurations can express
+ */
+static bool bench_sweep_config(void) {
+	amu_device_t* dev = (amu_device_t*)amu_dev_init(sim_swcfg_transfer);
+	amu_transfer_fptr_t transport = dev->transfer;
+	const bench_cell_t cell = { 0.040, 1e-12, 1.3, 0.5, 2000.0 };
+	const double vend = cell_voc(cell) * 1.02;
+	static float voltage[BENCH_SWCFG_MAX_POINTS], current[BENCH_SWCFG_MAX_POINTS];
+	double ptrue = 0.0;
+	int8_t failed = 0;
+
+	printf("\nIV sweeps of %u points/%u us and %u points/%u us with %u us conversions, %u sweeps on a simulated 400 kHz bus\n",
+		IVSWEEP_MAX_POINTS, 1000u, BENCH_SWCFG_MAX_POINTS, BENCH_SWCFG_DELAY_US, BENCH_SWCFG_CONV_US, BENCH_SWCFG_SWEEPS);
+
+	for (uint32_t j = 0; j <= 200000; j++) {
+		double v = vend * j / 200000;
+		ptrue = std::max(ptrue, v * cell_current(cell, v));
+	}
+
+	memset(sim_swcfg, 0, sizeof(sim_swcfg));
+	sim_swcfg[1].v2 = true;
+
+	dev->transfer = sim_swcfg_transfer;
+
+	auto run = [&](const char* name, uint8_t d, uint16_t numPoints, uint32_t delay_us, double* sweep_ms) {
+		uint8_t address = BENCH_SWCFG_ADDRESS + d;
+		ivsweep_config_v2_t config = {};
+		amu_capabilities_t caps;
+		ivsweep_config_t v1;
+		ivsweep_meta_t meta;
+		std::mt19937 rng(49);
+		double error = 0.0;
+		int8_t result;
+
+		config.numPoints = numPoints;
+		config.delay_us = delay_us;
+
+		sim_bus.clock_us = 0;
+		failed |= amu_capabilities_read(address, &caps);
+		result = amu_sweep_config_write(address, &caps, &config);
+		failed |= amu_sweep_config_read(address, &caps, &config);
+		amu_sweep_config_to_v1(&v1, &config);
+
+		if (result != 0) {
+			printf("  %-26s not supported (%d)\n", name, result);
+			return;
+		}
+
+		for (uint16_t s = 0; s < BENCH_SWCFG_SWEEPS; s++) {
+			sim_swcfg_sweep(d, cell, vend, rng);
+			failed |= amu_dev_transfer(address, AMU_REG_DATA_PTR_VOLTAGE, (uint8_t*)voltage, config.numPoints * sizeof(float), AMU_TWI_TRANSFER_READ);
+			failed |= amu_dev_transfer(address, AMU_REG_DATA_PTR_CURRENT, (uint8_t*)current, config.numPoints * sizeof(float), AMU_TWI_TRANSFER_READ);
+			amu_iv_analyze(voltage, current, config.numPoints, &v1, &meta);
+			error = std::max(error, fabs(meta.pmax / ptrue - 1.0));
+		}
+
+		*sweep_ms = sim_bus.clock_us / 1000.0 / BENCH_SWCFG_SWEEPS;
+		failed |= (error > 1e-3);			// every point analyzed, a truncated sweep misses the maximum power point
+		printf("  %-26s %4u points %7.1f ms/sweep, %.2f mV steps\n", name, config.numPoints, *sweep_ms, vend / (config.numPoints - 1) * 1e3);
+	};
+
+	double v1_ms = 0.0, fast_ms = 0.0, fine_ms = 0.0, old_ms = 0.0;
+
+	run("v1, 1 ms delay:", 1, IVSWEEP_MAX_POINTS, 1000, &v1_ms);
+	run("v2, same points:", 1, IVSWEEP_MAX_POINTS, BENCH_SWCFG_DELAY_US, &fast_ms);
+	run("v2, more points:", 1, BENCH_SWCFG_MAX_POINTS, BENCH_SWCFG_DELAY_US, &fine_ms);
+	run("old firmware, v1 config:", 0, IVSWEEP_MAX_POINTS, 1000, &old_ms);
+	run("old firmware, v2 config:", 0, BENCH_SWCFG_MAX_POINTS, BENCH_SWCFG_DELAY_US, &old_ms);
+
+	printf("  same points %.1fx faster, %ux the points in %.1fx the time%s\n", v1_ms / fast_ms, BENCH_SWCFG_MAX_POINTS / IVSWEEP_MAX_POINTS,
+		fine_ms / v1_ms, failed ? ", FAILED" : "");
+
+	dev->transfer = transport;
+
+	return !failed;
+}
+
+/**
+ * @brief Per-point noise of repeated sweeps of one cell, accumulated as they arrive against statistics of the stored sweeps
+ */
+static void bench_stats(void) {
+	const bench_cell_t cell = { 0.040, 1e-12, 1.3, 0.5, 2000.0 };
+	const double vend = cell_voc(cell) * 1.02;
+	std::vector<float> voltage((size_t)BENCH_STATS_SWEEPS * IVSWEEP_MAX_POINTS), current(voltage.size());
+	std::vector<amu_meas_t> meas(BENCH_STATS_MEAS);
+	std::vector<double> mean(IVSWEEP_MAX_POINTS), sq(IVSWEEP_MAX_POINTS);
+	std::mt19937 rng(50);
+	std::normal_distribution<float> vnoise(0.0f, 20e-6f), inoise(0.0f, 1e-6f);
+	AMUSweepStats stats;
+	AMUMeasStats meas_stats;
+	double stream_s, stored_s, meas_s, worst = 0.0;
+
+	printf("\nNoise of %u sweeps of %u points\n", BENCH_STATS_SWEEPS, IVSWEEP_MAX_POINTS);
+
+	for (uint32_t s = 0; s < BENCH_STATS_SWEEPS; s++) {
+		for (uint16_t j = 0; j < IVSWEEP_MAX_POINTS; j++) {
+			double v = vend * j / (IVSWEEP_MAX_POINTS - 1);
+			voltage[(size_t)s * IVSWEEP_MAX_POINTS + j] = (float)v + vnoise(rng);
+			current[(size_t)s * IVSWEEP_MAX_POINTS + j] = (float)cell_current(cell, v) + inoise(rng) * (1.0f + j / 50.0f);
+		}
+	}
+
+	for (uint32_t i = 0; i < BENCH_STATS_MEAS; i++)
+		meas[i] = { 0.6f + vnoise(rng), 25.0f + vnoise(rng) * 1000.0f };
+
+	auto start = bench_clock_t::now();
+	for (uint32_t s = 0; s < BENCH_STATS_SWEEPS; s++)
+		stats.add(&voltage[(size_t)s * IVSWEEP_MAX_POINTS], &current[(size_t)s * IVSWEEP_MAX_POINTS], IVSWEEP_MAX_POINTS);
+	stream_s = seconds_since(start);
+
+	// after the fact, as noise_test.py does with numpy: every sweep kept, then a mean and a variance pass per point
+	start = bench_clock_t::now();
+	for (uint16_t j = 0; j < IVSWEEP_MAX_POINTS; j++) {
+		double sum = 0.0, sum2 = 0.0;
+		for (uint32_t s = 0; s < BENCH_STATS_SWEEPS; s++)
+			sum += current[(size_t)s * IVSWEEP_MAX_POINTS + j];
+		mean[j] = sum / BENCH_STATS_SWEEPS;
+		for (uint32_t s = 0; s < BENCH_STATS_SWEEPS; s++) {
+			double d = current[(size_t)s * IVSWEEP_MAX_POINTS + j] - mean[j];
+			sum2 += d * d;
+		}
+		sq[j] = sum2;
+	}
+	stored_s = seconds_since(start);
+
+	for (uint16_t j = 0; j < IVSWEEP_MAX_POINTS; j++) {
+		double sd = sqrt(sq[j] / (BENCH_STATS_SWEEPS - 1));
+		worst = std::max(worst, fabs(stats.current().stddev(j) / sd - 1.0));
+		worst = std::max(worst, fabs(stats.current().mean(j) - mean[j]) / sd);
+	}
+
+	start = bench_clock_t::now();
+	meas_stats.add(meas.data(), meas.size());
+	meas_s = seconds_since(start);
+
+	printf("  streaming:       %7.1f ns/sweep (voltage and current), %u bytes of state\n", stream_s / BENCH_STATS_SWEEPS * 1e9,
+		(unsigned)(2 * IVSWEEP_MAX_POINTS * (2 * sizeof(double) + 2 * sizeof(float))));
+	printf("  stored, 2 pass:  %7.1f ns/sweep (current only), %.1f MB of sweeps kept\n", stored_s / BENCH_STATS_SWEEPS * 1e9,
+		voltage.size() * 2 * sizeof(float) / 1e6);
+	printf("  worst difference %.1e of the standard deviation, current noise %.2f uA at 0 V, %.2f uA at Voc\n", worst,
+		stats.current().stddev(0) * 1e6, stats.current().stddev(IVSWEEP_MAX_POINTS - 1) * 1e6);
+	printf("  %u amu_meas_t:   %7.1f ns each, %.2f uV rms\n", BENCH_STATS_MEAS, meas_s / BENCH_STATS_MEAS * 1e9,
+		meas_stats.stats().stddev(AMU_STATS_MEAS_MEASUREMENT) * 1e6);
+}
+
+int main(void) {
+	std::vector<ivsweep_packet_t> packets(BENCH_SWEEPS);
+	std::vector<ivsweep_config_t> configs(BENCH_SWEEPS);
+	std::vector<bench_cell_t> cells(BENCH_SWEEPS);
+
+	bool ok = true;
+
+	make_sweeps(packets, configs, cells);
+
+	bench_analytics(packets, configs, cells);
+
+	bench_diode_fit();
+
+	bench_tsensor();
+
+	ok &= bench_archive(packets, configs);
+
+	ok &= bench_timeseries();
+
+	ok &= bench_trace();
+
+	bench_sched();
+
+	bench_timesync();
+
+	ok &= bench_periodic();
+
+	ok &= bench_calibration();
+
+	ok &= bench_adc_readout();
+
+	ok &= bench_identity();
+
+	ok &= bench_discovery();
+
+	ok &= bench_sweep_config();
+
+	bench_stats();
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+/**
+ * @file amulibc_config.h
+ * @brief
+ *
+ * @author  CJM28241
+ * @date    10/18/2026
+ */
+
+
+#ifndef AMULIBC_CONFIG_H_
+#define AMULIBC_CONFIG_H_
+
+#define __AMU_DEVICE__
+
+
+#endif /* AMULIBC_CONFIG_H_ */
@@ -0,0 +1,132 @@
+#include <Arduino.h>
+#include <math.h>
+#include <amulib.h>
+
+#define BENCH_SAMPLES		128
+#define BENCH_PASSES		20
+#define ERROR_SAMPLES		20000
+
+#define SS_HVAL				1.0f
+#define SS_RVAL				1.2f
+#define SS_THRESHOLD		1000
+
+static const amu_coeff_t yaw_coeff = { { 0.31f, 1.02f, -1.5e-4f, 2.0e-6f } };
+static const amu_coeff_t pitch_coeff = { { -0.18f, 0.98f, 1.1e-4f, -1.2e-6f } };
+
+static amu_ss_fixed_t ss_fixed;
+
+static int32_t diode_codes[BENCH_SAMPLES][4];
+static float diode_float[BENCH_SAMPLES][4];
+
+volatile int32_t sink_fixed;
+volatile float sink_float;
+
+/**
+ * @brief Random diode readings, 24-bit ADC codes spread over a few decades of illumination
+ */
+static void random_diodes(int32_t* codes, float* values) {
+	int32_t full = 1L << random(12, 25);
+
+	for (uint8_t i = 0; i < 4; i++) {
+		codes[i] = random(0, full);
+		values[i] = (float)codes[i];
+	}
+}
+
+/**
+ * @brief Average cycles per call of both sun sensor paths, from micros() over BENCH_PASSES passes of BENCH_SAMPLES readings
+ */
+static void bench_cycles(void) {
+	amu_ss_angle_q16_t q;
+	ss_angle_t a;
+	uint32_t start, t_fixed, t_float;
+
+	for (uint16_t n = 0; n < BENCH_SAMPLES; n++)
+		random_diodes(diode_codes[n], diode_float[n]);
+
+	start = micros();
+	for (uint8_t pass = 0; pass < BENCH_PASSES; pass++) {
+		for (uint16_t n = 0; n < BENCH_SAMPLES; n++) {
+			amu_ss_angle_fixed(&ss_fixed, diode_codes[n], &q);
+			sink_fixed = q.yaw + q.pitch;
+		}
+	}
+	t_fixed = micros() - start;
+
+	start = micros();
+	for (uint8_t pass = 0; pass < BENCH_PASSES; pass++) {
+		for (uint16_t n = 0; n < BENCH_SAMPLES; n++) {
+			amu_ss_angle_float(diode_float[n], &yaw_coeff, &pitch_coeff, SS_HVAL, SS_RVAL, SS_THRESHOLD, &a);
+			sink_float = a.yaw + a.pitch;
+		}
+	}
+	t_float = micros() - start;
+
+	float calls = (float)BENCH_PASSES * BENCH_SAMPLES;
+	float cycles_per_us = F_CPU / 1000000.0f;
+
+	Serial.print("fixed: ");
+	Serial.print(t_fixed * cycles_per_us / calls, 0);
+	Serial.println(" cycles/call");
+	Serial.print("float: ");
+	Serial.print(t_float * cycles_per_us / calls, 0);
+	Serial.println(" cycles/call");
+	Serial.print("speedup: ");
+	Serial.println((float)t_float / t_fixed, 1);
+}
+
+/**
+ * @brief Largest difference between the fixed-point and float angles over ERROR_SAMPLES random readings
+ */
+static void bench_error(void) {
+	int32_t codes[4];
+	float values[4];
+	amu_ss_angle_q16_t q;
+	ss_angle_t a;
+	float max_err = 0.0f;
+	uint32_t mismatches = 0;
+
+	for (uint32_t n = 0; n < ERROR_SAMPLES; n++) {
+		random_diodes(codes, values);
+
+		bool ok_fixed = amu_ss_angle_fixed(&ss_fixed, codes, &q);
+		bool ok_float = amu_ss_angle_float(values, &yaw_coeff, &pitch_coeff, SS_HVAL, SS_RVAL, SS_THRESHOLD, &a);
+
+		if (ok_fixed != ok_float) {
+			mismatches++;
+			continue;
+		}
+		if (!ok_fixed)
+			continue;
+
+		max_err = fmaxf(max_err, fabsf(AMU_SS_Q16_TO_FLOAT(q.yaw) - a.yaw));
+		max_err = fmaxf(max_err, fabsf(AMU_SS_Q16_TO_FLOAT(q.pitch) - a.pitch));
+	}
+
+	Serial.print("max error: ");
+	Serial.print(max_err, 6);
+	Serial.print(" deg over ");
+	Serial.print(ERROR_SAMPLES);
+	Serial.print(" readings, threshold mismatches: ");
+	Serial.println(mismatches);
+}
+
+void setup() {
+
+	Serial.begin(115200);
+	while (!Serial);
+
+	if (!amu_ss_fixed_init(&ss_fixed, &yaw_coeff, &pitch_coeff, SS_HVAL, SS_RVAL, SS_THRESHOLD)) {
+		Serial.println("calibration out of range for the fixed-point path");
+		return;
+	}
+
+	Serial.print("Sun sensor angles, CORDIC iterations: ");
+	Serial.println(AMU_SS_CORDIC_ITERATIONS);
+
+	bench_cycles();
+	bench_error();
+}
+
+void loop() {
+}
@@ -9,6 +9,8 @@
 #define AMU_DEV_TWI_SDA_PIN     35
 #define AMU_DEV_TWI_SCL_PIN     37
 #define AMU_DEVICES_MAX         8
+#define AMU_DEV_HOTPLUG_MS      1000    // period of the hot-plug check
+#define AMU_DEV_HOTPLUG_WINDOW  4       // unknown addresses probed per check
 
 // Devboard Pins
 #define AMU_DEV_AMU_RESET_PIN       6
@@ -26,6 +28,7 @@ void led_color(uint8_t red, uint8_t green, uint8_t blue);
 void amu_dev_check_switch(void);
 void amu_dev_read_load_current(void);
 void amu_dev_read_usb(void);
+void amu_dev_check_hotplug(void);
 
 void led_blink(void);
 
@@ -57,13 +60,16 @@ void amu_dut_reset(void) {
 }
 
 amu_device_t * amu_dev = nullptr;
+amu_discovery_t amu_discovery;
 
 void amu_dev_scan_for_devices(void) {
 
 //   Serial.printf("Scanning for AMUs...\n");
   led_color(0, 0, 0);
+
+  amu_discovery_scan(&amu_discovery);
   
-  if (amu_scan_for_devices(0x10, 0x20) <= 1) {
+  if (amu_discovery_publish(&amu_discovery) <= 1) {
     //   Serial.println(F("No AMUs found."));
       led_color(5, 0, 0);
   }
@@ -117,6 +123,8 @@ void setup() {
 
 	  amu_dev_setDeviceTypeStr("AMU-DEV");
 
+    amu_discovery_init(&amu_discovery, twi_transfer, 0x10, 0x20);
+
     amu_dev->amu_regs->hardware_revision = AMU_HARDWARE_REVISION_AMU_ESP32_DEV;
 
     led_color(0, 0, 5);  // Blue to indicate ready
@@ -134,6 +142,25 @@ void loop() {
 
     amu_dev_read_usb();
 
+    amu_dev_check_hotplug();
+
+}
+
+// Probes the known AMUs and a few other addresses, only updates the device table when one came or went
+void amu_dev_check_hotplug(void) {
+
+  static uint32_t last_check = 0;
+
+  if ((millis() - last_check) < AMU_DEV_HOTPLUG_MS)
+    return;
+  last_check = millis();
+
+  if (amu_discovery_rescan(&amu_discovery, AMU_DEV_HOTPLUG_WINDOW) > 0) {
+    if (amu_discovery_publish(&amu_discovery) <= 1)
+      led_color(5, 0, 0);
+    else
+      led_color(0, 0, 5);
+  }
 }
 
 void amu_dev_read_usb(void) {
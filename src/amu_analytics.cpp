@@ -0,0 +1,265 @@
+/**
+ * @file amu_analytics.cpp
+ * @brief Host side IV curve analytics
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_analytics.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <math.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define AMU_IV_BATCH_CHUNK		64			// sweeps handed to a thread at a time
+#define AMU_IV_MPP_POINTS		5			// points around the measured maximum power fitted by the quadratic
+
+/**
+ * @brief Sign that makes the current positive in the generating quadrant, taken at the point closest to 0V
+ *
+ * @param voltage 		voltage of each point
+ * @param current 		current of each point
+ * @param numPoints 	number of points, at least 1
+ * @return float 		1 or -1
+ */
+float amu_iv_current_sign(const float* voltage, const float* current, uint16_t numPoints) {
+	uint16_t k = 0;
+	float vmin = fabsf(voltage[0]);
+
+	for (uint16_t j = 1; j < numPoints; j++) {
+		float v = fabsf(voltage[j]);
+		if (v < vmin) {
+			vmin = v;
+			k = j;
+		}
+	}
+
+	return (current[k] < 0.0f) ? -1.0f : 1.0f;
+}
+
+/**
+ * @brief Interpolates x where y crosses zero
+ *
+ * The first sign change of y is interpolated linearly. When y never crosses zero the line through
+ * the point closest to zero and its neighbour is extrapolated.
+ *
+ * @param x 			abscissa
+ * @param y 			ordinate, scaled by ysign
+ * @param ysign 		1 or -1
+ * @param numPoints 	number of points, at least 2
+ * @return float 		x at y = 0
+ */
+static float _amu_iv_zero_crossing(const float* x, const float* y, float ysign, uint16_t numPoints) {
+	uint16_t k = 0;
+	float ymin = fabsf(y[0]);
+
+	for (uint16_t j = 1; j < numPoints; j++) {
+		float y0 = ysign * y[j - 1];
+		float y1 = ysign * y[j];
+
+		if ((y0 == 0.0f) || ((y0 > 0.0f) != (y1 > 0.0f)))
+			return (y0 == y1) ? x[j - 1] : x[j - 1] - y0 * (x[j] - x[j - 1]) / (y1 - y0);
+
+		if (fabsf(y[j]) < ymin) {
+			ymin = fabsf(y[j]);
+			k = j;
+		}
+	}
+
+	if (ysign * y[numPoints - 1] == 0.0f)
+		return x[numPoints - 1];
+
+	uint16_t a = (k == 0) ? 0 : k - 1;
+	uint16_t b = a + 1;
+	float dy = ysign * (y[b] - y[a]);
+
+	if (dy == 0.0f)
+		return x[k];
+
+	return x[a] - ysign * y[a] * (x[b] - x[a]) / dy;
+}
+
+/**
+ * @brief Refines the maximum power point with a least squares quadratic through the points around the measured maximum
+ *
+ * Fitting AMU_IV_MPP_POINTS points rather than the three closest keeps the measurement noise from
+ * moving the vertex. The refined point is only used when the quadratic has its maximum inside the
+ * fitted points.
+ *
+ * @param voltage 		voltages of the fitted points
+ * @param power 		powers of the fitted points
+ * @param n 			number of fitted points, at least 3
+ * @param vmp 			in: voltage of the measured maximum, out: refined voltage
+ * @param pmp 			in: measured maximum power, out: refined power
+ */
+static void _amu_iv_refine_mpp(const float* voltage, const float* power, uint16_t n, float* vmp, float* pmp) {
+	double x0 = *vmp;			// centered on the measured maximum for conditioning
+	double s1 = 0, s2 = 0, s3 = 0, s4 = 0, t0 = 0, t1 = 0, t2 = 0;
+
+	for (uint16_t j = 0; j < n; j++) {
+		double x = voltage[j] - x0;
+		double x2 = x * x;
+		s1 += x;
+		s2 += x2;
+		s3 += x2 * x;
+		s4 += x2 * x2;
+		t0 += power[j];
+		t1 += power[j] * x;
+		t2 += power[j] * x2;
+	}
+
+	// normal equations [s4 s3 s2; s3 s2 s1; s2 s1 n] [a b c]' = [t2 t1 t0]', solved by Cramer's rule
+	double det = s4 * (s2 * n - s1 * s1) - s3 * (s3 * n - s1 * s2) + s2 * (s3 * s1 - s2 * s2);
+
+	if (det == 0.0)
+		return;
+
+	double a = (t2 * (s2 * n - s1 * s1) - s3 * (t1 * n - s1 * t0) + s2 * (t1 * s1 - s2 * t0)) / det;
+	double b = (s4 * (t1 * n - s1 * t0) - t2 * (s3 * n - s1 * s2) + s2 * (s3 * t0 - t1 * s2)) / det;
+	double c = (s4 * (s2 * t0 - s1 * t1) - s3 * (s3 * t0 - s1 * t2) + t2 * (s3 * s1 - s2 * s2)) / det;
+
+	if (a >= 0.0)												// not a maximum, keep the measured point
+		return;
+
+	double xv = -b / (2.0 * a);
+
+	if ((xv + x0 < fmin(voltage[0], voltage[n - 1])) || (xv + x0 > fmax(voltage[0], voltage[n - 1])))
+		return;
+
+	*vmp = (float)(xv + x0);
+	*pmp = (float)((a * xv + b) * xv + c);
+}
+
+/**
+ * @brief Computes the figures of merit of one sweep
+ *
+ * Only voc, isc, vmax, imax, pmax, ff and eff are written, the other fields of meta are left as
+ * they are. Currents are reported positive in the generating quadrant. eff is in percent of the
+ * incident power config->am0 (W/cm^2) * config->area (cm^2), and 0 when either is not set.
+ *
+ * @param voltage 		voltage of each point
+ * @param current 		current of each point
+ * @param numPoints 	number of points in the sweep, longer than IVSWEEP_MAX_POINTS for sweeps of ivsweep_config_v2_t
+ * @param config 		sweep configuration for am0 and area, may be NULL
+ * @param meta 			results
+ * @return ivsweep_meta_t* meta
+ */
+ivsweep_meta_t* amu_iv_analyze(const float* voltage, const float* current, uint16_t numPoints, const ivsweep_config_t* config, ivsweep_meta_t* meta) {
+	float power[IVSWEEP_MAX_POINTS];
+	float pmax = 0.0f, vmax, sign;
+	uint16_t k = 0;
+
+	meta->voc = meta->isc = meta->ff = meta->eff = 0.0f;
+	meta->vmax = meta->imax = meta->pmax = 0.0f;
+
+	if (numPoints < 2)
+		return meta;
+
+	sign = amu_iv_current_sign(voltage, current, numPoints);
+
+	// power in blocks of IVSWEEP_MAX_POINTS, each in its own branch free pass so it vectorizes, the maximum vectorizes as well with -ffast-math
+	for (uint32_t base = 0; base < numPoints; base += IVSWEEP_MAX_POINTS) {
+		uint16_t n = ((numPoints - base) < IVSWEEP_MAX_POINTS) ? (uint16_t)(numPoints - base) : IVSWEEP_MAX_POINTS;
+		float block_max;
+		uint16_t j;
+
+		for (j = 0; j < n; j++)
+			power[j] = sign * voltage[base + j] * current[base + j];
+
+		block_max = power[0];
+		for (j = 1; j < n; j++)
+			block_max = (power[j] > block_max) ? power[j] : block_max;
+
+		if ((base == 0) || (block_max > pmax)) {
+			for (j = 0; (j < n - 1) && (power[j] != block_max); j++);
+			pmax = block_max;
+			k = (uint16_t)(base + j);
+		}
+	}
+
+	vmax = voltage[k];
+
+	if (numPoints >= 3) {
+		uint16_t first = (k > AMU_IV_MPP_POINTS / 2) ? (k - AMU_IV_MPP_POINTS / 2) : 0;
+		uint16_t last = first + AMU_IV_MPP_POINTS;
+
+		if (last > numPoints) {
+			last = numPoints;
+			first = (numPoints > AMU_IV_MPP_POINTS) ? (numPoints - AMU_IV_MPP_POINTS) : 0;
+		}
+
+		for (uint16_t j = first; j < last; j++)
+			power[j - first] = sign * voltage[j] * current[j];
+
+		_amu_iv_refine_mpp(&voltage[first], power, last - first, &vmax, &pmax);
+	}
+
+	meta->isc = sign * _amu_iv_zero_crossing(current, voltage, 1.0f, numPoints);
+	meta->voc = _amu_iv_zero_crossing(voltage, current, sign, numPoints);
+	meta->pmax = pmax;
+	meta->vmax = vmax;
+	meta->imax = (vmax != 0.0f) ? (pmax / vmax) : 0.0f;
+
+	if ((meta->voc * meta->isc) > 0.0f)
+		meta->ff = pmax / (meta->voc * meta->isc);
+
+	if (config && ((config->am0 * config->area) > 0.0f))
+		meta->eff = 100.0f * pmax / (config->am0 * config->area);
+
+	return meta;
+}
+
+/**
+ * @brief Computes the figures of merit of many sweeps in parallel
+ *
+ * Threads take chunks of AMU_IV_BATCH_CHUNK sweeps from a shared counter, so uneven sweep lengths
+ * still balance across threads.
+ *
+ * @param packets 		sweeps
+ * @param configs 		configuration of each sweep, numPoints, am0 and area are used
+ * @param count 		number of sweeps
+ * @param metas 		results, one per sweep
+ * @param threads 		number of threads, 0 for one per hardware thread
+ */
+void amu_iv_analyze_batch(const ivsweep_packet_t* packets, const ivsweep_config_t* configs, size_t count, ivsweep_meta_t* metas, unsigned threads) {
+	std::atomic<size_t> next(0);
+
+	auto worker = [&]() {
+		size_t start;
+		while ((start = next.fetch_add(AMU_IV_BATCH_CHUNK, std::memory_order_relaxed)) < count) {
+			size_t end = (start + AMU_IV_BATCH_CHUNK < count) ? (start + AMU_IV_BATCH_CHUNK) : count;
+			for (size_t s = start; s < end; s++)
+				amu_iv_analyze(packets[s].voltage, packets[s].current, configs[s].numPoints, &configs[s], &metas[s]);
+		}
+	};
+
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+
+	size_t chunks = (count + AMU_IV_BATCH_CHUNK - 1) / AMU_IV_BATCH_CHUNK;
+	if (threads > chunks)
+		threads = (unsigned)chunks;
+
+	if (threads <= 1) {
+		worker();
+		return;
+	}
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+
+	for (unsigned t = 1; t < threads; t++)
+		pool.emplace_back(worker);
+
+	worker();
+
+	for (std::thread& t : pool)
+		t.join();
+}
+
+#endif /* __AMU_HOST__ */
@@ -0,0 +1,34 @@
+/**
+ * @file amu_analytics.h
+ * @brief Host side IV curve analytics
+ *
+ * Recomputes the ivsweep_meta_t figures of merit (voc, isc, vmax, imax, pmax, ff, eff) from the
+ * raw voltage and current arrays of a sweep, for post-processing large numbers of sweeps on a PC.
+ * Isc and Voc are interpolated at the zero crossings, and the maximum power point is refined by a
+ * least-squares quadratic over the 5 points around the maximum. Currents are normalized so
+ * the generating quadrant is positive, whichever sign convention the sweep was recorded with.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_ANALYTICS_H__
+#define __AMU_ANALYTICS_H__
+
+#include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_types.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+
+float			amu_iv_current_sign(const float* voltage, const float* current, uint16_t numPoints);
+
+ivsweep_meta_t*	amu_iv_analyze(const float* voltage, const float* current, uint16_t numPoints, const ivsweep_config_t* config, ivsweep_meta_t* meta);
+
+void			amu_iv_analyze_batch(const ivsweep_packet_t* packets, const ivsweep_config_t* configs, size_t count, ivsweep_meta_t* metas, unsigned threads = 0);
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_ANALYTICS_H__ */
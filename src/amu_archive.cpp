@@ -0,0 +1,405 @@
+/**
+ * @file amu_archive.cpp
+ * @brief Append-only binary sweep archive (.amusweep) with a memory mapped reader
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_archive.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <string.h>
+#include <filesystem>
+#include <system_error>
+
+#include "amulibc/amu_crc.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define AMU_ARCHIVE_CRC_OFFSET		offsetof(amu_archive_record_t, numPoints)
+
+static inline size_t _align(size_t len) {
+	return (len + AMU_ARCHIVE_ALIGN - 1) & ~(size_t)(AMU_ARCHIVE_ALIGN - 1);
+}
+
+static uint8_t _array_count(uint8_t arrays) {
+	uint8_t count = 0;
+
+	for (arrays &= AMU_ARCHIVE_ALL; arrays; arrays >>= 1)
+		count += arrays & 1;
+
+	return count;
+}
+
+static bool _header_valid(const amu_archive_header_t* header) {
+	return (memcmp(header->magic, AMU_ARCHIVE_MAGIC, sizeof(header->magic)) == 0) &&
+		(header->version == AMU_ARCHIVE_VERSION) &&
+		(header->header_size == sizeof(amu_archive_header_t)) &&
+		(header->record_size == sizeof(amu_archive_record_t)) &&
+		(header->align == AMU_ARCHIVE_ALIGN);
+}
+
+/**
+ * @brief Bytes taken by a record, including the padding that aligns the next one
+ *
+ * @param numPoints 	points in each array
+ * @param arrays 		amu_archive_array_t flags of the arrays stored
+ * @return size_t 		record length
+ */
+size_t AMUSweepArchive::recordLength(uint16_t numPoints, uint8_t arrays) {
+	return _align(sizeof(amu_archive_record_t)) + _array_count(arrays) * _align((size_t)numPoints * sizeof(float));
+}
+
+/**
+ * @brief Opens an archive for appending, creating it if it does not exist
+ *
+ * A record left incomplete by a crash at the end of the file is cut off first, so new records stay
+ * reachable. An archive with a malformed record before its end is left untouched, cutting it there
+ * would discard the valid records that follow.
+ *
+ * @param path 		archive file
+ * @return false if the file exists but is not an archive, has a malformed record before its end, or cannot be written
+ */
+bool AMUSweepArchiveWriter::open(const char* path) {
+	std::error_code ec;
+	uintmax_t size = std::filesystem::file_size(path, ec);
+
+	close();
+
+	if (!ec && (size > 0)) {
+		AMUSweepArchive existing;
+
+		if (!existing.open(path))
+			return false;
+
+		size_t valid = existing.validLength();
+		bool truncated = existing.truncated();
+		bool torn = existing.tornTail();
+		existing.close();
+
+		if (truncated && !torn)
+			return false;
+
+		if (truncated) {
+			std::filesystem::resize_file(path, valid, ec);
+			if (ec)
+				return false;
+		}
+
+		file = fopen(path, "ab");
+		return (file != NULL);
+	}
+
+	file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	amu_archive_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, AMU_ARCHIVE_MAGIC, sizeof(header.magic));
+	header.version = AMU_ARCHIVE_VERSION;
+	header.header_size = sizeof(amu_archive_header_t);
+	header.record_size = sizeof(amu_archive_record_t);
+	header.align = AMU_ARCHIVE_ALIGN;
+
+	if (fwrite(&header, sizeof(header), 1, file) != 1) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Appends one sweep
+ *
+ * @param dut 			DUT the sweep was taken on, NULL for none
+ * @param config 		sweep configuration, NULL for none
+ * @param meta 			sweep results, NULL for none
+ * @param packet 		sweep arrays
+ * @param numPoints 	points in each array, at most IVSWEEP_MAX_POINTS
+ * @param arrays 		amu_archive_array_t flags of the arrays to store
+ * @return false on a write error
+ */
+bool AMUSweepArchiveWriter::append(const amu_dut_t* dut, const ivsweep_config_t* config, const ivsweep_meta_t* meta, const ivsweep_packet_t* packet, uint16_t numPoints, uint8_t arrays) {
+	const void* source[5];
+	amu_archive_record_t* header;
+	size_t offset, array_len;
+
+	if (!file || !packet)
+		return false;
+
+	if (numPoints > IVSWEEP_MAX_POINTS)
+		numPoints = IVSWEEP_MAX_POINTS;
+
+	source[0] = packet->timestamp;
+	source[1] = packet->voltage;
+	source[2] = packet->current;
+#ifndef __AMU_LOW_MEMORY__
+	source[3] = packet->yaw;
+	source[4] = packet->pitch;
+#else
+	arrays &= ~(AMU_ARCHIVE_YAW | AMU_ARCHIVE_PITCH);
+	source[3] = source[4] = NULL;
+#endif
+	arrays &= AMU_ARCHIVE_ALL;
+
+	record.assign(AMUSweepArchive::recordLength(numPoints, arrays), 0);
+	header = (amu_archive_record_t*)record.data();
+
+	header->magic = AMU_ARCHIVE_RECORD_MAGIC;
+	header->length = (uint32_t)record.size();
+	header->numPoints = numPoints;
+	header->arrays = arrays;
+	if (dut)
+		header->dut = *dut;
+	if (config)
+		header->config = *config;
+	if (meta)
+		header->meta = *meta;
+
+	offset = _align(sizeof(amu_archive_record_t));
+	array_len = (size_t)numPoints * sizeof(float);
+
+	for (uint8_t a = 0; a < 5; a++) {
+		if (arrays & (1 << a)) {
+			memcpy(&record[offset], source[a], array_len);
+			offset += _align(array_len);
+		}
+	}
+
+	header->crc = amu_crc32(&record[AMU_ARCHIVE_CRC_OFFSET], record.size() - AMU_ARCHIVE_CRC_OFFSET);
+
+	return fwrite(record.data(), record.size(), 1, file) == 1;
+}
+
+bool AMUSweepArchiveWriter::flush(void) {
+	return file && (fflush(file) == 0);
+}
+
+void AMUSweepArchiveWriter::close(void) {
+	if (file) {
+		fclose(file);
+		file = NULL;
+	}
+}
+
+/**
+ * @brief Maps an archive and indexes its records
+ *
+ * Only the record headers are touched, the arrays are paged in when they are used. Indexing stops
+ * at the first incomplete or malformed record, see truncated() and tornTail().
+ *
+ * @param path 		archive file
+ * @return false if the file cannot be mapped or is not an archive
+ */
+bool AMUSweepArchive::open(const char* path) {
+	close();
+
+	if (!map(path))
+		return false;
+
+	if ((length < sizeof(amu_archive_header_t)) || !_header_valid((const amu_archive_header_t*)data)) {
+		close();
+		return false;
+	}
+
+	index();
+
+	return true;
+}
+
+void AMUSweepArchive::close(void) {
+	unmap();
+	offsets.clear();
+	valid_length = 0;
+	torn_tail = false;
+}
+
+void AMUSweepArchive::index(void) {
+	size_t offset = sizeof(amu_archive_header_t);
+
+	offsets.clear();
+
+	while ((length - offset) >= sizeof(amu_archive_record_t)) {
+		const amu_archive_record_t* header = (const amu_archive_record_t*)&data[offset];
+
+		if ((header->magic != AMU_ARCHIVE_RECORD_MAGIC) ||
+			(header->length < recordLength(header->numPoints, header->arrays)) ||
+			(header->length % AMU_ARCHIVE_ALIGN) ||
+			(header->length > (length - offset)))
+			break;
+
+		offsets.push_back(offset);
+		offset += header->length;
+	}
+
+	valid_length = offset;
+	torn_tail = tornRecord(offset);
+}
+
+/**
+ * @brief Checks whether the bytes from offset to the end of the file are the start of a record
+ *
+ * A crash while appending leaves such a prefix, a plausible record header that runs past the end of
+ * the file, or too few bytes to hold one.
+ */
+bool AMUSweepArchive::tornRecord(size_t offset) const {
+	const amu_archive_record_t* header = (const amu_archive_record_t*)&data[offset];
+	size_t remaining = length - offset;
+	uint32_t magic;
+
+	if (remaining == 0)
+		return false;
+
+	if (remaining < sizeof(amu_archive_record_t)) {
+		if (remaining < sizeof(magic))
+			return true;
+		memcpy(&magic, header, sizeof(magic));
+		return magic == AMU_ARCHIVE_RECORD_MAGIC;
+	}
+
+	return (header->magic == AMU_ARCHIVE_RECORD_MAGIC) &&
+		(header->length >= recordLength(header->numPoints, header->arrays)) &&
+		((header->length % AMU_ARCHIVE_ALIGN) == 0) &&
+		(header->length > remaining);
+}
+
+/**
+ * @brief Pointers to the headers and arrays of a sweep, valid until the archive is closed
+ *
+ * @param index 		record number, less than size()
+ * @return amu_archive_sweep_t
+ */
+amu_archive_sweep_t AMUSweepArchive::sweep(size_t index) const {
+	amu_archive_sweep_t sweep;
+	const uint8_t* record = &data[offsets[index]];
+	const void** target[5] = { (const void**)&sweep.timestamp, (const void**)&sweep.voltage, (const void**)&sweep.current, (const void**)&sweep.yaw, (const void**)&sweep.pitch };
+	size_t offset = _align(sizeof(amu_archive_record_t));
+
+	sweep.header = (const amu_archive_record_t*)record;
+	sweep.numPoints = sweep.header->numPoints;
+
+	for (uint8_t a = 0; a < 5; a++) {
+		if (sweep.header->arrays & (1 << a)) {
+			*target[a] = &record[offset];
+			offset += _align((size_t)sweep.numPoints * sizeof(float));
+		}
+		else
+			*target[a] = NULL;
+	}
+
+	return sweep;
+}
+
+/**
+ * @brief Checks the CRC-32 of a record
+ *
+ * @param index 		record number, less than size()
+ * @return true if the record is intact
+ */
+bool AMUSweepArchive::verify(size_t index) const {
+	const amu_archive_record_t* header = (const amu_archive_record_t*)&data[offsets[index]];
+
+	return amu_crc32((const uint8_t*)header + AMU_ARCHIVE_CRC_OFFSET, header->length - AMU_ARCHIVE_CRC_OFFSET) == header->crc;
+}
+
+#ifdef _WIN32
+
+bool AMUSweepArchive::map(const char* path) {
+	LARGE_INTEGER size;
+
+	file_handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file_handle == INVALID_HANDLE_VALUE) {
+		file_handle = NULL;
+		return false;
+	}
+
+	if (!GetFileSizeEx((HANDLE)file_handle, &size) || (size.QuadPart == 0)) {
+		unmap();
+		return false;
+	}
+
+	map_handle = CreateFileMappingA((HANDLE)file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!map_handle) {
+		unmap();
+		return false;
+	}
+
+	data = (const uint8_t*)MapViewOfFile((HANDLE)map_handle, FILE_MAP_READ, 0, 0, 0);
+	if (!data) {
+		unmap();
+		return false;
+	}
+
+	length = (size_t)size.QuadPart;
+	return true;
+}
+
+void AMUSweepArchive::unmap(void) {
+	if (data)
+		UnmapViewOfFile(data);
+	if (map_handle)
+		CloseHandle((HANDLE)map_handle);
+	if (file_handle)
+		CloseHandle((HANDLE)file_handle);
+
+	data = NULL;
+	map_handle = NULL;
+	file_handle = NULL;
+	length = 0;
+}
+
+#else
+
+bool AMUSweepArchive::map(const char* path) {
+	struct stat st;
+	void* mapping;
+	int fd = ::open(path, O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	if ((fstat(fd, &st) != 0) || (st.st_size == 0)) {
+		::close(fd);
+		return false;
+	}
+
+	mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);					// the mapping keeps the file open
+
+	if (mapping == MAP_FAILED)
+		return false;
+
+#ifdef MADV_SEQUENTIAL
+	madvise(mapping, (size_t)st.st_size, MADV_SEQUENTIAL);
+#endif
+
+	data = (const uint8_t*)mapping;
+	length = (size_t)st.st_size;
+	return true;
+}
+
+void AMUSweepArchive::unmap(void) {
+	if (data)
+		munmap((void*)data, length);
+
+	data = NULL;
+	length = 0;
+}
+
+#endif
+
+#endif /* __AMU_HOST__ */
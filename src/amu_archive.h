@@ -0,0 +1,147 @@
+/**
+ * @file amu_archive.h
+ * @brief Append-only binary sweep archive (.amusweep) with a memory mapped reader
+ *
+ * An archive is a 64 byte file header followed by one record per sweep. Each record starts on a
+ * 64 byte boundary with an amu_archive_record_t holding the amu_dut_t, ivsweep_config_t and
+ * ivsweep_meta_t of the sweep, followed by the timestamp, voltage, current, yaw and pitch arrays
+ * that are present, each starting on its own 64 byte boundary. Arrays can therefore be used in place
+ * from the mapping, without copies. Records carry their length and a CRC-32 so a reader stops
+ * cleanly at a record torn by a crash, and the writer drops such a tail before appending. A malformed
+ * record anywhere else is left for the user to inspect, the writer refuses to append to the file.
+ * Values are stored in host byte order (little endian on every supported host).
+ *
+ * Files are mapped with mmap, or MapViewOfFile on Windows.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_ARCHIVE_H__
+#define __AMU_ARCHIVE_H__
+
+#include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_types.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#define AMU_ARCHIVE_MAGIC			"AMUSWEEP"
+#define AMU_ARCHIVE_VERSION			1
+#define AMU_ARCHIVE_ALIGN			64
+#define AMU_ARCHIVE_RECORD_MAGIC	0x52554D41UL			// "AMUR"
+
+typedef enum amu_archive_array_enum_t {
+	AMU_ARCHIVE_TIMESTAMP = 0x01,
+	AMU_ARCHIVE_VOLTAGE = 0x02,
+	AMU_ARCHIVE_CURRENT = 0x04,
+	AMU_ARCHIVE_YAW = 0x08,
+	AMU_ARCHIVE_PITCH = 0x10,
+	AMU_ARCHIVE_IV = (AMU_ARCHIVE_VOLTAGE | AMU_ARCHIVE_CURRENT),
+	AMU_ARCHIVE_ALL = 0x1F,
+} amu_archive_array_t;
+
+typedef struct {
+	char magic[8];				/*!< AMU_ARCHIVE_MAGIC */
+	uint16_t version;			/*!< AMU_ARCHIVE_VERSION */
+	uint16_t header_size;		/*!< sizeof(amu_archive_header_t) */
+	uint16_t record_size;		/*!< sizeof(amu_archive_record_t) */
+	uint16_t align;				/*!< AMU_ARCHIVE_ALIGN */
+	uint8_t reserved[48];
+} amu_archive_header_t;
+
+typedef struct {
+	uint32_t magic;				/*!< AMU_ARCHIVE_RECORD_MAGIC */
+	uint32_t length;			/*!< bytes from the start of this record to the start of the next */
+	uint32_t crc;				/*!< CRC-32 of the record from the field after this one to the end */
+	uint16_t numPoints;			/*!< points in each array */
+	uint8_t arrays;				/*!< amu_archive_array_t flags of the arrays present, in flag order */
+	uint8_t reserved;
+	amu_dut_t dut;
+	ivsweep_config_t config;
+	ivsweep_meta_t meta;
+} amu_archive_record_t;
+
+/**
+ * @brief One sweep of a mapped archive, the pointers are into the mapping and NULL for absent arrays
+ */
+typedef struct {
+	const amu_archive_record_t* header;
+	const uint32_t* timestamp;
+	const float* voltage;
+	const float* current;
+	const float* yaw;
+	const float* pitch;
+	uint16_t numPoints;
+} amu_archive_sweep_t;
+
+class AMUSweepArchiveWriter {
+
+public:
+
+	AMUSweepArchiveWriter() {}
+	~AMUSweepArchiveWriter() { close(); }
+
+	AMUSweepArchiveWriter(const AMUSweepArchiveWriter&) = delete;
+	AMUSweepArchiveWriter& operator=(const AMUSweepArchiveWriter&) = delete;
+
+	bool			open(const char* path);
+	bool			append(const amu_dut_t* dut, const ivsweep_config_t* config, const ivsweep_meta_t* meta, const ivsweep_packet_t* packet, uint16_t numPoints, uint8_t arrays = AMU_ARCHIVE_ALL);
+	bool			flush(void);
+	void			close(void);
+
+protected:
+
+	FILE* file = NULL;
+	std::vector<uint8_t> record;
+};
+
+class AMUSweepArchive {
+
+public:
+
+	AMUSweepArchive() {}
+	~AMUSweepArchive() { close(); }
+
+	AMUSweepArchive(const AMUSweepArchive&) = delete;
+	AMUSweepArchive& operator=(const AMUSweepArchive&) = delete;
+
+	bool			open(const char* path);
+	void			close(void);
+
+	size_t			size(void) const { return offsets.size(); }
+	size_t			validLength(void) const { return valid_length; }
+	bool			truncated(void) const { return valid_length < length; }
+	bool			tornTail(void) const { return torn_tail; }		// truncated() only by a record cut short at the end of the file
+
+	amu_archive_sweep_t	sweep(size_t index) const;
+	bool			verify(size_t index) const;
+
+	static size_t	recordLength(uint16_t numPoints, uint8_t arrays);
+
+protected:
+
+	const uint8_t* data = NULL;
+	size_t length = 0;
+	size_t valid_length = 0;
+	bool torn_tail = false;
+	std::vector<size_t> offsets;
+
+#ifdef _WIN32
+	void* file_handle = NULL;
+	void* map_handle = NULL;
+#endif
+
+	bool			map(const char* path);
+	void			unmap(void);
+	void			index(void);
+	bool			tornRecord(size_t offset) const;
+};
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_ARCHIVE_H__ */
@@ -0,0 +1,464 @@
+/**
+ * @file amu_calibration.cpp
+ * @brief Host side ADC and DAC calibration of many devices against one reference source
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_calibration.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include "amulibc/amu_device.h"
+#include "amulibc/amu_regs.h"
+
+static uint32_t _cal_millis(void) {
+	if (amu_device.millis)
+		return amu_device.millis();
+	return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void _cal_delay(uint32_t ms) {
+	if (amu_device.delay)
+		amu_device.delay(ms);
+	else
+		std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+AMUCalibration::AMUCalibration(const amu_cal_source_t& source) : source(source) {
+}
+
+/**
+ * @brief Sets the devices to calibrate, all connected to the reference
+ */
+void AMUCalibration::setDevices(const uint8_t* addresses, uint8_t num) {
+	devices.clear();
+
+	for (uint8_t i = 0; i < num; i++) {
+		device_t device = {};
+		device.address = addresses[i];
+		devices.push_back(device);
+	}
+}
+
+/**
+ * @brief Adds every device found by amu_scan_for_devices() that is not in the list yet
+ *
+ * @return uint8_t 	number of devices added
+ */
+uint8_t AMUCalibration::addScannedDevices(void) {
+	uint8_t added = 0;
+
+	for (int8_t i = 0; i < amu_get_num_devices(); i++) {
+		uint8_t address = amu_get_device_address(i);
+		bool known = false;
+
+		if ((address == AMU_THIS_DEVICE) || (address == AMU_NO_ADDRESS_MATCH))
+			continue;
+
+		for (const device_t& device : devices)
+			known |= (device.address == address);
+
+		if (!known) {
+			device_t device = {};
+			device.address = address;
+			devices.push_back(device);
+			added++;
+		}
+	}
+
+	return added;
+}
+
+/**
+ * @brief Sets the reference steps per range and the conversions averaged per step
+ *
+ * @param points 	2 to AMU_CAL_MAX_POINTS
+ * @param samples 	at least 1
+ */
+void AMUCalibration::setPoints(uint8_t points, uint8_t samples) {
+	this->points = (points < 2) ? 2 : ((points > AMU_CAL_MAX_POINTS) ? AMU_CAL_MAX_POINTS : points);
+	this->samples = samples ? samples : 1;
+}
+
+bool AMUCalibration::sendTo(device_t& device, uint16_t command, const void* data, uint8_t len) {
+	int8_t result;
+
+	if (device.result != 0)
+		return false;
+
+	if (len)
+		_amu_transfer_write(0, (void*)data, len);
+
+	if ((result = amu_dev_send_command_data(device.address, (CMD_t)command, len)) != 0)
+		device.result = result;
+
+	return result == 0;
+}
+
+/**
+ * @brief Sends a command to every device still without errors, without waiting in between
+ *
+ * @return int8_t 	0 if at least one device took the command
+ */
+int8_t AMUCalibration::sendAll(uint16_t command, const void* data, uint8_t len) {
+	bool any = false;
+
+	for (device_t& device : devices)
+		any |= sendTo(device, command, data, len);
+
+	return any ? 0 : -1;
+}
+
+/**
+ * @brief Polls every device until all have finished their command, the devices work on it in parallel
+ */
+void AMUCalibration::waitAll(void) {
+	std::vector<device_t*> pending;
+	uint32_t start = _cal_millis();
+
+	for (device_t& device : devices) {
+		if (device.result == 0)
+			pending.push_back(&device);
+	}
+
+	while (!pending.empty()) {
+		for (size_t i = 0; i < pending.size();) {
+			if (!amu_dev_busy(pending[i]->address)) {
+				pending[i] = pending.back();
+				pending.pop_back();
+			}
+			else
+				i++;
+		}
+
+		if (pending.empty())
+			break;
+
+		if ((_cal_millis() - start) > AMU_CAL_TIMEOUT_MS) {
+			for (device_t* device : pending)
+				device->result = -3;
+			break;
+		}
+
+		_cal_delay(1);
+	}
+}
+
+/**
+ * @brief Adds the last measurement of every device to a step
+ */
+void AMUCalibration::readAll(uint8_t point) {
+	float value;
+
+	for (device_t& device : devices) {
+		int8_t result;
+
+		if (device.result != 0)
+			continue;
+
+		if ((result = amu_dev_transfer(device.address, (uint8_t)AMU_REG_TRANSFER_PTR, (uint8_t*)&value, sizeof(float), AMU_TWI_TRANSFER_READ)) != 0)
+			device.result = result;
+		else
+			device.sum[point] += (double)value;
+	}
+}
+
+/**
+ * @brief Reads the range of every device at a PGA setting
+ *
+ * @return float 	smallest range, 0 if no device answered
+ */
+float AMUCalibration::readRanges(uint8_t channel, uint8_t pga, std::vector<float>& full_scale) {
+	CMD_t command = (CMD_t)((channel == AMU_ADC_CH_VOLTAGE) ? CMD_ADC_CH_PGA_VMAX : CMD_ADC_CH_PGA_IMAX);
+	float range = 0.0f;
+
+	full_scale.assign(devices.size(), 0.0f);
+
+	for (size_t i = 0; i < devices.size(); i++) {
+		device_t& device = devices[i];
+		int8_t result;
+		float fs;
+
+		if (device.result != 0)
+			continue;
+
+		_amu_transfer_write(0, &pga, 1);
+		if ((result = amu_dev_query_command(device.address, command, 1, sizeof(float))) != 0) {
+			device.result = result;
+			continue;
+		}
+
+		_amu_transfer_read(0, &fs, sizeof(float));
+		if (!(fs > 0.0f)) {
+			device.result = -1;
+			continue;
+		}
+
+		full_scale[i] = fs;
+		if ((range == 0.0f) || (fs < range))
+			range = fs;
+	}
+
+	return range;
+}
+
+/**
+ * @brief Reads the offset and gain registers the calibration left in every device
+ */
+void AMUCalibration::readCoefficients(uint8_t channel) {
+	for (device_t& device : devices) {
+		int8_t result;
+
+		if (device.result != 0)
+			continue;
+
+		_amu_transfer_write(0, &channel, 1);
+		if ((result = amu_dev_query_command(device.address, (CMD_t)CMD_ADC_CH_OFFSET_COEFF, 1, sizeof(int32_t))) != 0) {
+			device.result = result;
+			continue;
+		}
+		_amu_transfer_read(0, &device.offset, sizeof(int32_t));
+
+		_amu_transfer_write(0, &channel, 1);
+		if ((result = amu_dev_query_command(device.address, (CMD_t)CMD_ADC_CH_GAIN_COEFF, 1, sizeof(uint32_t))) != 0) {
+			device.result = result;
+			continue;
+		}
+		_amu_transfer_read(0, &device.gain, sizeof(uint32_t));
+	}
+}
+
+/**
+ * @brief Compares the measurements of a device after calibration with the reference
+ *
+ * @param reference 	reference at each step (V or A)
+ * @param measured 		mean measurement of the device at each step
+ * @param points 		steps
+ * @param full_scale 	range of the PGA setting
+ * @param tolerance 	largest difference allowed as a fraction of full_scale
+ * @param result 		points and max_error are filled in
+ * @return true if every step is within the tolerance
+ */
+bool AMUCalibration::check(const double* reference, const double* measured, uint8_t points, float full_scale, float tolerance, amu_cal_result_t* result) {
+	double max_error = 0.0;
+
+	if ((points == 0) || !(full_scale > 0.0f))
+		return false;
+
+	for (uint8_t k = 0; k < points; k++) {
+		double error = fabs(measured[k] - reference[k]);
+		max_error = ((error > max_error) || isnan(error)) ? error : max_error;
+	}
+
+	result->points = points;
+	result->max_error = (float)(max_error / full_scale);
+
+	return result->max_error <= tolerance;
+}
+
+/**
+ * @brief Calibrates one range of the voltage or current channel of every device
+ *
+ * The devices are put in open circuit (voltage) or short circuit (current), set to the PGA range and
+ * their channel calibration is reset. With the reference at zero the ADC of every device runs its
+ * zero-scale calibration, then at AMU_CAL_FULL_SCALE of the range its full-scale calibration. The
+ * reference is then stepped back down to zero and each step is measured by all devices together, the
+ * measurements of the previous step are read back while the reference settles. A device that fails
+ * is left out of the remaining steps, the others carry on.
+ *
+ * @param channel 	AMU_ADC_CH_VOLTAGE or AMU_ADC_CH_CURRENT
+ * @param pga 		amu_adc_pga_t range
+ * @param save 		save the calibration to EEPROM on the devices that pass the check
+ * @return int8_t 	0 if every device was calibrated and passed the check, -1 otherwise, see results()
+ */
+int8_t AMUCalibration::calibrate(uint8_t channel, uint8_t pga, bool save) {
+	std::vector<float> full_scale;
+	double reference[AMU_CAL_MAX_POINTS];
+	uint8_t pga_data[2] = { channel, pga };
+	uint16_t measure = (uint16_t)((CMD_MEAS_CH_VOLTAGE + channel) | CMD_READ);
+	int8_t status = 0;
+	float range;
+
+	if (devices.empty() || !source.set || ((channel != AMU_ADC_CH_VOLTAGE) && (channel != AMU_ADC_CH_CURRENT)))
+		return -1;
+
+	for (device_t& device : devices) {
+		device.result = 0;
+		device.offset = 0;
+		device.gain = 0;
+		memset(device.sum, 0, sizeof(device.sum));
+	}
+
+	sendAll((channel == AMU_ADC_CH_VOLTAGE) ? CMD_SWEEP_TRIG_VOC : CMD_SWEEP_TRIG_ISC, NULL, 0);
+	waitAll();
+
+	sendAll(CMD_ADC_CH_PGA, pga_data, sizeof(pga_data));
+	waitAll();
+
+	if ((range = readRanges(channel, pga, full_scale)) == 0.0f)
+		status = -1;
+
+	if (status == 0) {
+		sendAll(CMD_ADC_CH_CAL_RESET, &channel, 1);
+		waitAll();
+
+		_cal_delay(source.set(0.0f, source.ctx));
+		sendAll(CMD_ADC_CH_CAL_ZERO_SCALE, &channel, 1);
+		waitAll();
+
+		_cal_delay(source.set(range * AMU_CAL_FULL_SCALE, source.ctx));
+		sendAll(CMD_ADC_CH_CAL_FULL_SCALE, &channel, 1);
+		waitAll();
+
+		readCoefficients(channel);
+	}
+
+	// the check starts where the full-scale calibration left the reference
+	for (uint8_t k = 0; (status == 0) && (k < points); k++) {
+		float value = range * AMU_CAL_FULL_SCALE * (points - 1 - k) / (points - 1);
+
+		if (k > 0) {
+			uint32_t start = _cal_millis();
+			uint32_t settle = source.set(value, source.ctx);
+			uint32_t elapsed;
+
+			readAll(k - 1);
+
+			if ((elapsed = _cal_millis() - start) < settle)
+				_cal_delay(settle - elapsed);
+		}
+
+		reference[k] = source.measure ? source.measure(source.ctx) : value;
+
+		for (uint8_t s = 0; s < samples; s++) {
+			if (s > 0)
+				readAll(k);
+			if (sendAll(measure, NULL, 0) != 0)
+				status = -1;
+			waitAll();
+		}
+	}
+
+	if (status == 0)
+		readAll(points - 1);
+
+	size_t first = cal_results.size();
+
+	for (size_t i = 0; i < devices.size(); i++) {
+		device_t& device = devices[i];
+		amu_cal_result_t result = {};
+		double measured[AMU_CAL_MAX_POINTS];
+
+		result.address = device.address;
+		result.channel = channel;
+		result.pga = pga;
+		result.full_scale = full_scale.empty() ? 0.0f : full_scale[i];
+		result.offset = device.offset;
+		result.gain = device.gain;
+
+		if ((status == 0) && (device.result == 0)) {
+			for (uint8_t k = 0; k < points; k++)
+				measured[k] = device.sum[k] / samples;
+
+			if (!check(reference, measured, points, result.full_scale, tolerance, &result))
+				device.result = AMU_CAL_ERROR_CHECK;
+		}
+
+		cal_results.push_back(result);
+	}
+
+	// only the devices that passed the check are still without errors
+	if (save) {
+		sendAll(CMD_ADC_CH_CAL_SAVE, &channel, 1);
+		waitAll();
+	}
+
+	for (size_t i = 0; i < devices.size(); i++) {
+		cal_results[first + i].result = devices[i].result;
+		if (devices[i].result != 0)
+			status = -1;
+	}
+
+	return status;
+}
+
+/**
+ * @brief Calibrates a span of PGA ranges of one channel, see calibrate()
+ *
+ * @return int8_t 	0 if every range of every device was calibrated
+ */
+int8_t AMUCalibration::calibrateRanges(uint8_t channel, uint8_t first_pga, uint8_t last_pga, bool save) {
+	int8_t status = 0;
+
+	for (uint16_t pga = first_pga; pga <= last_pga; pga++) {
+		if (calibrate(channel, (uint8_t)pga, save) != 0)
+			status = -1;
+	}
+
+	return status;
+}
+
+/**
+ * @brief Runs the DAC calibration of every device at the full scale of the widest voltage range
+ *
+ * @param save 		save the DAC correction to EEPROM
+ * @return int8_t 	0 if every device was calibrated, the values are in dacResults()
+ */
+int8_t AMUCalibration::calibrateDAC(bool save) {
+	std::vector<float> full_scale;
+	uint8_t pga_data[2] = { AMU_ADC_CH_VOLTAGE, 0 };
+	int8_t status = 0;
+	float range;
+
+	dac_results.assign(devices.size(), NAN);
+
+	if (devices.empty() || !source.set)
+		return -1;
+
+	for (device_t& device : devices)
+		device.result = 0;
+
+	sendAll(CMD_SWEEP_TRIG_VOC, NULL, 0);
+	waitAll();
+
+	sendAll(CMD_ADC_CH_PGA, pga_data, sizeof(pga_data));
+	waitAll();
+
+	if ((range = readRanges(AMU_ADC_CH_VOLTAGE, 0, full_scale)) == 0.0f)
+		return -1;
+
+	_cal_delay(source.set(range, source.ctx));
+
+	sendAll(CMD_EXEC_DAC_CAL | CMD_READ, NULL, 0);
+	waitAll();
+
+	for (size_t i = 0; i < devices.size(); i++) {
+		float value;
+
+		if (devices[i].result != 0)
+			continue;
+
+		if ((devices[i].result = amu_dev_transfer(devices[i].address, (uint8_t)AMU_REG_TRANSFER_PTR, (uint8_t*)&value, sizeof(float), AMU_TWI_TRANSFER_READ)) == 0)
+			dac_results[i] = value;
+	}
+
+	if (save) {
+		sendAll(CMD_EXEC_DAC_CAL_SAVE, NULL, 0);
+		waitAll();
+	}
+
+	for (const device_t& device : devices) {
+		if (device.result != 0)
+			status = -1;
+	}
+
+	return status;
+}
+
+#endif /* __AMU_HOST__ */
@@ -0,0 +1,126 @@
+/**
+ * @file amu_calibration.h
+ * @brief Host side ADC and DAC calibration of many devices against one reference source
+ *
+ * Every device in the list is connected to the same reference: in parallel for the voltage channel
+ * and the DAC, in series for the current channel. Each PGA range is calibrated on the devices the
+ * way tools/python/calibration.py does it by hand: the channel calibration is reset to its factory
+ * coefficients with ADC:CH#:CALibrate:RESet, so a new calibration does not build on the last one,
+ * then the ADC runs its own zero-scale calibration with the reference at zero (ADC:CH#:CALibrate:ZERO)
+ * and its full-scale calibration with the reference at AMU_CAL_FULL_SCALE of the range
+ * (ADC:CH#:CALibrate:FULL). The offset and gain registers are set by the ADC itself.
+ *
+ * The new coefficients are then checked: the reference is stepped from AMU_CAL_FULL_SCALE of the
+ * range down to zero and every step is measured by each device (MEAS:ADC) and by the reference. Only
+ * a device whose measurements are all within the tolerance of the reference saves its calibration to
+ * EEPROM, the others keep the saved one on their next reset and are reported in results().
+ *
+ * All devices run each calibration and conversion at the same time, and the measurements of the
+ * previous step are read back while the reference settles on the next one, so a step costs one
+ * settling time and one conversion however many devices there are. Reload
+ * AMU::loadADCCalibration(true) afterwards.
+ *
+ * Timing uses amu_device_t::millis and delay when they are set, so the same code runs against
+ * simulated devices.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_CALIBRATION_H__
+#define __AMU_CALIBRATION_H__
+
+#include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_types.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+#include <vector>
+
+#define AMU_CAL_POINTS				6			// check steps per range, zero and AMU_CAL_FULL_SCALE included
+#define AMU_CAL_MAX_POINTS			16
+#define AMU_CAL_SAMPLES				4			// measurements averaged per check step
+#define AMU_CAL_FULL_SCALE			0.98f		// reference of the full-scale calibration as a fraction of the range
+#define AMU_CAL_TOLERANCE			0.0005f		// largest check error as a fraction of the range
+#define AMU_CAL_TIMEOUT_MS			5000		// longest a device may stay busy with one command
+
+#define AMU_CAL_ERROR_CHECK			(-16)		/*!< Measurements after calibration are not within the tolerance of the reference */
+
+/**
+ * @brief The reference, e.g. a source meter, driven by the caller
+ */
+typedef struct {
+	uint32_t(*set)(float value, void* ctx);			/*!< Sets the output (V or A), returns the settling time in ms */
+	float(*measure)(void* ctx);						/*!< Reads back the settled output, NULL to use the set value */
+	void* ctx;
+} amu_cal_source_t;
+
+/**
+ * @brief Calibration of one channel range of one device
+ */
+typedef struct {
+	uint8_t address;
+	uint8_t channel;			/*!< amu_adc_ch_t */
+	uint8_t pga;				/*!< amu_adc_pga_t */
+	uint8_t points;				/*!< steps checked */
+	int8_t result;				/*!< 0 if calibrated and checked, AMU_CAL_ERROR_CHECK, otherwise the first error of the device */
+	int32_t offset;				/*!< offset register set by the calibration */
+	uint32_t gain;				/*!< gain register set by the calibration */
+	float full_scale;			/*!< range reported by the device (V or A) */
+	float max_error;			/*!< largest difference of the check measurements from the reference as a fraction of full_scale */
+} amu_cal_result_t;
+
+class AMUCalibration {
+
+public:
+
+	explicit AMUCalibration(const amu_cal_source_t& source);
+
+	void			setDevices(const uint8_t* addresses, uint8_t num);
+	uint8_t			addScannedDevices(void);
+	size_t			numDevices(void) const { return devices.size(); }
+
+	void			setPoints(uint8_t points, uint8_t samples = AMU_CAL_SAMPLES);
+	void			setTolerance(float tolerance) { this->tolerance = tolerance; }
+
+	int8_t			calibrate(uint8_t channel, uint8_t pga, bool save);
+	int8_t			calibrateRanges(uint8_t channel, uint8_t first_pga, uint8_t last_pga, bool save);
+	int8_t			calibrateDAC(bool save);
+
+	const std::vector<amu_cal_result_t>&	results(void) const { return cal_results; }
+	const std::vector<float>&				dacResults(void) const { return dac_results; }
+
+	static bool		check(const double* reference, const double* measured, uint8_t points, float full_scale, float tolerance, amu_cal_result_t* result);
+
+private:
+
+	struct device_t {
+		uint8_t address;
+		int8_t result;
+		double sum[AMU_CAL_MAX_POINTS];		/*!< measurements of each step, summed over the samples */
+		int32_t offset;						/*!< offset and gain registers after the calibration */
+		uint32_t gain;
+	};
+
+	amu_cal_source_t		source;
+	std::vector<device_t>	devices;
+	uint8_t					points = AMU_CAL_POINTS;
+	uint8_t					samples = AMU_CAL_SAMPLES;
+	float					tolerance = AMU_CAL_TOLERANCE;
+
+	std::vector<amu_cal_result_t>	cal_results;
+	std::vector<float>				dac_results;
+
+	bool			sendTo(device_t& device, uint16_t command, const void* data, uint8_t len);
+	int8_t			sendAll(uint16_t command, const void* data, uint8_t len);
+	void			waitAll(void);
+	void			readAll(uint8_t point);
+	float			readRanges(uint8_t channel, uint8_t pga, std::vector<float>& full_scale);
+	void			readCoefficients(uint8_t channel);
+};
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_CALIBRATION_H__ */
@@ -0,0 +1,486 @@
+/**
+ * @file amu_diode_fit.cpp
+ * @brief Host side single-diode model fitting of IV sweeps
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_diode_fit.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <math.h>
+#include <string.h>
+#include <unordered_map>
+#include <vector>
+#include "amu_analytics.h"
+#include "amu_thread_pool.h"
+
+#define AMU_DIODE_BOLTZMANN_Q		8.617333262e-5		// k / q (V/K)
+#define AMU_DIODE_PARAMS			5					// iph, ln(i0), n, ln(rs), ln(rsh)
+#define AMU_DIODE_MIN_RS			1e-9
+#define AMU_DIODE_DEFAULT_TEMP		25.0
+
+// bounds of the fitted parameters, keeping poorly determined ones (i.e. Rsh of a good cell) from running away
+#define AMU_DIODE_MIN_N				0.3
+#define AMU_DIODE_MAX_N				10.0
+#define AMU_DIODE_MIN_LN_RS			-13.8				// 1e-6 ohm
+#define AMU_DIODE_MAX_LN_RS			6.9					// 1e3 ohm
+#define AMU_DIODE_MIN_LN_RSH		0.0					// 1 ohm
+#define AMU_DIODE_MAX_LN_RSH		20.7				// 1e9 ohm
+
+/**
+ * @brief W(e^x) for the principal branch, without forming e^x so large arguments do not overflow
+ *
+ * Newton's method on w + ln(w) = x, starting from ln(1 + e^x) or x - ln(x).
+ */
+static double _amu_lambertw_exp(double x) {
+	double w;
+
+	if (x < -30.0)
+		return exp(x);											// W(z) = z to double precision
+
+	w = (x > 1.0) ? (x - log(x)) : log1p(exp(x));
+
+	for (uint8_t k = 0; k < 30; k++) {
+		double step = (w + log(w) - x) * w / (w + 1.0);
+		w -= step;
+		if (fabs(step) <= 1e-15 * w)
+			break;
+	}
+
+	return w;
+}
+
+/**
+ * @brief Thermal voltage kT/q
+ *
+ * @param temperature 	cell temperature in degrees C
+ * @return double 		thermal voltage (V)
+ */
+double amu_diode_thermal_voltage(double temperature) {
+	return AMU_DIODE_BOLTZMANN_Q * (temperature + 273.15);
+}
+
+/**
+ * @brief Current of the single-diode model at a voltage, explicit through the Lambert W function
+ *
+ * The explicit solution loses precision when Rs is very small, so it is polished with one
+ * Newton step on the implicit equation.
+ *
+ * @param params 	model parameters
+ * @param vt 		thermal voltage (V)
+ * @param voltage 	terminal voltage (V)
+ * @return double 	current (A), positive in the generating quadrant
+ */
+double amu_diode_current(const amu_diode_params_t* params, double vt, double voltage) {
+	double nvt = params->n * vt;
+	double rs = (params->rs > AMU_DIODE_MIN_RS) ? params->rs : AMU_DIODE_MIN_RS;
+	double rsh = params->rsh;
+	double sum = rs + rsh;
+	double x = log(rs * params->i0 * rsh / (nvt * sum)) + rsh * (rs * (params->iph + params->i0) + voltage) / (nvt * sum);
+	double i = (rsh * (params->iph + params->i0) - voltage) / sum - (nvt / rs) * _amu_lambertw_exp(x);
+
+	double d = exp(log(params->i0) + (voltage + i * rs) / nvt);
+	double f = params->iph - (d - params->i0) - (voltage + i * rs) / rsh - i;
+	double df = -d * rs / nvt - rs / rsh - 1.0;
+
+	return i - f / df;
+}
+
+static inline double _amu_diode_clamp(double x, double lo, double hi) {
+	return (x < lo) ? lo : ((x > hi) ? hi : x);
+}
+
+static void _amu_diode_to_vector(const amu_diode_params_t* params, double* x) {
+	x[0] = params->iph;
+	x[1] = log(params->i0);
+	x[2] = params->n;
+	x[3] = log((params->rs > AMU_DIODE_MIN_RS) ? params->rs : AMU_DIODE_MIN_RS);
+	x[4] = log(params->rsh);
+}
+
+static void _amu_diode_from_vector(const double* x, amu_diode_params_t* params) {
+	params->iph = x[0];
+	params->i0 = exp(x[1]);
+	params->n = x[2];
+	params->rs = exp(x[3]);
+	params->rsh = exp(x[4]);
+}
+
+/**
+ * @brief Sum of squared residuals and, if jtj is not NULL, the normal equations of the fit
+ *
+ * The derivatives of the current follow from the implicit model F(V, I) = 0 as
+ * dI/dp = -(dF/dp) / (dF/dI), so no finite differences are needed.
+ *
+ * @return double 	sum of squared residuals, NAN if the model could not be evaluated
+ */
+static double _amu_diode_cost(const double* x, double vt, const float* voltage, const float* current, float sign, uint16_t numPoints, double jtj[AMU_DIODE_PARAMS][AMU_DIODE_PARAMS], double* jtr) {
+	amu_diode_params_t p;
+	double cost = 0.0;
+
+	_amu_diode_from_vector(x, &p);
+
+	if (jtj) {
+		memset(jtj, 0, sizeof(double) * AMU_DIODE_PARAMS * AMU_DIODE_PARAMS);
+		memset(jtr, 0, sizeof(double) * AMU_DIODE_PARAMS);
+	}
+
+	for (uint16_t j = 0; j < numPoints; j++) {
+		double v = voltage[j];
+		double i = amu_diode_current(&p, vt, v);
+		double r = i - sign * current[j];
+
+		cost += r * r;
+
+		if (jtj) {
+			double nvt = p.n * vt;
+			double u = v + i * p.rs;
+			double d = exp(x[1] + u / nvt);
+			double dfdi = -d * p.rs / nvt - p.rs / p.rsh - 1.0;
+			double g[AMU_DIODE_PARAMS] = {
+				1.0,										// dF/d iph
+				-(d - p.i0),								// dF/d ln(i0)
+				d * u / (p.n * nvt),						// dF/d n
+				p.rs * (-d * i / nvt - i / p.rsh),			// dF/d ln(rs)
+				u / p.rsh,									// dF/d ln(rsh)
+			};
+
+			for (uint8_t a = 0; a < AMU_DIODE_PARAMS; a++) {
+				g[a] = -g[a] / dfdi;
+				jtr[a] += g[a] * r;
+				for (uint8_t b = 0; b <= a; b++)
+					jtj[a][b] += g[a] * g[b];
+			}
+		}
+	}
+
+	if (jtj) {
+		for (uint8_t a = 0; a < AMU_DIODE_PARAMS; a++)
+			for (uint8_t b = a + 1; b < AMU_DIODE_PARAMS; b++)
+				jtj[a][b] = jtj[b][a];
+	}
+
+	return isfinite(cost) ? cost : NAN;
+}
+
+/**
+ * @brief Solves the 5x5 system a * x = b in place by Gaussian elimination with partial pivoting
+ *
+ * @return true if the system is not singular, the solution is left in b
+ */
+static bool _amu_diode_solve(double a[AMU_DIODE_PARAMS][AMU_DIODE_PARAMS], double* b) {
+	for (uint8_t c = 0; c < AMU_DIODE_PARAMS; c++) {
+		uint8_t pivot = c;
+
+		for (uint8_t r = c + 1; r < AMU_DIODE_PARAMS; r++)
+			if (fabs(a[r][c]) > fabs(a[pivot][c]))
+				pivot = r;
+
+		if (a[pivot][c] == 0.0)
+			return false;
+
+		if (pivot != c) {
+			for (uint8_t k = 0; k < AMU_DIODE_PARAMS; k++) {
+				double t = a[c][k]; a[c][k] = a[pivot][k]; a[pivot][k] = t;
+			}
+			double t = b[c]; b[c] = b[pivot]; b[pivot] = t;
+		}
+
+		for (uint8_t r = c + 1; r < AMU_DIODE_PARAMS; r++) {
+			double f = a[r][c] / a[c][c];
+			for (uint8_t k = c; k < AMU_DIODE_PARAMS; k++)
+				a[r][k] -= f * a[c][k];
+			b[r] -= f * b[c];
+		}
+	}
+
+	for (int8_t r = AMU_DIODE_PARAMS - 1; r >= 0; r--) {
+		for (uint8_t k = r + 1; k < AMU_DIODE_PARAMS; k++)
+			b[r] -= a[r][k] * b[k];
+		b[r] /= a[r][r];
+	}
+
+	return true;
+}
+
+/**
+ * @brief Starting point from the shape of the sweep
+ *
+ * Rsh comes from the slope near short circuit. Past the knee the diode current
+ * Id = Iph - I - V / Rsh satisfies ln(Id) = ln(I0) + V / (n Vt) + I Rs / (n Vt), which is linear
+ * in ln(I0), 1 / (n Vt) and Rs / (n Vt), so I0, n and Rs come from one linear least squares fit.
+ */
+static void _amu_diode_guess(const float* voltage, const float* current, float sign, uint16_t numPoints, double vt, amu_diode_params_t* guess) {
+	ivsweep_meta_t meta;
+
+	amu_iv_analyze(voltage, current, numPoints, NULL, &meta);
+
+	double isc = (meta.isc > 0.0f) ? meta.isc : 1e-3;
+	double voc = (meta.voc > 0.0f) ? meta.voc : 0.5;
+
+	// slope near short circuit over the points below 20% of Voc
+	double sx = 0, sy = 0, sxx = 0, sxy = 0;
+	uint16_t m = 0;
+	for (uint16_t j = 0; j < numPoints; j++) {
+		if (fabsf(voltage[j]) < 0.2 * voc) {
+			double v = voltage[j], i = sign * current[j];
+			sx += v; sy += i; sxx += v * v; sxy += v * i;
+			m++;
+		}
+	}
+	double slope = (m >= 2) ? (m * sxy - sx * sy) / (m * sxx - sx * sx) : 0.0;
+	guess->rsh = (slope < -1e-9) ? -1.0 / slope : 1e5;
+	if (guess->rsh < 10.0) guess->rsh = 10.0;
+	if (guess->rsh > 1e7) guess->rsh = 1e7;
+
+	guess->iph = isc;
+	guess->n = 1.5;
+	guess->rs = 1e-2;
+	guess->i0 = isc * exp(-voc / (guess->n * vt));
+
+	// ln(Id) regressed on [1, V, I] over the points where the diode carries at least 2% of Isc
+	double ata[3][3] = { { 0 } }, atb[3] = { 0 };
+	m = 0;
+	for (uint16_t j = 0; j < numPoints; j++) {
+		double v = voltage[j], i = sign * current[j];
+		double id = guess->iph - i - v / guess->rsh;
+
+		if ((v > 0.0) && (id > 0.02 * isc)) {
+			double row[3] = { 1.0, v, i };
+			double y = log(id);
+			for (uint8_t a = 0; a < 3; a++) {
+				atb[a] += row[a] * y;
+				for (uint8_t b = 0; b < 3; b++)
+					ata[a][b] += row[a] * row[b];
+			}
+			m++;
+		}
+	}
+
+	if (m >= 4) {
+		double det = ata[0][0] * (ata[1][1] * ata[2][2] - ata[1][2] * ata[2][1])
+				   - ata[0][1] * (ata[1][0] * ata[2][2] - ata[1][2] * ata[2][0])
+				   + ata[0][2] * (ata[1][0] * ata[2][1] - ata[1][1] * ata[2][0]);
+
+		if (det != 0.0) {
+			double c0 = (atb[0] * (ata[1][1] * ata[2][2] - ata[1][2] * ata[2][1])
+					   - ata[0][1] * (atb[1] * ata[2][2] - ata[1][2] * atb[2])
+					   + ata[0][2] * (atb[1] * ata[2][1] - ata[1][1] * atb[2])) / det;
+			double c1 = (ata[0][0] * (atb[1] * ata[2][2] - ata[1][2] * atb[2])
+					   - atb[0] * (ata[1][0] * ata[2][2] - ata[1][2] * ata[2][0])
+					   + ata[0][2] * (ata[1][0] * atb[2] - atb[1] * ata[2][0])) / det;
+			double c2 = (ata[0][0] * (ata[1][1] * atb[2] - atb[1] * ata[2][1])
+					   - ata[0][1] * (ata[1][0] * atb[2] - atb[1] * ata[2][0])
+					   + atb[0] * (ata[1][0] * ata[2][1] - ata[1][1] * ata[2][0])) / det;
+			double n = 1.0 / (c1 * vt);
+
+			if ((c1 > 0.0) && (n > 0.5) && (n < 5.0)) {
+				guess->n = n;
+				guess->i0 = exp(c0);
+				guess->rs = (c2 > 0.0) ? (c2 / c1) : 1e-2;
+			}
+		}
+	}
+
+	if (guess->rs < 1e-3) guess->rs = 1e-3;
+	guess->iph = isc * (1.0 + guess->rs / guess->rsh);
+}
+
+/**
+ * @brief Fits the single-diode model to one sweep
+ *
+ * @param voltage 		voltage of each point
+ * @param current 		current of each point, either sign convention
+ * @param numPoints 	number of points in the sweep
+ * @param temperature 	cell temperature in degrees C
+ * @param guess 		starting point, NULL to estimate it from the sweep
+ * @param fit 			fitted parameters and convergence information
+ * @return true if the fit converged
+ */
+bool amu_diode_fit(const float* voltage, const float* current, uint16_t numPoints, double temperature, const amu_diode_params_t* guess, amu_diode_fit_t* fit) {
+	double vt = amu_diode_thermal_voltage(temperature);
+	double x[AMU_DIODE_PARAMS], trial[AMU_DIODE_PARAMS];
+	double jtj[AMU_DIODE_PARAMS][AMU_DIODE_PARAMS], jtr[AMU_DIODE_PARAMS];
+	double lambda = guess ? 1e-6 : 1e-3;
+	double cost;
+	float sign;
+
+	memset(fit, 0, sizeof(amu_diode_fit_t));
+
+	if (numPoints < AMU_DIODE_PARAMS + 1)
+		return false;
+
+	sign = amu_iv_current_sign(voltage, current, numPoints);
+
+	fit->warm_start = (guess != NULL);
+	if (guess)
+		fit->params = *guess;
+	else
+		_amu_diode_guess(voltage, current, sign, numPoints, vt, &fit->params);
+
+	_amu_diode_to_vector(&fit->params, x);
+
+	cost = _amu_diode_cost(x, vt, voltage, current, sign, numPoints, jtj, jtr);
+
+	if (isnan(cost) && guess) {									// warm start no longer fits, start over
+		fit->warm_start = false;
+		_amu_diode_guess(voltage, current, sign, numPoints, vt, &fit->params);
+		_amu_diode_to_vector(&fit->params, x);
+		cost = _amu_diode_cost(x, vt, voltage, current, sign, numPoints, jtj, jtr);
+	}
+
+	while (!isnan(cost) && (fit->iterations < AMU_DIODE_FIT_MAX_ITERATIONS)) {
+		double a[AMU_DIODE_PARAMS][AMU_DIODE_PARAMS], step[AMU_DIODE_PARAMS];
+		double trial_cost;
+		bool small_step = true;
+
+		fit->iterations++;
+
+		double diag_floor = 0.0;
+		for (uint8_t k = 0; k < AMU_DIODE_PARAMS; k++)
+			diag_floor = fmax(diag_floor, 1e-9 * jtj[k][k]);
+
+		memcpy(a, jtj, sizeof(a));
+		for (uint8_t k = 0; k < AMU_DIODE_PARAMS; k++) {
+			a[k][k] += lambda * fmax(jtj[k][k], diag_floor);
+			step[k] = -jtr[k];
+		}
+
+		if (!_amu_diode_solve(a, step)) {
+			lambda *= 10.0;
+			continue;
+		}
+
+		for (uint8_t k = 0; k < AMU_DIODE_PARAMS; k++)
+			trial[k] = x[k] + step[k];
+
+		trial[2] = _amu_diode_clamp(trial[2], AMU_DIODE_MIN_N, AMU_DIODE_MAX_N);
+		trial[3] = _amu_diode_clamp(trial[3], AMU_DIODE_MIN_LN_RS, AMU_DIODE_MAX_LN_RS);
+		trial[4] = _amu_diode_clamp(trial[4], AMU_DIODE_MIN_LN_RSH, AMU_DIODE_MAX_LN_RSH);
+
+		for (uint8_t k = 0; k < AMU_DIODE_PARAMS; k++)
+			if (fabs(trial[k] - x[k]) > 1e-9 * (fabs(x[k]) + 1e-3))
+				small_step = false;
+
+		trial_cost = _amu_diode_cost(trial, vt, voltage, current, sign, numPoints, NULL, NULL);
+
+		if (!isnan(trial_cost) && (trial_cost <= cost)) {
+			bool flat = (cost - trial_cost) <= 1e-8 * cost;
+
+			memcpy(x, trial, sizeof(x));
+			cost = _amu_diode_cost(x, vt, voltage, current, sign, numPoints, jtj, jtr);
+			lambda = (lambda > 1e-12) ? (lambda * 0.1) : lambda;
+
+			if (small_step || flat) {
+				fit->converged = true;
+				break;
+			}
+		}
+		else {
+			lambda *= 10.0;
+			if (lambda > 1e12) {
+				fit->converged = small_step;
+				break;
+			}
+		}
+	}
+
+	_amu_diode_from_vector(x, &fit->params);
+	fit->rmse = isnan(cost) ? NAN : (float)sqrt(cost / numPoints);
+	if (isnan(cost))
+		fit->converged = false;
+
+	return fit->converged;
+}
+
+/**
+ * @brief Fits every sweep of a batch, sweeps of the same DUT in order so each one warm-starts the next
+ *
+ * Each DUT is one task of the thread pool. The temperature of a sweep is the mean of the start
+ * and end sensor temperatures in its meta data, or 25C without meta data.
+ *
+ * @param packets 		sweeps
+ * @param configs 		configuration of each sweep, for numPoints
+ * @param metas 		meta data of each sweep for the temperature, may be NULL
+ * @param dut_ids 		DUT of each sweep, NULL fits every sweep on its own without warm starts
+ * @param count 		number of sweeps
+ * @param fits 			results, one per sweep
+ * @param pool 			thread pool, NULL to use one thread per hardware thread for this batch
+ * @return amu_diode_fit_stats_t convergence statistics of the batch
+ */
+amu_diode_fit_stats_t amu_diode_fit_batch(const ivsweep_packet_t* packets, const ivsweep_config_t* configs, const ivsweep_meta_t* metas, const uint32_t* dut_ids, size_t count, amu_diode_fit_t* fits, AMUThreadPool* pool) {
+	std::vector<std::vector<size_t>> duts;
+	std::unordered_map<uint32_t, size_t> dut_index;
+	amu_diode_fit_stats_t stats;
+
+	memset(&stats, 0, sizeof(stats));
+
+	for (size_t s = 0; s < count; s++) {
+		if (dut_ids) {
+			auto found = dut_index.emplace(dut_ids[s], duts.size());
+			if (found.second)
+				duts.emplace_back();
+			duts[found.first->second].push_back(s);
+		}
+		else
+			duts.push_back(std::vector<size_t>(1, s));
+	}
+
+	std::vector<amu_diode_fit_stats_t> dut_stats(duts.size());
+
+	auto fit_dut = [&](size_t d) {
+		amu_diode_fit_stats_t& st = dut_stats[d];
+		const amu_diode_params_t* previous = NULL;
+
+		memset(&st, 0, sizeof(st));
+
+		for (size_t s : duts[d]) {
+			double temperature = metas ? 0.5 * ((double)metas[s].tsensor_start + metas[s].tsensor_end) : AMU_DIODE_DEFAULT_TEMP;
+			amu_diode_fit_t& fit = fits[s];
+
+			amu_diode_fit(packets[s].voltage, packets[s].current, configs[s].numPoints, temperature, previous, &fit);
+
+			st.fits++;
+			st.iterations += fit.iterations;
+			if (fit.iterations > st.max_iterations)
+				st.max_iterations = fit.iterations;
+			if (fit.warm_start) {
+				st.warm_starts++;
+				st.warm_iterations += fit.iterations;
+			}
+			if (fit.converged) {
+				st.converged++;
+				if (fit.rmse > st.max_rmse)
+					st.max_rmse = fit.rmse;
+			}
+
+			previous = fit.converged ? &fit.params : NULL;
+		}
+	};
+
+	if (pool)
+		pool->parallel_for(duts.size(), fit_dut);
+	else {
+		AMUThreadPool local_pool;
+		local_pool.parallel_for(duts.size(), fit_dut);
+	}
+
+	for (const amu_diode_fit_stats_t& st : dut_stats) {
+		stats.fits += st.fits;
+		stats.converged += st.converged;
+		stats.warm_starts += st.warm_starts;
+		stats.iterations += st.iterations;
+		stats.warm_iterations += st.warm_iterations;
+		if (st.max_iterations > stats.max_iterations)
+			stats.max_iterations = st.max_iterations;
+		if (st.max_rmse > stats.max_rmse)
+			stats.max_rmse = st.max_rmse;
+	}
+
+	return stats;
+}
+
+#endif /* __AMU_HOST__ */
@@ -0,0 +1,68 @@
+/**
+ * @file amu_diode_fit.h
+ * @brief Host side single-diode model fitting of IV sweeps
+ *
+ * Fits I = Iph - I0 (exp((V + I Rs) / (n Vt)) - 1) - (V + I Rs) / Rsh to a sweep with
+ * Levenberg-Marquardt, evaluating the current explicitly through the Lambert W function. A fit can
+ * be warm-started from the previous sweep of the same DUT, which typically converges in a few
+ * iterations when the cell degrades slowly between sweeps. Batches of DUTs are spread across an
+ * AMUThreadPool.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_DIODE_FIT_H__
+#define __AMU_DIODE_FIT_H__
+
+#include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_types.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+
+#define AMU_DIODE_FIT_MAX_ITERATIONS	100
+
+class AMUThreadPool;
+
+/**
+ * @brief Single-diode model parameters, currents positive in the generating quadrant
+ */
+typedef struct {
+	double iph;				/*!< photocurrent (A) */
+	double i0;				/*!< diode saturation current (A) */
+	double n;				/*!< ideality factor */
+	double rs;				/*!< series resistance (ohm) */
+	double rsh;				/*!< shunt resistance (ohm) */
+} amu_diode_params_t;
+
+typedef struct {
+	amu_diode_params_t params;
+	float rmse;				/*!< root mean square current residual (A) */
+	uint16_t iterations;	/*!< Levenberg-Marquardt iterations used */
+	bool converged;			/*!< false if the fit ran out of iterations or the sweep had too few points */
+	bool warm_start;		/*!< started from the previous sweep of the same DUT */
+} amu_diode_fit_t;
+
+typedef struct {
+	uint32_t fits;				/*!< sweeps fitted */
+	uint32_t converged;			/*!< fits that converged */
+	uint32_t warm_starts;		/*!< fits started from the previous sweep of the DUT */
+	uint32_t iterations;		/*!< total iterations over all fits */
+	uint32_t warm_iterations;	/*!< iterations of the warm-started fits */
+	uint16_t max_iterations;	/*!< iterations of the slowest fit */
+	float max_rmse;				/*!< largest rmse of a converged fit (A) */
+} amu_diode_fit_stats_t;
+
+double			amu_diode_current(const amu_diode_params_t* params, double vt, double voltage);
+double			amu_diode_thermal_voltage(double temperature);
+
+bool			amu_diode_fit(const float* voltage, const float* current, uint16_t numPoints, double temperature, const amu_diode_params_t* guess, amu_diode_fit_t* fit);
+
+amu_diode_fit_stats_t	amu_diode_fit_batch(const ivsweep_packet_t* packets, const ivsweep_config_t* configs, const ivsweep_meta_t* metas, const uint32_t* dut_ids, size_t count, amu_diode_fit_t* fits, AMUThreadPool* pool);
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_DIODE_FIT_H__ */
@@ -0,0 +1,196 @@
+/**
+ * @file amu_stats.cpp
+ * @brief Streaming per-point statistics of repeated sweeps and measurements
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_stats.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <math.h>
+#include <float.h>
+
+/**
+ * @brief Clears the accumulator and sizes it for a number of points
+ */
+void AMURunningStats::reset(size_t points) {
+	n = 0;
+	means.assign(points, 0.0);
+	m2.assign(points, 0.0);
+	mins.assign(points, FLT_MAX);
+	maxs.assign(points, -FLT_MAX);
+}
+
+/**
+ * @brief Folds one sample of every point into the statistics
+ *
+ * @param values 	points() values
+ */
+void AMURunningStats::add(const float* values) {
+	const size_t count = means.size();
+	double* mean = means.data();
+	double* sq = m2.data();
+	float* lo = mins.data();
+	float* hi = maxs.data();
+	double inv;
+
+	n++;
+	inv = 1.0 / (double)n;
+
+	// Welford's update, one branch free pass over the points so it vectorizes
+	for (size_t j = 0; j < count; j++) {
+		double x = values[j];
+		double d = x - mean[j];
+		mean[j] += d * inv;
+		sq[j] += d * (x - mean[j]);
+	}
+
+	for (size_t j = 0; j < count; j++) {
+		lo[j] = (values[j] < lo[j]) ? values[j] : lo[j];
+		hi[j] = (values[j] > hi[j]) ? values[j] : hi[j];
+	}
+}
+
+/**
+ * @brief Adds the samples of another accumulator of the same points, as if they had been added here
+ *
+ * Uses the pairwise update of Chan et al., so accumulators filled by separate threads can be combined.
+ * An accumulator with a different number of points is ignored.
+ */
+void AMURunningStats::merge(const AMURunningStats& other) {
+	if ((other.n == 0) || (other.points() != points()))
+		return;
+
+	if (n == 0) {
+		*this = other;
+		return;
+	}
+
+	const double na = (double)n, nb = (double)other.n, nab = na + nb;
+
+	for (size_t j = 0; j < means.size(); j++) {
+		double d = other.means[j] - means[j];
+		means[j] += d * nb / nab;
+		m2[j] += other.m2[j] + d * d * na * nb / nab;
+		mins[j] = (other.mins[j] < mins[j]) ? other.mins[j] : mins[j];
+		maxs[j] = (other.maxs[j] > maxs[j]) ? other.maxs[j] : maxs[j];
+	}
+
+	n += other.n;
+}
+
+/**
+ * @brief Variance of a point
+ *
+ * @param point 	point index
+ * @param sample 	true for the sample variance (divided by count() - 1), false for the population variance as numpy.var()
+ * @return double 	0 with too few samples
+ */
+double AMURunningStats::variance(size_t point, bool sample) const {
+	uint64_t d = sample ? n - 1 : n;
+
+	if ((n == 0) || (d == 0))
+		return 0.0;
+
+	return m2[point] / (double)d;
+}
+
+double AMURunningStats::stddev(size_t point, bool sample) const {
+	return sqrt(variance(point, sample));
+}
+
+/**
+ * @brief Standard deviation of every point
+ *
+ * @param out 		room for points() values
+ * @param sample 	true for the sample standard deviation, false for the population standard deviation
+ * @return double* 	out
+ */
+double* AMURunningStats::stddevs(double* out, bool sample) const {
+	for (size_t j = 0; j < means.size(); j++)
+		out[j] = stddev(j, sample);
+	return out;
+}
+
+/**
+ * @brief Clears the statistics, numPoints of 0 takes the number of points from the first sweep added
+ */
+void AMUSweepStats::reset(uint16_t numPoints) {
+	voltage_stats.reset(numPoints);
+	current_stats.reset(numPoints);
+	meta_stats.reset(AMU_STATS_META_FIELDS);
+}
+
+/**
+ * @brief Adds the voltages and currents of one sweep, and its figures of merit
+ *
+ * @param packet 		sweep
+ * @param numPoints 	points in the sweep, at most IVSWEEP_MAX_POINTS
+ * @param meta 			figures of merit of the sweep, i.e. from amu_iv_analyze(), NULL to leave meta() unchanged
+ * @return bool 		false if the sweep has a different number of points than the sweeps before it
+ */
+bool AMUSweepStats::add(const ivsweep_packet_t* packet, uint16_t numPoints, const ivsweep_meta_t* meta) {
+	if (numPoints > IVSWEEP_MAX_POINTS)
+		return false;
+
+	return add(packet->voltage, packet->current, numPoints, meta);
+}
+
+/**
+ * @brief Adds the voltages and currents of one sweep of any length, and its figures of merit
+ */
+bool AMUSweepStats::add(const float* voltage, const float* current, uint16_t numPoints, const ivsweep_meta_t* meta) {
+	if ((numPoints == 0) || ((points() != 0) && (numPoints != points())))
+		return false;
+
+	if (points() == 0)
+		reset(numPoints);
+
+	voltage_stats.add(voltage);
+	current_stats.add(current);
+
+	if (meta)
+		meta_stats.add(&meta->voc);			// the AMU_STATS_META_FIELDS floats lead ivsweep_meta_t
+
+	return true;
+}
+
+/**
+ * @brief Adds the sweeps of another accumulator of the same number of points
+ */
+void AMUSweepStats::merge(const AMUSweepStats& other) {
+	if (points() == 0)
+		reset(other.points());
+
+	voltage_stats.merge(other.voltage_stats);
+	current_stats.merge(other.current_stats);
+	meta_stats.merge(other.meta_stats);
+}
+
+void AMUMeasStats::add(const amu_meas_t& meas) {
+	meas_stats.add(&meas.measurement);		// measurement and temperature are the two floats of amu_meas_t
+}
+
+void AMUMeasStats::add(const amu_meas_t* meas, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		add(meas[i]);
+}
+
+/**
+ * @brief Adds the measurements of one channel from entries read by AMU::readHistory()
+ *
+ * @param entries 		history entries
+ * @param count 		number of entries
+ * @param channel 		amu_adc_ch_t channel, entries of other channels are skipped
+ */
+void AMUMeasStats::add(const amu_history_entry_t* entries, size_t count, uint8_t channel) {
+	for (size_t i = 0; i < count; i++) {
+		if (entries[i].channel == channel)
+			add(entries[i].meas);
+	}
+}
+
+#endif
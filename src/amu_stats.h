@@ -0,0 +1,142 @@
+/**
+ * @file amu_stats.h
+ * @brief Streaming per-point statistics of repeated sweeps and measurements
+ *
+ * AMURunningStats keeps the mean, variance, minimum and maximum of a fixed number of points with
+ * Welford's update, so each sample is folded in as it arrives and memory does not grow with the
+ * number of samples. The state of every point is kept in its own array and one sample updates all
+ * points in a single branch free loop, which the compiler vectorizes across points. Means and sums
+ * of squares are kept in double, so millions of samples of a 24-bit reading lose no precision.
+ * Two accumulators can be merged, i.e. one per thread or device.
+ *
+ * AMUSweepStats accumulates the voltage and current of every point of repeated IV sweeps together
+ * with their figures of merit, and AMUMeasStats a stream of amu_meas_t, for noise and repeatability
+ * characterisation while the data is being acquired. Medians need every sample and are not kept.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_STATS_H__
+#define __AMU_STATS_H__
+
+#include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_types.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+#include <vector>
+
+/**
+ * @brief Points of AMUSweepStats::meta(), the float fields of ivsweep_meta_t in order
+ */
+typedef enum {
+	AMU_STATS_META_VOC = 0,
+	AMU_STATS_META_ISC,
+	AMU_STATS_META_TSENSOR_START,
+	AMU_STATS_META_TSENSOR_END,
+	AMU_STATS_META_FF,
+	AMU_STATS_META_EFF,
+	AMU_STATS_META_VMAX,
+	AMU_STATS_META_IMAX,
+	AMU_STATS_META_PMAX,
+	AMU_STATS_META_ADC,
+	AMU_STATS_META_FIELDS,
+} amu_stats_meta_t;
+
+/**
+ * @brief Points of AMUMeasStats::stats()
+ */
+typedef enum {
+	AMU_STATS_MEAS_MEASUREMENT = 0,
+	AMU_STATS_MEAS_TEMPERATURE,
+	AMU_STATS_MEAS_FIELDS,
+} amu_stats_meas_t;
+
+class AMURunningStats {
+
+public:
+
+	AMURunningStats() {}
+	explicit AMURunningStats(size_t points) { reset(points); }
+
+	void			reset(size_t points);
+	void			reset(void) { reset(means.size()); }
+
+	void			add(const float* values);
+	void			merge(const AMURunningStats& other);
+
+	uint64_t		count(void) const { return n; }
+	size_t			points(void) const { return means.size(); }
+
+	const double*	mean(void) const { return means.data(); }
+	const float*	min(void) const { return mins.data(); }
+	const float*	max(void) const { return maxs.data(); }
+
+	double			mean(size_t point) const { return means[point]; }
+	float			min(size_t point) const { return mins[point]; }
+	float			max(size_t point) const { return maxs[point]; }
+	double			variance(size_t point, bool sample = true) const;
+	double			stddev(size_t point, bool sample = true) const;
+	double*			stddevs(double* out, bool sample = true) const;
+
+protected:
+
+	uint64_t n = 0;
+	std::vector<double> means;
+	std::vector<double> m2;			// sum of squared differences from the mean
+	std::vector<float> mins;
+	std::vector<float> maxs;
+};
+
+class AMUSweepStats {
+
+public:
+
+	AMUSweepStats() {}
+	explicit AMUSweepStats(uint16_t numPoints) { reset(numPoints); }
+
+	void			reset(uint16_t numPoints = 0);
+
+	bool			add(const ivsweep_packet_t* packet, uint16_t numPoints, const ivsweep_meta_t* meta = NULL);
+	bool			add(const float* voltage, const float* current, uint16_t numPoints, const ivsweep_meta_t* meta = NULL);
+	void			merge(const AMUSweepStats& other);
+
+	uint64_t		sweeps(void) const { return voltage_stats.count(); }
+	uint16_t		points(void) const { return (uint16_t)voltage_stats.points(); }
+
+	const AMURunningStats&	voltage(void) const { return voltage_stats; }
+	const AMURunningStats&	current(void) const { return current_stats; }
+	const AMURunningStats&	meta(void) const { return meta_stats; }		// amu_stats_meta_t points, only sweeps added with meta
+
+protected:
+
+	AMURunningStats voltage_stats;
+	AMURunningStats current_stats;
+	AMURunningStats meta_stats = AMURunningStats(AMU_STATS_META_FIELDS);
+};
+
+class AMUMeasStats {
+
+public:
+
+	void			reset(void) { meas_stats.reset(); }
+
+	void			add(const amu_meas_t& meas);
+	void			add(const amu_meas_t* meas, size_t count);
+	void			add(const amu_history_entry_t* entries, size_t count, uint8_t channel);
+
+	uint64_t		count(void) const { return meas_stats.count(); }
+
+	const AMURunningStats&	stats(void) const { return meas_stats; }		// amu_stats_meas_t points
+
+protected:
+
+	AMURunningStats meas_stats = AMURunningStats(AMU_STATS_MEAS_FIELDS);
+};
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_STATS_H__ */
@@ -0,0 +1,142 @@
+/**
+ * @file amu_thread_pool.cpp
+ * @brief Work stealing thread pool for the host post-processing modules
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_thread_pool.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+/**
+ * @brief Starts the worker threads, the thread calling parallel_for() is the last one
+ *
+ * @param threads 	number of threads including the caller, 0 for one per hardware thread
+ */
+AMUThreadPool::AMUThreadPool(unsigned threads) {
+
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	if (threads == 0)
+		threads = 1;
+
+	for (unsigned t = 0; t < threads; t++)
+		queues.emplace_back(new task_queue_t);
+
+	for (unsigned t = 1; t < threads; t++)
+		workers.emplace_back(&AMUThreadPool::worker_loop, this, t);
+}
+
+AMUThreadPool::~AMUThreadPool() {
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& t : workers)
+		t.join();
+}
+
+/**
+ * @brief Runs task(0) ... task(count - 1) across the pool and returns when all of them are done
+ *
+ * Tasks are dealt out in contiguous blocks, one block per thread, and rebalanced by stealing.
+ * Not reentrant, tasks must not call parallel_for() on the same pool.
+ *
+ * @param count 	number of tasks
+ * @param task 		called once with each task index
+ */
+void AMUThreadPool::parallel_for(size_t count, const std::function<void(size_t)>& task) {
+
+	if (count == 0)
+		return;
+
+	size_t per_queue = (count + queues.size() - 1) / queues.size();
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+
+		job.store(&task, std::memory_order_release);			// before the tasks are queued, so whoever takes a task sees its job
+		pending.store(count, std::memory_order_relaxed);
+
+		for (size_t q = 0; q < queues.size(); q++) {
+			std::lock_guard<std::mutex> queue_guard(queues[q]->lock);
+			for (size_t i = q * per_queue; (i < (q + 1) * per_queue) && (i < count); i++)
+				queues[q]->tasks.push_back(i);
+		}
+
+		generation++;
+	}
+	wake.notify_all();
+
+	run_tasks(0);
+
+	std::unique_lock<std::mutex> guard(lock);
+	done.wait(guard, [this] { return pending.load(std::memory_order_acquire) == 0; });
+	job.store(nullptr, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Takes the next task, newest first from the thread's own queue, otherwise oldest first from another queue
+ *
+ * @param self 		index of the calling thread
+ * @param task 		task index taken
+ * @return true if a task was taken, false once every queue is empty
+ */
+bool AMUThreadPool::next_task(unsigned self, size_t* task) {
+	{
+		std::lock_guard<std::mutex> guard(queues[self]->lock);
+		if (!queues[self]->tasks.empty()) {
+			*task = queues[self]->tasks.back();
+			queues[self]->tasks.pop_back();
+			return true;
+		}
+	}
+
+	for (size_t n = 1; n < queues.size(); n++) {
+		task_queue_t& victim = *queues[(self + n) % queues.size()];
+		std::lock_guard<std::mutex> guard(victim.lock);
+		if (!victim.tasks.empty()) {
+			*task = victim.tasks.front();
+			victim.tasks.pop_front();
+			steal_count.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void AMUThreadPool::run_tasks(unsigned self) {
+	size_t index;
+
+	while (next_task(self, &index)) {
+		(*job.load(std::memory_order_acquire))(index);
+
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			std::lock_guard<std::mutex> guard(lock);		// the caller checks pending under the lock, so the notify is not lost
+			done.notify_all();
+		}
+	}
+}
+
+void AMUThreadPool::worker_loop(unsigned self) {
+	uint64_t seen = 0;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> guard(lock);
+			wake.wait(guard, [&] { return stopping || (generation != seen); });
+			if (stopping)
+				return;
+			seen = generation;
+		}
+
+		run_tasks(self);
+	}
+}
+
+#endif /* __AMU_HOST__ */
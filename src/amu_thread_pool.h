@@ -0,0 +1,75 @@
+/**
+ * @file amu_thread_pool.h
+ * @brief Work stealing thread pool for the host post-processing modules
+ *
+ * Each thread owns a queue of task indices. A thread takes tasks from the back of its own queue
+ * and, once that is empty, steals from the front of the other queues, so batches of uneven tasks
+ * (i.e. DUTs with different numbers of sweeps) still keep every thread busy until the end.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_THREAD_POOL_H__
+#define __AMU_THREAD_POOL_H__
+
+#include "amulibc/amu_config_internal.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class AMUThreadPool {
+
+public:
+
+	explicit AMUThreadPool(unsigned threads = 0);
+	~AMUThreadPool();
+
+	AMUThreadPool(const AMUThreadPool&) = delete;
+	AMUThreadPool& operator=(const AMUThreadPool&) = delete;
+
+	void			parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+	unsigned		size(void) const { return (unsigned)queues.size(); }
+	uint64_t		steals(void) const { return steal_count.load(std::memory_order_relaxed); }
+
+protected:
+
+	struct task_queue_t {
+		std::mutex lock;
+		std::deque<size_t> tasks;
+	};
+
+	std::vector<std::unique_ptr<task_queue_t>> queues;		// queue 0 belongs to the thread calling parallel_for
+	std::vector<std::thread> workers;
+
+	std::mutex lock;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	std::atomic<const std::function<void(size_t)>*> job{nullptr};
+	uint64_t generation = 0;
+	bool stopping = false;
+
+	std::atomic<size_t> pending{0};
+	std::atomic<uint64_t> steal_count{0};
+
+	bool			next_task(unsigned self, size_t* task);
+	void			run_tasks(unsigned self);
+	void			worker_loop(unsigned self);
+};
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_THREAD_POOL_H__ */
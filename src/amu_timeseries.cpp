@@ -0,0 +1,709 @@
+/**
+ * @file amu_timeseries.cpp
+ * @brief Compressed columnar time series store for long logging runs such as TVAC tests
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_timeseries.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#include "amulibc/amu_crc.h"
+
+static inline uint8_t _clz32(uint32_t x) {
+#if defined(__GNUC__)
+	return (uint8_t)__builtin_clz(x);
+#else
+	uint8_t n = 0;
+	while (!(x & 0x80000000UL)) { x <<= 1; n++; }
+	return n;
+#endif
+}
+
+static inline uint8_t _ctz32(uint32_t x) {
+#if defined(__GNUC__)
+	return (uint8_t)__builtin_ctz(x);
+#else
+	uint8_t n = 0;
+	while (!(x & 1)) { x >>= 1; n++; }
+	return n;
+#endif
+}
+
+static inline uint32_t _float_bits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static inline float _bits_float(uint32_t bits) {
+	float value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static const double _pow10[AMU_TS_MAX_DECIMALS + 1] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+/**
+ * @brief Scaled integer of a value with a number of decimals
+ *
+ * @param value 		reading
+ * @param decimals 		decimals, at most AMU_TS_MAX_DECIMALS
+ * @param code 			receives round(value * 10^decimals), left unchanged if the value does not decode exactly
+ * @return true if value is the float nearest to code / 10^decimals, as a reading parsed from text is
+ */
+static inline bool _decimal_code(float value, uint8_t decimals, int64_t* code) {
+	double scaled = (double)value * _pow10[decimals];
+	int64_t n;
+
+	if (!(fabs(scaled) < 4.5e15))
+		return false;
+
+	n = llround(scaled);
+	if (_float_bits((float)((double)n / _pow10[decimals])) != _float_bits(value))
+		return false;
+
+	*code = n;
+	return true;
+}
+
+/**
+ * @brief Decimal coding of a chunk, the fewest decimals that most values decode exactly with
+ *
+ * @return uint8_t 		decimals, or AMU_TS_CODING_XOR if fewer than half of the values decode exactly
+ */
+static uint8_t _chunk_coding(const std::vector<float>& values) {
+	size_t count = values.size();
+	size_t best_exact = count / 2;
+	uint8_t best = AMU_TS_CODING_XOR;
+	int64_t code;
+
+	for (uint8_t decimals = 0; decimals <= AMU_TS_MAX_DECIMALS; decimals++) {
+		size_t exact = 0, missed = 0;
+
+		for (size_t i = 0; (i < count) && (missed < count - best_exact); i++) {
+			if (_decimal_code(values[i], decimals, &code))
+				exact++;
+			else
+				missed++;
+		}
+
+		if (exact > best_exact) {
+			best_exact = exact;
+			best = decimals;
+		}
+
+		if (exact == count)
+			break;
+	}
+
+	return best;
+}
+
+/**
+ * @brief Bit stream writer, most significant bit first
+ */
+struct _bit_writer {
+	std::vector<uint8_t>& out;
+	uint64_t acc;
+	uint8_t acc_bits;
+
+	// appends the low nbits (at most 32) of value
+	void put(uint64_t value, uint8_t nbits) {
+		acc = (acc << nbits) | (value & ((1ULL << nbits) - 1));
+		acc_bits += nbits;
+
+		while (acc_bits >= 8) {
+			acc_bits -= 8;
+			out.push_back((uint8_t)(acc >> acc_bits));
+		}
+	}
+
+	void finish(void) {
+		if (acc_bits)
+			out.push_back((uint8_t)(acc << (8 - acc_bits)));
+		acc_bits = 0;
+	}
+};
+
+/**
+ * @brief Bit stream reader, reads past the end return zeros
+ */
+struct _bit_reader {
+	const uint8_t* data;
+	size_t length;
+	size_t pos;
+
+	uint64_t get(uint8_t nbits) {
+		uint64_t value = 0;
+
+		while (nbits) {
+			size_t byte = pos >> 3;
+			uint8_t avail = 8 - (pos & 7);
+			uint8_t take = (nbits < avail) ? nbits : avail;
+			uint8_t b = (byte < length) ? data[byte] : 0;
+
+			value = (value << take) | ((b >> (avail - take)) & ((1U << take) - 1));
+			pos += take;
+			nbits -= take;
+		}
+
+		return value;
+	}
+};
+
+/**
+ * @brief Codes the change of the interval between two timestamps
+ */
+static inline void _put_dod(_bit_writer& out, int64_t dod) {
+	if (dod == 0)
+		out.put(0x0, 1);
+	else if ((dod >= -15) && (dod <= 16)) {
+		out.put(0x2, 2);
+		out.put((uint64_t)(dod + 15), 5);
+	}
+	else if ((dod >= -255) && (dod <= 256)) {
+		out.put(0x6, 3);
+		out.put((uint64_t)(dod + 255), 9);
+	}
+	else if ((dod >= -2047) && (dod <= 2048)) {
+		out.put(0xE, 4);
+		out.put((uint64_t)(dod + 2047), 12);
+	}
+	else {
+		out.put(0xF, 4);
+		out.put((uint64_t)dod >> 32, 32);
+		out.put((uint64_t)dod, 32);
+	}
+}
+
+static inline int64_t _get_dod(_bit_reader& in) {
+	if (!in.get(1))
+		return 0;
+	if (!in.get(1))
+		return (int64_t)in.get(5) - 15;
+	if (!in.get(1))
+		return (int64_t)in.get(9) - 255;
+	if (!in.get(1))
+		return (int64_t)in.get(12) - 2047;
+	return (int64_t)in.get(64);
+}
+
+/**
+ * @brief Codes a value XOR'd with the previous one, only the bits that differ
+ */
+static inline void _put_xor(_bit_writer& out, uint32_t x, uint8_t& leading, uint8_t& trailing) {
+	if (x == 0) {
+		out.put(0x0, 1);
+		return;
+	}
+
+	uint8_t lz = _clz32(x);
+	uint8_t tz = _ctz32(x);
+
+	if ((leading != 0xFF) && (lz >= leading) && (tz >= trailing)) {
+		out.put(0x2, 2);
+		out.put(x >> trailing, 32 - leading - trailing);
+	}
+	else {
+		uint8_t meaningful = 32 - lz - tz;
+		out.put(0x3, 2);
+		out.put(lz, 5);
+		out.put(meaningful - 1, 5);
+		out.put(x >> tz, meaningful);
+		leading = lz;
+		trailing = tz;
+	}
+}
+
+/**
+ * @brief Codes a value as the change of its scaled integer, or as the float itself if it does not decode exactly
+ */
+static inline void _put_decimal(_bit_writer& out, float value, uint8_t decimals, int64_t& code) {
+	int64_t n, d;
+
+	if (!_decimal_code(value, decimals, &n) || ((d = n - code) < INT32_MIN) || (d > INT32_MAX)) {
+		out.put(0x1F, 5);
+		out.put(_float_bits(value), 32);
+		return;
+	}
+
+	if (d == 0)
+		out.put(0x0, 1);
+	else if ((d >= -8) && (d <= 7)) {
+		out.put(0x2, 2);
+		out.put((uint64_t)(d + 8), 4);
+	}
+	else if ((d >= -128) && (d <= 127)) {
+		out.put(0x6, 3);
+		out.put((uint64_t)(d + 128), 8);
+	}
+	else if ((d >= -32768) && (d <= 32767)) {
+		out.put(0xE, 4);
+		out.put((uint64_t)(d + 32768), 16);
+	}
+	else {
+		out.put(0x1E, 5);
+		out.put((uint64_t)d, 32);
+	}
+
+	code = n;
+}
+
+/**
+ * @brief Opens a store for appending, creating it if it does not exist
+ *
+ * Points of a column must be appended in timestamp order, also across sessions on the same file.
+ * A chunk left incomplete by a crash at the end of the file is cut off first. A store with a
+ * malformed chunk before its end is left untouched, cutting it there would discard the chunks after it.
+ *
+ * @param path 			store file
+ * @param chunk_points 	points per chunk, larger chunks compress slightly better but make queries decode more
+ * @return false if the file exists but is not a store, has a malformed chunk before its end, or cannot be written
+ */
+bool AMUTimeSeriesWriter::open(const char* path, uint16_t chunk_points) {
+	std::error_code ec;
+	uintmax_t size = std::filesystem::file_size(path, ec);
+
+	close();
+	this->chunk_points = (chunk_points == 0) ? 1 : chunk_points;
+	total_points = 0;
+
+	if (!ec && (size > 0)) {
+		AMUTimeSeries existing;
+
+		if (!existing.open(path) || (existing.truncated() && !existing.tornTail()))
+			return false;
+
+		for (uint16_t column : existing.columns()) {
+			column_t& state = columns[column];
+			int64_t first;
+			existing.timeRange(column, &first, &state.last);
+			state.started = true;
+		}
+
+		uint64_t valid = existing.validLength();
+		bool truncated = existing.truncated();
+		existing.close();
+
+		if (truncated) {
+			std::filesystem::resize_file(path, valid, ec);
+			if (ec)
+				return false;
+		}
+
+		file = fopen(path, "ab");
+		return (file != NULL);
+	}
+
+	file = fopen(path, "wb");
+	if (!file)
+		return false;
+
+	amu_ts_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, AMU_TS_MAGIC, sizeof(header.magic));
+	header.version = AMU_TS_VERSION;
+	header.header_size = sizeof(amu_ts_header_t);
+	header.chunk_size = sizeof(amu_ts_chunk_t);
+
+	if (fwrite(&header, sizeof(header), 1, file) != 1) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Appends one point to a column
+ *
+ * @param column 		AMU_TS_COLUMN() of the device channel
+ * @param timestamp 	in any integer unit, e.g. milliseconds since the epoch
+ * @param value 		reading
+ * @return false if the timestamp is older than the last one of the column, or on a write error
+ */
+bool AMUTimeSeriesWriter::append(uint16_t column, int64_t timestamp, float value) {
+	column_t& c = columns[column];
+
+	if (!file || (c.started && (timestamp < c.last)))
+		return false;
+
+	c.timestamps.push_back(timestamp);
+	c.values.push_back(value);
+	c.last = timestamp;
+	c.started = true;
+	total_points++;
+
+	if (c.timestamps.size() >= chunk_points)
+		return writeChunk(column, c);
+
+	return true;
+}
+
+/**
+ * @brief Appends a block of points to a column
+ *
+ * @param column 		AMU_TS_COLUMN() of the device channel
+ * @param timestamps 	count timestamps in increasing order
+ * @param values 		count readings
+ * @param count 		number of points
+ * @return false at the first point that could not be appended
+ */
+bool AMUTimeSeriesWriter::append(uint16_t column, const int64_t* timestamps, const float* values, size_t count) {
+	for (size_t i = 0; i < count; i++) {
+		if (!append(column, timestamps[i], values[i]))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Codes the points of a chunk
+ *
+ * The payload starts with the value coding byte, followed by the first value as a float and then
+ * for every further point its timestamp and value codes.
+ *
+ * @param payload 		receives the payload
+ * @param timestamps 	timestamps of the points
+ * @param values 		values of the points
+ * @param coding 		decimals, or AMU_TS_CODING_XOR
+ */
+static void _encode_chunk(std::vector<uint8_t>& payload, const std::vector<int64_t>& timestamps, const std::vector<float>& values, uint8_t coding) {
+	_bit_writer out = { payload, 0, 0 };
+	uint8_t leading = 0xFF, trailing = 0;
+	int64_t delta = 0, code = 0;
+
+	payload.clear();
+	out.put(coding, 8);
+	out.put(_float_bits(values[0]), 32);
+	if (coding != AMU_TS_CODING_XOR)
+		_decimal_code(values[0], coding, &code);
+
+	for (size_t i = 1; i < timestamps.size(); i++) {
+		int64_t interval = (int64_t)((uint64_t)timestamps[i] - (uint64_t)timestamps[i - 1]);
+
+		_put_dod(out, (int64_t)((uint64_t)interval - (uint64_t)delta));
+		delta = interval;
+
+		if (coding == AMU_TS_CODING_XOR)
+			_put_xor(out, _float_bits(values[i]) ^ _float_bits(values[i - 1]), leading, trailing);
+		else
+			_put_decimal(out, values[i], coding, code);
+	}
+
+	out.finish();
+}
+
+/**
+ * @brief Codes and writes the open chunk of a column, with whichever value coding is shorter
+ */
+bool AMUTimeSeriesWriter::writeChunk(uint16_t column, column_t& state) {
+	amu_ts_chunk_t header;
+	uint8_t coding = _chunk_coding(state.values);
+	bool ok;
+
+	_encode_chunk(payload, state.timestamps, state.values, AMU_TS_CODING_XOR);
+
+	if (coding != AMU_TS_CODING_XOR) {
+		_encode_chunk(scratch, state.timestamps, state.values, coding);
+		if (scratch.size() < payload.size())
+			payload.swap(scratch);
+	}
+
+	header.magic = AMU_TS_CHUNK_MAGIC;
+	header.column = column;
+	header.count = (uint16_t)state.timestamps.size();
+	header.length = (uint32_t)payload.size();
+	header.crc = amu_crc32(payload.data(), payload.size());
+	header.first = state.timestamps.front();
+	header.last = state.timestamps.back();
+
+	ok = (fwrite(&header, sizeof(header), 1, file) == 1) &&
+		(fwrite(payload.data(), 1, payload.size(), file) == payload.size());
+
+	state.timestamps.clear();
+	state.values.clear();
+
+	return ok;
+}
+
+/**
+ * @brief Writes the open chunks of all columns, short chunks compress a little worse
+ *
+ * @return false on a write error
+ */
+bool AMUTimeSeriesWriter::flush(void) {
+	bool ok = true;
+
+	if (!file)
+		return false;
+
+	for (auto& c : columns) {
+		if (!c.second.timestamps.empty())
+			ok &= writeChunk(c.first, c.second);
+	}
+
+	return ok && (fflush(file) == 0);
+}
+
+void AMUTimeSeriesWriter::close(void) {
+	if (file) {
+		flush();
+		fclose(file);
+		file = NULL;
+	}
+	columns.clear();
+}
+
+/**
+ * @brief Opens a store and indexes its chunks, only the chunk headers are read
+ *
+ * Indexing stops at the first incomplete or malformed chunk, see truncated() and tornTail().
+ *
+ * @param path 		store file
+ * @return false if the file cannot be read or is not a store
+ */
+bool AMUTimeSeries::open(const char* path) {
+	amu_ts_header_t header;
+	amu_ts_chunk_t chunk;
+	uint64_t offset;
+
+	close();
+
+	file.open(path, std::ios::binary);
+	if (!file)
+		return false;
+
+	file.seekg(0, std::ios::end);
+	length = (uint64_t)file.tellg();
+	file.seekg(0);
+
+	if ((length < sizeof(header)) || !file.read((char*)&header, sizeof(header)) ||
+		(memcmp(header.magic, AMU_TS_MAGIC, sizeof(header.magic)) != 0) ||
+		(header.version != AMU_TS_VERSION) ||
+		(header.header_size != sizeof(amu_ts_header_t)) ||
+		(header.chunk_size != sizeof(amu_ts_chunk_t))) {
+		close();
+		return false;
+	}
+
+	offset = sizeof(header);
+
+	while ((length - offset) >= sizeof(chunk)) {
+		file.seekg((std::streamoff)offset);
+		if (!file.read((char*)&chunk, sizeof(chunk)))
+			break;
+
+		if ((chunk.magic != AMU_TS_CHUNK_MAGIC) || (chunk.count == 0) || (chunk.first > chunk.last) ||
+			(chunk.length > (length - offset - sizeof(chunk))))
+			break;
+
+		std::vector<chunk_t>& chunks = index[chunk.column];
+		if (!chunks.empty() && (chunk.first < chunks.back().last))
+			break;
+
+		chunks.push_back({ offset + sizeof(chunk), chunk.length, chunk.crc, chunk.count, chunk.first, chunk.last });
+		num_chunks++;
+		offset += sizeof(chunk) + chunk.length;
+	}
+
+	file.clear();
+	valid_length = offset;
+	torn_tail = tornChunk(offset);
+
+	return true;
+}
+
+void AMUTimeSeries::close(void) {
+	if (file.is_open())
+		file.close();
+	file.clear();
+	index.clear();
+	payload.clear();
+	length = 0;
+	valid_length = 0;
+	torn_tail = false;
+	num_chunks = 0;
+}
+
+/**
+ * @brief Checks whether the bytes from offset to the end of the file are the start of a chunk
+ *
+ * A crash while writing leaves such a prefix, a plausible chunk header whose payload runs past the
+ * end of the file, or too few bytes to hold one.
+ */
+bool AMUTimeSeries::tornChunk(uint64_t offset) {
+	amu_ts_chunk_t chunk;
+	uint64_t remaining = length - offset;
+	uint32_t magic;
+
+	if (remaining == 0)
+		return false;
+
+	file.seekg((std::streamoff)offset);
+
+	if (remaining < sizeof(chunk)) {
+		bool torn = (remaining < sizeof(magic)) || (file.read((char*)&magic, sizeof(magic)) && (magic == AMU_TS_CHUNK_MAGIC));
+		file.clear();
+		return torn;
+	}
+
+	if (!file.read((char*)&chunk, sizeof(chunk))) {
+		file.clear();
+		return false;
+	}
+
+	return (chunk.magic == AMU_TS_CHUNK_MAGIC) && (chunk.count != 0) && (chunk.first <= chunk.last) &&
+		(chunk.length > (remaining - sizeof(chunk)));
+}
+
+/**
+ * @brief Columns in the store, in increasing order
+ */
+std::vector<uint16_t> AMUTimeSeries::columns(void) const {
+	std::vector<uint16_t> list;
+
+	for (const auto& c : index)
+		list.push_back(c.first);
+
+	return list;
+}
+
+/**
+ * @brief First and last timestamp of a column
+ *
+ * @return false if the column is not in the store
+ */
+bool AMUTimeSeries::timeRange(uint16_t column, int64_t* first, int64_t* last) const {
+	auto it = index.find(column);
+
+	if (it == index.end())
+		return false;
+
+	*first = it->second.front().first;
+	*last = it->second.back().last;
+
+	return true;
+}
+
+uint64_t AMUTimeSeries::points(uint16_t column) const {
+	auto it = index.find(column);
+	uint64_t count = 0;
+
+	if (it != index.end()) {
+		for (const chunk_t& c : it->second)
+			count += c.count;
+	}
+
+	return count;
+}
+
+/**
+ * @brief Points of a column within a time window, only the chunks overlapping the window are decoded
+ *
+ * @param column 		AMU_TS_COLUMN() of the device channel
+ * @param start 		first timestamp of the window
+ * @param end 			last timestamp of the window, inclusive
+ * @param timestamps 	the timestamps of the points found are appended here
+ * @param values 		the values of the points found are appended here
+ * @return false if a chunk could not be read or failed its CRC, the points of the other chunks are still returned
+ */
+bool AMUTimeSeries::query(uint16_t column, int64_t start, int64_t end, std::vector<int64_t>& timestamps, std::vector<float>& values) {
+	auto it = index.find(column);
+	bool ok = true;
+
+	if (it == index.end() || (start > end))
+		return true;
+
+	const std::vector<chunk_t>& chunks = it->second;
+	auto chunk = std::partition_point(chunks.begin(), chunks.end(), [start](const chunk_t& c) { return c.last < start; });
+
+	for (; (chunk != chunks.end()) && (chunk->first <= end); ++chunk) {
+		payload.resize(chunk->length);
+		file.seekg((std::streamoff)chunk->offset);
+
+		if (!file.read((char*)payload.data(), chunk->length) || (amu_crc32(payload.data(), payload.size()) != chunk->crc)) {
+			file.clear();
+			ok = false;
+			continue;
+		}
+
+		_bit_reader in = { payload.data(), payload.size(), 0 };
+		uint8_t coding = (uint8_t)in.get(8);
+		int64_t t = chunk->first;
+		int64_t delta = 0, code = 0;
+		uint32_t value = (uint32_t)in.get(32);
+		uint8_t leading = 0, trailing = 0;
+
+		if ((coding > AMU_TS_MAX_DECIMALS) && (coding != AMU_TS_CODING_XOR)) {
+			ok = false;
+			continue;
+		}
+		if (coding != AMU_TS_CODING_XOR)
+			_decimal_code(_bits_float(value), coding, &code);
+
+		for (uint16_t n = 0; ; ) {
+			if (t >= start) {
+				timestamps.push_back(t);
+				values.push_back(_bits_float(value));
+			}
+
+			if (++n >= chunk->count)
+				break;
+
+			delta = (int64_t)((uint64_t)delta + (uint64_t)_get_dod(in));
+			t = (int64_t)((uint64_t)t + (uint64_t)delta);
+
+			if (coding == AMU_TS_CODING_XOR) {
+				if (in.get(1)) {
+					if (in.get(1)) {
+						leading = (uint8_t)in.get(5);
+						trailing = 32 - leading - ((uint8_t)in.get(5) + 1);
+					}
+					value ^= (uint32_t)in.get(32 - leading - trailing) << trailing;
+				}
+			}
+			else {
+				int64_t d = 0;
+				bool exact = true;
+
+				if (!in.get(1))
+					d = 0;
+				else if (!in.get(1))
+					d = (int64_t)in.get(4) - 8;
+				else if (!in.get(1))
+					d = (int64_t)in.get(8) - 128;
+				else if (!in.get(1))
+					d = (int64_t)in.get(16) - 32768;
+				else if (!in.get(1))
+					d = (int32_t)(uint32_t)in.get(32);
+				else {
+					value = (uint32_t)in.get(32);		// did not decode exactly, stored as is
+					exact = false;
+				}
+
+				if (exact) {
+					code += d;
+					value = _float_bits((float)((double)code / _pow10[coding]));
+				}
+			}
+
+			if (t > end)
+				break;
+		}
+	}
+
+	return ok;
+}
+
+#endif /* __AMU_HOST__ */
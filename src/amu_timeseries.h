@@ -0,0 +1,160 @@
+/**
+ * @file amu_timeseries.h
+ * @brief Compressed columnar time series store for long logging runs such as TVAC tests
+ *
+ * Every (device, channel) pair is its own column. Points are appended to an open chunk per column,
+ * and a chunk is written once it holds chunk_points points or on flush(). A chunk stores its first
+ * and last timestamp in its header and the points as one bit stream, with timestamps as delta-of-delta
+ * codes. Readings parsed from the instrument's text replies are short decimals, which have no short
+ * binary form: XOR'ing their floats leaves a dozen or two noisy mantissa bits per value. A chunk whose
+ * values are such decimals therefore stores them as changes of the integer value * 10^decimals, with
+ * the fewest decimals that reproduce every float exactly, and the odd value that does not is stored
+ * as is. Other chunks store values XOR'd with the previous value, keeping only the differing bits
+ * (the Gorilla scheme, adapted to 32-bit floats). Steady sample intervals cost one bit per timestamp,
+ * a reading that moves by a few counts of its last decimal about six bits.
+ *
+ * A query only reads and decodes the chunks of one column that overlap its time window. Chunks
+ * carry a CRC-32 of their payload, a chunk torn by a crash ends the index and the writer cuts it
+ * off before appending. A malformed chunk anywhere else is left in place and the writer refuses to
+ * append to the file.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_TIMESERIES_H__
+#define __AMU_TIMESERIES_H__
+
+#include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_types.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+#include <stdio.h>
+#include <fstream>
+#include <map>
+#include <vector>
+
+#define AMU_TS_MAGIC				"AMUTSERS"
+#define AMU_TS_VERSION				2
+#define AMU_TS_CHUNK_MAGIC			0x4B484354UL			// "TCHK"
+
+#ifndef AMU_TS_CHUNK_POINTS
+#define AMU_TS_CHUNK_POINTS			1024
+#endif
+
+#define AMU_TS_MAX_DECIMALS			9
+#define AMU_TS_CODING_XOR			0xFF				// value coding of a chunk that is not a number of decimals
+
+/**
+ * @brief Column of a device channel, channel is an amu_adc_ch_t or any other channel number below 256
+ */
+#define AMU_TS_COLUMN(device, channel)	((uint16_t)(((uint16_t)(device) << 8) | (uint8_t)(channel)))
+#define AMU_TS_COLUMN_DEVICE(column)	((uint8_t)((column) >> 8))
+#define AMU_TS_COLUMN_CHANNEL(column)	((uint8_t)(column))
+
+typedef struct {
+	char magic[8];				/*!< AMU_TS_MAGIC */
+	uint16_t version;			/*!< AMU_TS_VERSION */
+	uint16_t header_size;		/*!< sizeof(amu_ts_header_t) */
+	uint16_t chunk_size;		/*!< sizeof(amu_ts_chunk_t) */
+	uint16_t reserved;
+} amu_ts_header_t;
+
+typedef struct {
+	uint32_t magic;				/*!< AMU_TS_CHUNK_MAGIC */
+	uint16_t column;			/*!< AMU_TS_COLUMN() */
+	uint16_t count;				/*!< points in the chunk */
+	uint32_t length;			/*!< payload bytes following this header */
+	uint32_t crc;				/*!< CRC-32 of the payload */
+	int64_t first;				/*!< timestamp of the first point */
+	int64_t last;				/*!< timestamp of the last point */
+} amu_ts_chunk_t;
+
+class AMUTimeSeriesWriter {
+
+public:
+
+	AMUTimeSeriesWriter() {}
+	~AMUTimeSeriesWriter() { close(); }
+
+	AMUTimeSeriesWriter(const AMUTimeSeriesWriter&) = delete;
+	AMUTimeSeriesWriter& operator=(const AMUTimeSeriesWriter&) = delete;
+
+	bool			open(const char* path, uint16_t chunk_points = AMU_TS_CHUNK_POINTS);
+	bool			append(uint16_t column, int64_t timestamp, float value);
+	bool			append(uint16_t column, const int64_t* timestamps, const float* values, size_t count);
+	bool			flush(void);
+	void			close(void);
+
+	uint64_t		points(void) const { return total_points; }
+
+protected:
+
+	struct column_t {
+		std::vector<int64_t> timestamps;		// points of the open chunk
+		std::vector<float> values;
+		int64_t last = 0;
+		bool started = false;			// a point was written in this or an earlier session, last is valid
+	};
+
+	FILE* file = NULL;
+	uint16_t chunk_points = AMU_TS_CHUNK_POINTS;
+	uint64_t total_points = 0;
+	std::map<uint16_t, column_t> columns;
+	std::vector<uint8_t> payload;
+	std::vector<uint8_t> scratch;
+
+	bool			writeChunk(uint16_t column, column_t& state);
+};
+
+class AMUTimeSeries {
+
+public:
+
+	AMUTimeSeries() {}
+	~AMUTimeSeries() { close(); }
+
+	AMUTimeSeries(const AMUTimeSeries&) = delete;
+	AMUTimeSeries& operator=(const AMUTimeSeries&) = delete;
+
+	bool			open(const char* path);
+	void			close(void);
+
+	std::vector<uint16_t>	columns(void) const;
+	bool			timeRange(uint16_t column, int64_t* first, int64_t* last) const;
+	uint64_t		points(uint16_t column) const;
+	size_t			chunks(void) const { return num_chunks; }
+	uint64_t		validLength(void) const { return valid_length; }
+	bool			truncated(void) const { return valid_length < length; }
+	bool			tornTail(void) const { return torn_tail; }		// truncated() only by a chunk cut short at the end of the file
+
+	bool			query(uint16_t column, int64_t start, int64_t end, std::vector<int64_t>& timestamps, std::vector<float>& values);
+
+protected:
+
+	struct chunk_t {
+		uint64_t offset;				// of the payload
+		uint32_t length;
+		uint32_t crc;
+		uint16_t count;
+		int64_t first;
+		int64_t last;
+	};
+
+	std::ifstream file;
+	uint64_t length = 0;
+	uint64_t valid_length = 0;
+	bool torn_tail = false;
+	size_t num_chunks = 0;
+	std::map<uint16_t, std::vector<chunk_t>> index;
+	std::vector<uint8_t> payload;
+
+	bool			tornChunk(uint64_t offset);
+};
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_TIMESERIES_H__ */
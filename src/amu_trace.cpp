@@ -0,0 +1,328 @@
+/**
+ * @file amu_trace.cpp
+ * @brief Transfer level trace recorder and deterministic replay
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_trace.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+
+#define AMU_TRACE_FLAG_READ			0x01
+#define AMU_TRACE_FLAG_RESULT		0x02		// a non-zero result byte follows the flags
+
+typedef std::chrono::steady_clock amu_trace_clock_t;
+
+static struct {
+	std::mutex lock;
+	FILE* file = NULL;
+	amu_transfer_fptr_t transport = NULL;
+	amu_trace_clock_t::time_point start;
+	uint64_t last_us = 0;
+	uint32_t count = 0;
+	std::vector<uint8_t> record;
+} recorder;
+
+static struct {
+	std::mutex lock;
+	std::vector<uint8_t> data;
+	std::vector<amu_trace_transfer_t> transfers;
+	size_t position = 0;
+	uint32_t divergences = 0;
+} replay;
+
+static inline void _put_varint(std::vector<uint8_t>& out, uint64_t value) {
+	while (value >= 0x80) {
+		out.push_back((uint8_t)(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back((uint8_t)value);
+}
+
+static inline bool _get_varint(const uint8_t*& p, const uint8_t* end, uint64_t* value) {
+	*value = 0;
+
+	for (uint8_t shift = 0; (p < end) && (shift < 64); shift += 7) {
+		uint8_t b = *p++;
+		*value |= (uint64_t)(b & 0x7F) << shift;
+		if (!(b & 0x80))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * @brief Starts recording to a new trace file, a running recording is stopped first
+ *
+ * @param path 			trace file, overwritten
+ * @param transport 	bus transport the recorded calls are passed on to
+ * @return false if the file cannot be created
+ */
+bool AMUTraceRecorder::start(const char* path, amu_transfer_fptr_t transport) {
+	amu_trace_header_t header;
+
+	stop();
+
+	std::lock_guard<std::mutex> guard(recorder.lock);
+
+	if (!transport || !(recorder.file = fopen(path, "wb")))
+		return false;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, AMU_TRACE_MAGIC, sizeof(header.magic));
+	header.version = AMU_TRACE_VERSION;
+	header.header_size = sizeof(amu_trace_header_t);
+
+	if (fwrite(&header, sizeof(header), 1, recorder.file) != 1) {
+		fclose(recorder.file);
+		recorder.file = NULL;
+		return false;
+	}
+
+	recorder.transport = transport;
+	recorder.start = amu_trace_clock_t::now();
+	recorder.last_us = 0;
+	recorder.count = 0;
+
+	return true;
+}
+
+/**
+ * @brief Closes the trace file, transfers still go to the transport afterwards
+ */
+void AMUTraceRecorder::stop(void) {
+	std::lock_guard<std::mutex> guard(recorder.lock);
+
+	if (recorder.file) {
+		fclose(recorder.file);
+		recorder.file = NULL;
+	}
+}
+
+bool AMUTraceRecorder::recording(void) {
+	std::lock_guard<std::mutex> guard(recorder.lock);
+	return recorder.file != NULL;
+}
+
+uint32_t AMUTraceRecorder::transfers(void) {
+	std::lock_guard<std::mutex> guard(recorder.lock);
+	return recorder.count;
+}
+
+/**
+ * @brief amu_transfer_fptr_t that records the call and passes it on to the transport given to start()
+ *
+ * @return int8_t 	result of the transport, -1 if start() was never called
+ */
+int8_t AMUTraceRecorder::transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	amu_transfer_fptr_t transport;
+	amu_trace_clock_t::time_point when = amu_trace_clock_t::now();
+	int8_t result;
+
+	{
+		std::lock_guard<std::mutex> guard(recorder.lock);
+		transport = recorder.transport;
+	}
+
+	if (!transport)
+		return -1;
+
+	result = transport(address, reg, data, len, read);
+
+	std::lock_guard<std::mutex> guard(recorder.lock);
+
+	if (!recorder.file)
+		return result;
+
+	uint64_t time_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(when - recorder.start).count();
+	uint8_t flags = (read ? AMU_TRACE_FLAG_READ : 0) | (result ? AMU_TRACE_FLAG_RESULT : 0);
+
+	// concurrent callers may take their timestamps out of order, keep the deltas non-negative
+	if (time_us < recorder.last_us)
+		time_us = recorder.last_us;
+
+	recorder.record.clear();
+	_put_varint(recorder.record, time_us - recorder.last_us);
+	recorder.record.push_back(address);
+	recorder.record.push_back(reg);
+	recorder.record.push_back(flags);
+	if (result)
+		recorder.record.push_back((uint8_t)result);
+	_put_varint(recorder.record, len);
+	if (data && len)
+		recorder.record.insert(recorder.record.end(), data, data + len);
+
+	if (fwrite(recorder.record.data(), 1, recorder.record.size(), recorder.file) == recorder.record.size()) {
+		recorder.last_us = time_us;
+		recorder.count++;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Loads a trace for replay and rewinds to its first transfer
+ *
+ * A trace cut short by a crash loads up to its last complete transfer.
+ *
+ * @param path 		trace file
+ * @return false if the file cannot be read or is not a trace
+ */
+bool AMUTraceReplay::load(const char* path) {
+	std::ifstream file(path, std::ios::binary);
+	amu_trace_header_t header;
+
+	unload();
+
+	if (!file)
+		return false;
+
+	std::lock_guard<std::mutex> guard(replay.lock);
+
+	replay.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+	if (replay.data.size() < sizeof(header)) {
+		replay.data.clear();
+		return false;
+	}
+
+	memcpy(&header, replay.data.data(), sizeof(header));
+	if ((memcmp(header.magic, AMU_TRACE_MAGIC, sizeof(header.magic)) != 0) ||
+		(header.version != AMU_TRACE_VERSION) ||
+		(header.header_size != sizeof(amu_trace_header_t))) {
+		replay.data.clear();
+		return false;
+	}
+
+	const uint8_t* p = replay.data.data() + sizeof(header);
+	const uint8_t* end = replay.data.data() + replay.data.size();
+	uint64_t time_us = 0;
+
+	while (p < end) {
+		amu_trace_transfer_t t;
+		uint64_t delta, len;
+		uint8_t flags;
+
+		if (!_get_varint(p, end, &delta) || ((end - p) < 3))
+			break;
+
+		t.address = *p++;
+		t.reg = *p++;
+		flags = *p++;
+		t.read = (flags & AMU_TRACE_FLAG_READ) ? 1 : 0;
+		t.result = 0;
+
+		if (flags & AMU_TRACE_FLAG_RESULT) {
+			if (p >= end)
+				break;
+			t.result = (int8_t)*p++;
+		}
+
+		if (!_get_varint(p, end, &len) || (len > (uint64_t)(end - p)))
+			break;
+
+		time_us += delta;
+		t.time_us = time_us;
+		t.len = (uint32_t)len;
+		t.payload = p;
+		p += len;
+
+		replay.transfers.push_back(t);
+	}
+
+	return true;
+}
+
+void AMUTraceReplay::unload(void) {
+	std::lock_guard<std::mutex> guard(replay.lock);
+
+	replay.transfers.clear();
+	replay.data.clear();
+	replay.position = 0;
+	replay.divergences = 0;
+}
+
+/**
+ * @brief Restarts the replay at the first transfer and clears the divergence count
+ */
+void AMUTraceReplay::rewind(void) {
+	std::lock_guard<std::mutex> guard(replay.lock);
+
+	replay.position = 0;
+	replay.divergences = 0;
+}
+
+size_t AMUTraceReplay::size(void) {
+	std::lock_guard<std::mutex> guard(replay.lock);
+	return replay.transfers.size();
+}
+
+size_t AMUTraceReplay::position(void) {
+	std::lock_guard<std::mutex> guard(replay.lock);
+	return replay.position;
+}
+
+uint32_t AMUTraceReplay::divergences(void) {
+	std::lock_guard<std::mutex> guard(replay.lock);
+	return replay.divergences;
+}
+
+/**
+ * @brief A recorded transfer, for inspecting a trace
+ *
+ * @param index 		transfer number, less than size()
+ * @param transfer 		the transfer, its payload stays valid until the trace is unloaded
+ * @return false if index is out of range
+ */
+bool AMUTraceReplay::transferAt(size_t index, amu_trace_transfer_t* transfer) {
+	std::lock_guard<std::mutex> guard(replay.lock);
+
+	if (index >= replay.transfers.size())
+		return false;
+
+	*transfer = replay.transfers[index];
+	return true;
+}
+
+/**
+ * @brief amu_transfer_fptr_t that answers from the loaded trace
+ *
+ * A call that does not match the next transfer does not advance the replay, so a path that adds
+ * transfers picks up again at the next one that matches. Written bytes are not compared, since
+ * writes such as time stamps differ between runs.
+ *
+ * @return int8_t 	recorded result, AMU_TRACE_ERROR_DIVERGED or AMU_TRACE_ERROR_END
+ */
+int8_t AMUTraceReplay::transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read) {
+	std::lock_guard<std::mutex> guard(replay.lock);
+
+	if (replay.position >= replay.transfers.size()) {
+		replay.divergences++;
+		return AMU_TRACE_ERROR_END;
+	}
+
+	const amu_trace_transfer_t& t = replay.transfers[replay.position];
+
+	if ((t.address != address) || (t.reg != reg) || (t.read != (read ? 1 : 0)) || (t.len != len)) {
+		replay.divergences++;
+		return AMU_TRACE_ERROR_DIVERGED;
+	}
+
+	if (t.read && data && len)
+		memcpy(data, t.payload, len);
+
+	replay.position++;
+
+	return t.result;
+}
+
+#endif /* __AMU_HOST__ */
@@ -0,0 +1,94 @@
+/**
+ * @file amu_trace.h
+ * @brief Transfer level trace recorder and deterministic replay
+ *
+ * AMUTraceRecorder::transfer() is an amu_transfer_fptr_t that passes every call on to the real
+ * transport and appends it to a trace file: time since the previous transfer, address, register,
+ * direction, result and the payload (the bytes written, or the bytes read back). Times and lengths
+ * are varints, so a transfer costs 5-7 bytes plus its payload.
+ *
+ * AMUTraceReplay::transfer() is an amu_transfer_fptr_t that plays a trace back without hardware.
+ * Every call must match the next recorded transfer in address, register, direction and length;
+ * reads get the recorded bytes and every call gets the recorded result. A call that does not match
+ * returns AMU_TRACE_ERROR_DIVERGED and is counted, so a changed readout path shows up as
+ * divergences instead of silently reading the wrong data.
+ *
+ * Pass either function to AMU::begin() (or set amu_device_t::transfer) in place of the bus
+ * transport. The AMU class and the SCPI layer both go through that pointer, so both can be traced
+ * and replayed. Transports are plain function pointers, so there is one recorder and one replay
+ * per process.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_TRACE_H__
+#define __AMU_TRACE_H__
+
+#include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_types.h"
+
+#if defined(__AMU_HOST__) && defined(__cplusplus)
+
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#define AMU_TRACE_MAGIC				"AMUTRACE"
+#define AMU_TRACE_VERSION			1
+
+#define AMU_TRACE_ERROR_DIVERGED	(-11)		/*!< Replayed call does not match the next recorded transfer */
+#define AMU_TRACE_ERROR_END			(-12)		/*!< Replay ran past the last recorded transfer */
+
+typedef struct {
+	char magic[8];				/*!< AMU_TRACE_MAGIC */
+	uint16_t version;			/*!< AMU_TRACE_VERSION */
+	uint16_t header_size;		/*!< sizeof(amu_trace_header_t) */
+	uint32_t reserved;
+} amu_trace_header_t;
+
+/**
+ * @brief One recorded transfer, the payload points into the loaded trace
+ */
+typedef struct {
+	uint64_t time_us;			/*!< since the start of the recording */
+	uint8_t address;
+	uint8_t reg;
+	uint8_t read;				/*!< 1 for read, 0 for write */
+	int8_t result;				/*!< returned by the transport */
+	uint32_t len;
+	const uint8_t* payload;
+} amu_trace_transfer_t;
+
+class AMUTraceRecorder {
+
+public:
+
+	static bool		start(const char* path, amu_transfer_fptr_t transport);
+	static void		stop(void);
+	static bool		recording(void);
+	static uint32_t	transfers(void);
+
+	static int8_t	transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read);
+};
+
+class AMUTraceReplay {
+
+public:
+
+	static bool		load(const char* path);
+	static void		unload(void);
+	static void		rewind(void);
+
+	static size_t	size(void);
+	static size_t	position(void);
+	static uint32_t	divergences(void);
+	static bool		transferAt(size_t index, amu_trace_transfer_t* transfer);
+
+	static int8_t	transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t read);
+};
+
+#endif /* __AMU_HOST__ */
+
+#endif /* __AMU_TRACE_H__ */
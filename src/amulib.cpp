@@ -13,14 +13,44 @@
 #include <Arduino.h>
 #endif
 
+#include <math.h>
+
 
 AMU::errorPrintFncPtr_t AMU::errorPrintFncPtr = nullptr;
 AMU::resetFncPtr_t AMU::amuResetFncPtr = nullptr;
 AMU::resetFncPtr_t AMU::eyasResetFncPtr = nullptr;
-
+uint16_t AMU::clock_epoch = 0;
+
+/**
+ * @brief ADC scaling of a device, shared by every AMU object talking to the same serial number
+ */
+typedef struct {
+	char serial[AMU_SERIALNUM_STR_LEN];
+	amu_adc_cal_t cal;
+} amu_adc_cal_cache_t;
+
+static amu_adc_cal_cache_t adc_cal_cache[AMU_ADC_CAL_CACHE_SIZE];
+static uint8_t adc_cal_cache_count = 0;
+static uint8_t adc_cal_cache_next = 0;
+
+static amu_identity_cache_t identity_cache;		// initialized by the first amu_identity_read()
+bool AMU::identity_cache_enabled = true;
+
+/**
+ * @brief Reads the identity and sweep configuration of the device at twiAddress
+ *
+ * Uses the single identity block read when the firmware has one, and the separate firmware, serial
+ * number, hardware revision, DUT and sweep configuration reads otherwise.
+ *
+ * @param twiAddress 	TWI address of the device
+ */
 void AMU::begin(uint8_t twiAddress) {
 
 	address = twiAddress;
+	capabilities.length = 0;
+
+	if (readIdentity() >= 0)
+		return;
 
 	readFirmwareStr();
 
@@ -79,13 +109,146 @@ char* AMU::readFirmwareStr() {
 	return query<char>((CMD_t)CMD_SYSTEM_FIRMWARE, (char*)&firmware, (size_t)AMU_FIRMWARE_STR_LEN);
 }
 
+/**
+ * @brief Reads the firmware, serial number, hardware revision, DUT and sweep configuration in one block
+ *
+ * With the identity cache enabled a device read before is only asked for the CRC of its block, and
+ * the cached block is used if the CRC has not changed.
+ *
+ * @return int8_t 	0 if read from the device, 1 if the cached block was used, negative if the firmware has
+ * 					no identity block or the transfer failed, the members are then unchanged
+ */
+int8_t AMU::readIdentity(void) {
+	amu_identity_t identity;
+	int8_t result = amu_identity_read(address, identity_cache_enabled ? &identity_cache : NULL, &identity);
+
+	if (result < 0)
+		return result;
+
+	memcpy(firmware, identity.firmware, AMU_FIRMWARE_STR_LEN);
+	memcpy(serial_number, identity.serial, AMU_SERIALNUM_STR_LEN);
+	hardware_revision = (amu_hardware_revision_t)identity.hardware_revision;
+	sweep_config = identity.sweep_config;
+	followSweepConfig();
+	dut = identity.dut;
+
+	return result;
+}
+
+/**
+ * @brief The identity cache shared by all AMU objects, save sizeof(amu_identity_cache_t) bytes to keep it between runs
+ */
+const amu_identity_cache_t* AMU::getIdentityCache(void) {
+	if (identity_cache.size != sizeof(amu_identity_cache_t))
+		amu_identity_cache_init(&identity_cache);
+
+	return &identity_cache;
+}
+
+/**
+ * @brief Restores an identity cache saved from getIdentityCache()
+ *
+ * @return bool 	false if the data is not a cache of this build, the cache is then empty
+ */
+bool AMU::loadIdentityCache(const void* data, size_t len) {
+	return amu_identity_cache_load(&identity_cache, data, len);
+}
+
+void AMU::clearIdentityCache(void) {
+	amu_identity_cache_init(&identity_cache);
+}
+
 int8_t AMU::setActiveChannels(uint16_t channels) {
 	return write_twi_reg<uint16_t>(AMU_REG_SYSTEM_ADC_ACTIVE_CHANNELS, channels);
 }
 
+/**
+ * @brief Sets the device millisecond clock and clears the clock model of this device
+ *
+ * @param timestamp 	new device time in ms, usually the host millis()
+ * @return int8_t 		0 on success, otherwise the error of the transport, the clock model is then kept
+ */
 int8_t AMU::setTimeStamp(uint32_t timestamp) {
-	//SAFE_CMD_DATA(CMD_SYSTEM_TIME, &timestamp, sizeof(uint32_t), "CMD TIMESTAMP");
-	return 0;
+	int8_t result = sendCommand((CMD_t)CMD_SYSTEM_TIME, (void*)&timestamp, sizeof(uint32_t));
+
+	if (result == 0)
+		resetClockModel();
+
+	return result;
+}
+
+/**
+ * @brief Sets the millisecond clock of every device on the bus at once through the all-call address
+ *
+ * The broadcast is sent once, without retries, as no device acknowledges it for all of them. Every
+ * AMU object drops its clock model at its next sampleClock() or toHostTime().
+ *
+ * @param timestamp 	new device time in ms, usually the host millis()
+ * @return int8_t 		0 on success, otherwise the error of the transport
+ */
+int8_t AMU::broadcastTimeStamp(uint32_t timestamp) {
+	uint8_t cmd = (uint8_t)CMD_SYSTEM_TIME;
+	int8_t result;
+
+	if (!amu_device.transfer)
+		return -1;
+
+	if ((result = amu_device.transfer(AMU_TWI_ALLCALL_ADDRESS, (uint8_t)AMU_REG_TRANSFER_PTR, (uint8_t*)&timestamp, sizeof(uint32_t), AMU_TWI_TRANSFER_WRITE)) != 0)
+		return result;
+
+	result = amu_device.transfer(AMU_TWI_ALLCALL_ADDRESS, (uint8_t)AMU_REG_CMD, &cmd, sizeof(uint8_t), AMU_TWI_TRANSFER_WRITE);
+
+	clock_epoch++;
+
+	return result;
+}
+
+/**
+ * @brief Reads the device clock between two host clock readings and refits the clock model
+ *
+ * Call every few seconds to minutes, the drift estimate improves as the samples span more time.
+ *
+ * @return int8_t 	0 on success, 1 if the sample was rejected, negative on error
+ */
+int8_t AMU::sampleClock(void) {
+	uint32_t before, after, device_ms;
+	int8_t result;
+
+	if (!amu_dev || !amu_dev->millis)
+		return -1;
+
+	if (clock_epoch_seen != clock_epoch)
+		resetClockModel();
+
+	before = amu_dev->millis();
+	result = amu_dev_transfer(address, (uint8_t)AMU_REG_TIME_MILLIS, (uint8_t*)&device_ms, sizeof(uint32_t), AMU_TWI_TRANSFER_READ);
+	after = amu_dev->millis();
+
+	if (result != 0)
+		return result;
+
+	return amu_timesync_add(&clock_sync, before, device_ms, after) ? 0 : 1;
+}
+
+/**
+ * @brief Host time of a device timestamp, unchanged until sampleClock() succeeded
+ */
+uint32_t AMU::toHostTime(uint32_t device_ms) {
+	if (clock_epoch_seen != clock_epoch)
+		resetClockModel();
+
+	return amu_timesync_to_host(&clock_sync, device_ms);
+}
+
+/**
+ * @brief Maps device timestamps to host time in place
+ */
+uint32_t * AMU::toHostTime(uint32_t* timestamps, uint16_t count) {
+	if (clock_epoch_seen != clock_epoch)
+		resetClockModel();
+
+	amu_timesync_map(&clock_sync, timestamps, timestamps, count);
+	return timestamps;
 }
 
 int8_t AMU::setLEDcolor(float red, float grn, float blu) {
@@ -104,6 +267,157 @@ uint8_t AMU::getPGA(AMU_ADC_CH_t channel) {
 		return 0;
 }
 
+/**
+ * @brief Fetches the PGA and range of all ADC channels, once per device serial number
+ *
+ * The scaling is cached so other AMU objects and later calls for the same device skip the
+ * queries. Reload after changing a PGA or a range.
+ *
+ * @param reload 	query the device even if its scaling is cached
+ * @return int8_t 0 on success, otherwise the error of the first query that failed (nothing is cached)
+ */
+int8_t AMU::loadADCCalibration(bool reload) {
+	amu_adc_cal_cache_t* entry = NULL;
+	amu_adc_cal_t cal;
+	int8_t result = 0;
+	int8_t failed = 0;
+
+	for (uint8_t n = 0; n < adc_cal_cache_count; n++) {
+		if (strncmp(adc_cal_cache[n].serial, serial_number, AMU_SERIALNUM_STR_LEN) == 0) {
+			entry = &adc_cal_cache[n];
+			break;
+		}
+	}
+
+	if (entry && !reload) {
+		adc_cal_entry = (int8_t)(entry - adc_cal_cache);
+		return 0;
+	}
+
+	for (uint8_t ch = 0; (failed == 0) && (ch < AMU_ADC_CH_NUM); ch++) {
+		cal.pga[ch] = queryChannel<uint8_t>((CMD_t)CMD_ADC_CH_PGA, ch, &result);
+		cal.full_scale[ch] = AMU_ADC_VREF / (float)(1 << cal.pga[ch]);
+		failed = result;
+	}
+
+	if (failed == 0) {
+		cal.full_scale[AMU_ADC_CH_VOLTAGE] = queryChannel<float>((CMD_t)CMD_ADC_CH_PGA_VMAX, cal.pga[AMU_ADC_CH_VOLTAGE], &result);
+		failed = result;
+	}
+
+	if (failed == 0) {
+		cal.full_scale[AMU_ADC_CH_CURRENT] = queryChannel<float>((CMD_t)CMD_ADC_CH_PGA_IMAX, cal.pga[AMU_ADC_CH_CURRENT], &result);
+		failed = result;
+	}
+
+	if (failed != 0) {
+		if (AMU::errorPrintFncPtr) {
+			AMU::errorPrintFncPtr("ADC calibration of %s could not be read\n", serial_number);
+		}
+		return failed;
+	}
+
+	for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++)
+		cal.scale[ch] = cal.full_scale[ch] / (float)AMU_ADC_CODE_ZERO;
+
+	if (!entry) {
+		if (adc_cal_cache_count < AMU_ADC_CAL_CACHE_SIZE)
+			entry = &adc_cal_cache[adc_cal_cache_count++];
+		else {
+			entry = &adc_cal_cache[adc_cal_cache_next];
+			adc_cal_cache_next = (adc_cal_cache_next + 1) % AMU_ADC_CAL_CACHE_SIZE;
+		}
+		strncpy(entry->serial, serial_number, AMU_SERIALNUM_STR_LEN);
+	}
+
+	entry->cal = cal;
+	adc_cal_entry = (int8_t)(entry - adc_cal_cache);
+
+	return 0;
+}
+
+/**
+ * @brief Cached ADC scaling of the device
+ *
+ * @return const amu_adc_cal_t* NULL if they are not loaded or were evicted from the cache
+ */
+const amu_adc_cal_t* AMU::getADCCalibration(void) {
+	if ((adc_cal_entry < 0) || (adc_cal_entry >= adc_cal_cache_count))
+		return NULL;
+
+	if (strncmp(adc_cal_cache[adc_cal_entry].serial, serial_number, AMU_SERIALNUM_STR_LEN) != 0)
+		return NULL;
+
+	return &adc_cal_cache[adc_cal_entry].cal;
+}
+
+/**
+ * @brief Reads the codes of all 16 ADC channels in one 64 byte transfer
+ *
+ * Firmware without AMU_CAP_ADC_RAW is read one AMU_REG_ADC_DATA_* register at a time.
+ *
+ * @return int8_t 0 on success, otherwise the transport error
+ */
+int8_t AMU::readADCRaw(adc_channels_t* raw) {
+	int8_t result;
+
+	if (!raw)
+		return -1;
+
+	if (hasCapability(AMU_CAP_ADC_RAW))
+		return amu_dev_transfer_ext(address, (uint16_t)AMU_REG_EXT_ADC_RAW, 0, (uint8_t*)raw, sizeof(adc_channels_t), AMU_TWI_TRANSFER_READ);
+
+	for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++) {
+		if ((result = amu_dev_transfer(address, (uint8_t)(AMU_REG_ADC_DATA + ch * sizeof(uint32_t)), (uint8_t*)&raw->channel[ch], sizeof(uint32_t), AMU_TWI_TRANSFER_READ)) != 0)
+			return result;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Reads all 16 ADC channels in one transfer and converts them with the cached scaling
+ *
+ * @param values 	AMU_ADC_CH_NUM values indexed by amu_adc_ch_t
+ * @return int8_t 0 on success, negative on error
+ */
+int8_t AMU::readADCChannels(float* values) {
+	adc_channels_t raw;
+	int8_t result;
+
+	if (!values)
+		return -1;
+
+	if (!getADCCalibration() && ((result = loadADCCalibration()) != 0))
+		return result;
+
+	if ((result = readADCRaw(&raw)) != 0)
+		return result;
+
+	convertADCRaw(getADCCalibration(), &raw, values);
+
+	return 0;
+}
+
+/**
+ * @brief Converts ADC codes read from a device, value = (code - AMU_ADC_CODE_ZERO) / AMU_ADC_CODE_ZERO * full scale
+ *
+ * The codes are already corrected by the offset and gain coefficients of the HRADC.
+ *
+ * @param cal 		scaling from loadADCCalibration()
+ * @param raw 		codes of all channels
+ * @param values 	AMU_ADC_CH_NUM values indexed by amu_adc_ch_t
+ */
+void AMU::convertADCRaw(const amu_adc_cal_t* cal, const adc_channels_t* raw, float* values) {
+	for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++)
+		values[ch] = (float)((int32_t)raw->channel[ch] - (int32_t)AMU_ADC_CODE_ZERO) * cal->scale[ch];
+}
+
+void AMU::clearADCCalibrationCache(void) {
+	adc_cal_cache_count = 0;
+	adc_cal_cache_next = 0;
+}
+
 float AMU::measureVoltage() { return query<float>((CMD_t)CMD_MEAS_CH_VOLTAGE);	}
 float AMU::measureCurrent() { return query<float>((CMD_t)CMD_MEAS_CH_CURRENT); }
 float AMU::measureTSensor() { return query<float>((CMD_t)CMD_MEAS_CH_TSENSOR_0); }
@@ -167,8 +481,91 @@ float AMU::measureSystemTemperature() {
 	return query<float>((CMD_t)CMD_SYSTEM_TEMPERATURE);
 }
 
-ivsweep_config_t * AMU::readSweepConfig() { sweep_config = read_twi_reg<ivsweep_config_t>(AMU_REG_DATA_PTR_SWEEP_CONFIG); return &sweep_config; }
-ivsweep_meta_t * AMU::readMeta() { meta = read_twi_reg<ivsweep_meta_t>(AMU_REG_DATA_PTR_SWEEP_META); return &meta; }
+ivsweep_config_t * AMU::readSweepConfig() {
+	sweep_config = read_twi_reg<ivsweep_config_t>(AMU_REG_DATA_PTR_SWEEP_CONFIG);
+	followSweepConfig();
+	return &sweep_config;
+}
+
+/**
+ * @brief Reads the sweep configuration with 16-bit points and a microsecond delay
+ *
+ * Firmware without AMU_CAP_SWEEP_CONFIG_V2 is read through the v1 registers. getSweepConfig() is
+ * updated too, clamped to what ivsweep_config_t can hold.
+ *
+ * @return ivsweep_config_v2_t*
+ */
+ivsweep_config_v2_t * AMU::readSweepConfigV2() {
+	ivsweep_config_v2_t config;
+
+	if (amu_sweep_config_read(address, hasCapability(AMU_CAP_SWEEP_CONFIG_V2) ? &capabilities : NULL, &config) == 0) {
+		sweep_config_v2 = config;
+		amu_sweep_config_to_v1(&sweep_config, &sweep_config_v2);
+	}
+
+	return &sweep_config_v2;
+}
+
+/**
+ * @brief Writes the sweep configuration with 16-bit points and a microsecond delay
+ *
+ * Firmware without AMU_CAP_SWEEP_CONFIG_V2 is written through the v1 registers, as long as the
+ * configuration fits them.
+ *
+ * @param config 	configuration, numPoints is clamped by the device to getCapabilities()->maxPoints
+ * @return int8_t 	0 on success, AMU_SWEEP_CONFIG_ERROR_RANGE if the firmware cannot run the configuration,
+ * 					otherwise the error of the transport
+ */
+int8_t AMU::writeSweepConfigV2(const ivsweep_config_v2_t* config) {
+	int8_t result = amu_sweep_config_write(address, hasCapability(AMU_CAP_SWEEP_CONFIG_V2) ? &capabilities : NULL, config);
+
+	if (result == 0) {
+		sweep_config_v2 = *config;
+		sweep_config_v2.version = AMU_SWEEP_CONFIG_VERSION;
+		if (sweep_config_v2.numPoints > capabilities.maxPoints)
+			sweep_config_v2.numPoints = capabilities.maxPoints;
+		amu_sweep_config_to_v1(&sweep_config, &sweep_config_v2);
+	}
+
+	return result;
+}
+
+/**
+ * @brief Reads the capabilities of the device, firmware without the capability register reports none
+ *
+ * @return int8_t 	0 on success, otherwise the error of the transport
+ */
+int8_t AMU::readCapabilities(void) {
+	return amu_capabilities_read(address, &capabilities);
+}
+
+/**
+ * @brief Whether the firmware has all of the AMU_CAP_* flags, the capabilities are read on first use
+ */
+bool AMU::hasCapability(uint32_t flags) {
+	if (capabilities.length == 0)
+		readCapabilities();
+
+	return (capabilities.flags & flags) == flags;
+}
+
+/**
+ * @brief Replaces sweep_config_v2 with sweep_config unless the two describe the same configuration
+ */
+void AMU::followSweepConfig(void) {
+	ivsweep_config_t v1;
+
+	amu_sweep_config_to_v1(&v1, &sweep_config_v2);
+
+	if ((sweep_config_v2.version != AMU_SWEEP_CONFIG_VERSION) || (memcmp(&v1, &sweep_config, sizeof(ivsweep_config_t)) != 0))
+		amu_sweep_config_from_v1(&sweep_config_v2, &sweep_config);
+}
+ivsweep_meta_t * AMU::readMeta() {
+	meta = read_twi_reg<ivsweep_meta_t>(AMU_REG_DATA_PTR_SWEEP_META);
+	if (clock_map_enabled)
+		meta.timestamp = toHostTime(meta.timestamp);
+	return &meta;
+}
 
 float AMU::readIsc() { meta.isc = read_twi_reg<float>(AMU_REG_SWEEP_META_ISC); return meta.isc; }
 float AMU::readVoc() { meta.voc = read_twi_reg<float>(AMU_REG_SWEEP_META_VOC); return meta.voc; }
@@ -178,12 +575,57 @@ quad_photo_sensor_t * AMU::readSunSensorMeasurement() { sun_sensor = read_twi_re
 
 amu_meas_t AMU::readMeasurement(void) { return read_twi_reg<amu_meas_t>(AMU_REG_TRANSFER_PTR); }
 
-uint32_t * AMU::readSweepTimestamps(uint32_t* data) { return read_twi_reg<uint32_t>(AMU_REG_DATA_PTR_TIMESTAMP, data, sizeof(uint32_t) * sweep_config.numPoints); }
+uint32_t * AMU::readSweepTimestamps(uint32_t* data) {
+	read_twi_reg<uint32_t>(AMU_REG_DATA_PTR_TIMESTAMP, data, sizeof(uint32_t) * sweep_config.numPoints);
+	if (clock_map_enabled)
+		toHostTime(data, sweep_config.numPoints);
+	return data;
+}
 float * AMU::readSweepVoltages(float* data) { return read_twi_reg<float>(AMU_REG_DATA_PTR_VOLTAGE, data, sizeof(float) * sweep_config.numPoints); }
 float * AMU::readSweepCurrents(float* data) { return read_twi_reg<float>(AMU_REG_DATA_PTR_CURRENT, data, sizeof(float) * sweep_config.numPoints); }
 float* AMU::readSweepYaws(float* data) { return read_twi_reg<float>(AMU_REG_DATA_PTR_SS_YAW, data, sizeof(float) * sweep_config.numPoints); }
 float* AMU::readSweepPitches(float* data) { return read_twi_reg<float>(AMU_REG_DATA_PTR_SS_PITCH, data, sizeof(float) * sweep_config.numPoints); }
 
+/**
+ * @brief Reads one column of a sweep of any length, by the points of getSweepConfigV2()
+ *
+ * Unlike readSweepVoltages() and the other packet readers this is not limited to 255 points, so it
+ * reads sweeps configured with writeSweepConfigV2().
+ *
+ * @param reg 			AMU_REG_DATA_PTR_TIMESTAMP to AMU_REG_DATA_PTR_SS_PITCH
+ * @param data 			room for maxPoints uint32_t timestamps or floats
+ * @param maxPoints 	size of data
+ * @return uint16_t 	points read, 0 on error
+ */
+uint16_t AMU::readSweepColumn(uint8_t reg, void* data, uint16_t maxPoints) {
+	uint16_t numPoints = (sweep_config_v2.numPoints < maxPoints) ? sweep_config_v2.numPoints : maxPoints;
+
+	if ((reg < AMU_REG_DATA_PTR_TIMESTAMP) || (reg > AMU_REG_DATA_PTR_SS_PITCH) || (numPoints == 0))
+		return 0;
+
+	if (amu_dev_transfer(address, reg, (uint8_t*)data, (size_t)numPoints * sizeof(float), AMU_TWI_TRANSFER_READ) != 0)
+		return 0;
+
+	if ((reg == AMU_REG_DATA_PTR_TIMESTAMP) && clock_map_enabled)
+		toHostTime((uint32_t*)data, numPoints);
+
+	return numPoints;
+}
+
+/**
+ * @brief Reads the voltages and currents of a sweep of any length
+ *
+ * @return uint16_t 	points read, 0 on error
+ */
+uint16_t AMU::readSweepIV(float* voltage, float* current, uint16_t maxPoints) {
+	uint16_t numPoints = readSweepColumn(AMU_REG_DATA_PTR_VOLTAGE, voltage, maxPoints);
+
+	if (numPoints == 0)
+		return 0;
+
+	return readSweepColumn(AMU_REG_DATA_PTR_CURRENT, current, numPoints);
+}
+
 
 ivsweep_packet_t* AMU::readSweepIV(ivsweep_packet_t* sweep_packet) {
 	readSweepVoltages(sweep_packet->voltage);
@@ -204,16 +646,200 @@ ivsweep_packet_t* AMU::readSweepSunAngle(ivsweep_packet_t* sweep_packet) {
 
 ivsweep_packet_t* AMU::readSweepAll(ivsweep_packet_t* sweep_packet) {
 	readSweepIV(sweep_packet);
+	if (sweep_verify_enabled)
+		verifySweep(sweep_packet);
 #ifndef __AMU_LOW_MEMORY__
 	readSweepSunAngle(sweep_packet);
 #endif
 	return (ivsweep_packet_t*)amu_dev->sweep_data;
 }
 
+/**
+ * @brief Checks the IV data in the packet against the CRC computed by the device, re-reading on a mismatch
+ *
+ * The CRC covers both arrays, so the voltages are read again first: if they come back different they
+ * were the corrupted array, otherwise the currents are read again. The result, including the number of
+ * re-reads, is available from getSweepVerifyResult().
+ *
+ * @return true if the CRC matched within the allowed number of retries
+ */
+bool AMU::verifySweep(ivsweep_packet_t* sweep_packet) {
+	uint16_t numPoints = (sweep_config.numPoints > IVSWEEP_MAX_POINTS) ? IVSWEEP_MAX_POINTS : sweep_config.numPoints;
+	size_t len = numPoints * sizeof(float);
+	float* scratch = (float*)amu_dev->transfer_reg;
+
+	sweep_verify = { false, 0, 0, read_twi_reg<uint32_t>(AMU_REG_SWEEP_META_CRC) };
+
+	for (uint8_t attempt = 0; ; attempt++) {
+		if (amu_sweep_crc32(sweep_packet, numPoints) == sweep_verify.crc) {
+			sweep_verify.verified = true;
+			break;
+		}
+
+		if (attempt >= sweep_verify_retries)
+			break;
+
+		read_twi_reg<float>(AMU_REG_DATA_PTR_VOLTAGE, scratch, len);
+
+		if (memcmp(scratch, sweep_packet->voltage, len) != 0) {
+			memcpy(sweep_packet->voltage, scratch, len);
+			sweep_verify.voltage_rereads++;
+		}
+		else {
+			readSweepCurrents(sweep_packet->current);
+			sweep_verify.current_rereads++;
+			sweep_verify.crc = read_twi_reg<uint32_t>(AMU_REG_SWEEP_META_CRC);
+		}
+	}
+
+	if (!sweep_verify.verified && AMU::errorPrintFncPtr) {
+		AMU::errorPrintFncPtr("Sweep CRC mismatch after %u voltage and %u current re-reads\n", sweep_verify.voltage_rereads, sweep_verify.current_rereads);
+	}
+
+	return sweep_verify.verified;
+}
+
+/**
+ * @brief Reads a sweep array in a compact encoding and decodes it back to floats
+ *
+ * @param reg			AMU_REG_DATA_PTR_VOLTAGE, _CURRENT, _SS_YAW or _SS_PITCH
+ * @param data			decoded array, at least IVSWEEP_MAX_POINTS long
+ * @param encoding		requested amu_sweep_encoding_t, the device falls back to a larger one when it would not save anything
+ * @return float* data
+ */
+float* AMU::readSweepEncoded(uint8_t reg, float* data, amu_sweep_encoding_t encoding) {
+	uint8_t params[2] = { reg, (uint8_t)encoding };
+	uint16_t len;
+
+	if (!data || !amu_dev || !amu_dev->transfer_reg)
+		return data;
+
+	sendCommand((CMD_t)CMD_SWEEP_ENCODE, params, sizeof(params));
+	waitUntilReady(1000);
+
+	// the length leads the header so the rest of the array can be read in one transfer
+	len = read_twi_reg<uint16_t>(AMU_REG_TRANSFER_PTR);
+
+	if ((len < sizeof(amu_sweep_enc_header_t)) || (len > AMU_TRANSFER_REG_SIZE)) {
+		if (AMU::errorPrintFncPtr) {
+			AMU::errorPrintFncPtr("Encoded sweep read failed, length: %u\n", len);
+		}
+		return data;
+	}
+
+	read_twi_reg<uint8_t>(AMU_REG_TRANSFER_PTR, (uint8_t*)amu_dev->transfer_reg, len);
+
+	if (amu_sweep_decode((const uint8_t*)amu_dev->transfer_reg, len, data, IVSWEEP_MAX_POINTS) < 0) {
+		if (AMU::errorPrintFncPtr) {
+			AMU::errorPrintFncPtr("Encoded sweep could not be decoded\n");
+		}
+	}
+
+	return data;
+}
+
+ivsweep_packet_t* AMU::readSweepIVEncoded(ivsweep_packet_t* sweep_packet, amu_sweep_encoding_t encoding) {
+	readSweepEncoded(AMU_REG_DATA_PTR_VOLTAGE, sweep_packet->voltage, encoding);
+	readSweepEncoded(AMU_REG_DATA_PTR_CURRENT, sweep_packet->current, encoding);
+	return sweep_packet;
+}
+
 void AMU::loadSweepDatapoints(uint8_t offset) {
 	sendCommand((CMD_t)CMD_SWEEP_DATAPOINT_LOAD, &offset, 1);
 }
 
+amu_sweep_status_t AMU::readSweepStatus(void) {
+	return read_twi_reg<amu_sweep_status_t>(AMU_REG_DATA_PTR_SWEEP_STATUS);
+}
+
+/**
+ * @brief Reads the voltages and currents of the last completed sweep, then acknowledges it
+ *
+ * Safe to call while the device is acquiring the next sweep into its other buffer.
+ *
+ * @return int8_t 0 on success, 1 if there is no unread sweep, negative on error
+ */
+int8_t AMU::readSweepBuffer(ivsweep_packet_t* sweep_packet) {
+	if (!sweep_packet)
+		return -1;
+
+	amu_sweep_status_t status = readSweepStatus();
+
+	if (!(status.state & AMU_SWEEP_BUF_READY))
+		return 1;
+
+	uint16_t numPoints = (status.numPoints > IVSWEEP_MAX_POINTS) ? IVSWEEP_MAX_POINTS : status.numPoints;
+
+	read_twi_reg<float>(AMU_REG_DATA_PTR_VOLTAGE, sweep_packet->voltage, sizeof(float) * numPoints);
+	read_twi_reg<float>(AMU_REG_DATA_PTR_CURRENT, sweep_packet->current, sizeof(float) * numPoints);
+
+	// a sweep completing during the read swaps the buffers, so the data may be from two sweeps
+	if (readSweepStatus().sequence != status.sequence) {
+		if (AMU::errorPrintFncPtr) {
+			AMU::errorPrintFncPtr("Sweep %u was replaced while it was being read\n", status.sequence);
+		}
+		return -2;
+	}
+
+	return write_twi_reg<uint16_t>(AMU_REG_DATA_PTR_SWEEP_STATUS, status.sequence);
+}
+
+int8_t AMU::startHistory(uint16_t channels, uint32_t period) {
+	amu_history_ctrl_t ctrl = readHistoryStatus();
+
+	ctrl.channels = channels;
+	ctrl.period = period;
+
+	// only the host owned fields at the start of the control block are written, the head belongs to the device
+	return write_twi_reg<amu_history_ctrl_t>(AMU_REG_DATA_PTR_HISTORY_CTRL, &ctrl, offsetof(amu_history_ctrl_t, head));
+}
+
+int8_t AMU::stopHistory(void) {
+	return startHistory(0, 0);
+}
+
+amu_history_ctrl_t AMU::readHistoryStatus(void) {
+	return read_twi_reg<amu_history_ctrl_t>(AMU_REG_DATA_PTR_HISTORY_CTRL);
+}
+
+uint16_t AMU::readHistory(amu_history_entry_t* entries, uint16_t maxEntries) {
+	uint16_t count = 0;
+
+	if (!entries)
+		return 0;
+
+	// the device only exposes the entries up to the end of its buffer, so a wrapped buffer takes two reads
+	while (count < maxEntries) {
+		amu_history_ctrl_t ctrl = readHistoryStatus();
+
+		if ((ctrl.size == 0) || (ctrl.tail >= ctrl.size) || (ctrl.head >= ctrl.size))
+			break;
+
+		uint16_t n = (ctrl.head >= ctrl.tail) ? (ctrl.head - ctrl.tail) : (ctrl.size - ctrl.tail);
+
+		if (n == 0)
+			break;
+
+		if (n > (maxEntries - count))
+			n = maxEntries - count;
+
+		int8_t result = amu_dev_transfer(address, AMU_REG_DATA_PTR_HISTORY, (uint8_t*)&entries[count], n * sizeof(amu_history_entry_t), AMU_TWI_TRANSFER_READ);
+		if (result != 0) {
+			if (AMU::errorPrintFncPtr) {
+				AMU::errorPrintFncPtr("History read failed with error: %d\n", result);
+			}
+			break;
+		}
+
+		count += n;
+
+		if (write_twi_reg<uint16_t>(AMU_REG_DATA_PTR_HISTORY_CTRL, (uint16_t)((ctrl.tail + n) % ctrl.size)) != 0)
+			break;
+	}
+
+	return count;
+}
+
 bool AMU::goodSunAngle(float minAngle) {
 	if ((getYaw() == NAN) || (getPitch() == NAN))		// test this?
 		return false;
@@ -234,6 +860,7 @@ float AMU::getDACgainCorrection(void) {
 
 amu_coeff_t AMU::getYawCoefficients(void) { return query<amu_coeff_t>((CMD_t)CMD_AUX_SUNSENSOR_FIT_YAW_COEFF); }
 amu_coeff_t AMU::getPitchCoefficients(void) { return query<amu_coeff_t>((CMD_t)CMD_AUX_SUNSENSOR_FIT_PITCH_COEFF); }
+amu_coeff_t AMU::getTSensorCoefficients(void) { return query<amu_coeff_t>((CMD_t)CMD_DUT_TSENSOR_FIT); }
 
 float AMU::getSSHVal(void) { return query<float>((CMD_t)CMD_AUX_SUNSENSOR_HVAL); }
 float AMU::getSSRVal(void) { return query<float>((CMD_t)CMD_AUX_SUNSENSOR_RVAL); }
@@ -280,8 +907,13 @@ int8_t AMU::sendCommand(CMD_t cmd) {
 	return amu_dev_send_command(address, cmd);
 }
 
-int8_t AMU::sendCommand(CMD_t cmd, void *params, uint8_t param_len) {
-	amu_dev_transfer(address, AMU_REG_TRANSFER_PTR, (uint8_t*)params, param_len, AMU_TWI_TRANSFER_WRITE);
+int8_t AMU::sendCommand(CMD_t cmd, void *params, uint16_t param_len) {
+	int8_t result;
+
+	// a command without its parameters would run on whatever the transfer register last held
+	if ((param_len > 0) && ((result = amu_dev_transfer(address, AMU_REG_TRANSFER_PTR, (uint8_t*)params, param_len, AMU_TWI_TRANSFER_WRITE)) != 0))
+		return result;
+
 	return sendCommand(cmd);
 }
 
@@ -363,8 +995,18 @@ T * AMU::query(CMD_t command, T *data, size_t len) {
 	return data;
 }
 
+/**
+ * @brief Queries a channel command, the channel is sent as the one byte of command data
+ *
+ * @param result 	receives 0 on success or the error of the query, NULL if not needed
+ */
 template <typename T>
-T AMU::queryChannel(CMD_t command, uint8_t channel) {
+T AMU::queryChannel(CMD_t command, uint8_t channel, int8_t* result) {
+	int8_t status;
+
+	if (result)
+		*result = -1;
+
 	if (!amu_dev || !amu_dev->transfer_reg) {
 		if (AMU::errorPrintFncPtr) {
 			AMU::errorPrintFncPtr("Error: amu_dev or transfer_reg is null\n");
@@ -374,10 +1016,13 @@ T AMU::queryChannel(CMD_t command, uint8_t channel) {
 	
 	_amu_transfer_write(0, &channel, 1);
 	
-	int8_t result = amu_dev_query_command(address, command, 0, sizeof(T));
-	if (result != 0) {
+	status = amu_dev_query_command(address, command, 1, sizeof(T));
+	if (result)
+		*result = status;
+
+	if (status != 0) {
 		if (AMU::errorPrintFncPtr) {
-			AMU::errorPrintFncPtr("Query command failed with error: %d\n", result);
+			AMU::errorPrintFncPtr("Query command failed with error: %d\n", status);
 		}
 		return T{};
 	}
@@ -6,6 +6,23 @@
 #include "amulibc/amu_device.h"
 #include "amulibc/amu_regs.h"
 #include "amulibc/amu_config_internal.h"
+#include "amulibc/amu_crc.h"
+#include "amulibc/amu_sunsensor.h"
+#include "amulibc/amu_tsensor.h"
+#include "amulibc/amu_sched.h"
+#include "amulibc/amu_timesync.h"
+#include "amulibc/amu_periodic.h"
+#include "amulibc/amu_identity.h"
+#include "amulibc/amu_sweep_config.h"
+#include "amulibc/amu_discovery.h"
+#include "amu_analytics.h"
+#include "amu_thread_pool.h"
+#include "amu_diode_fit.h"
+#include "amu_archive.h"
+#include "amu_timeseries.h"
+#include "amu_trace.h"
+#include "amu_calibration.h"
+#include "amu_stats.h"
 
 #ifdef	__AMU_USE_SCPI__
 #include "amulibc/scpi.h"
@@ -17,6 +34,24 @@
 
 #ifdef __cplusplus
 
+#ifndef AMU_ADC_CAL_CACHE_SIZE
+	#ifdef __AMU_LOW_MEMORY__
+		#define AMU_ADC_CAL_CACHE_SIZE	2
+	#else
+		#define AMU_ADC_CAL_CACHE_SIZE	8
+	#endif
+#endif
+
+/**
+ * @brief Result of the CRC check of the last sweep read by AMU::readSweepAll()
+ */
+typedef struct {
+	bool		verified;			/*!< CRC of the IV data matched ivsweep_meta_t.crc */
+	uint8_t		voltage_rereads;	/*!< number of times the voltages were read again */
+	uint8_t		current_rereads;	/*!< number of times the currents were read again */
+	uint32_t	crc;				/*!< CRC reported by the device */
+} amu_sweep_verify_t;
+
 class AMU {
 
 public:
@@ -32,15 +67,41 @@ public:
 	char*			readNotes(char* notes);
 	char*			readSerialStr(void);
 	char*			readFirmwareStr(void);
+	int8_t			readIdentity(void);
+
+	static void		setIdentityCache(bool enable) { identity_cache_enabled = enable; }
+	static const amu_identity_cache_t*	getIdentityCache(void);
+	static bool		loadIdentityCache(const void* data, size_t len);
+	static void		clearIdentityCache(void);
+
+	int8_t			readCapabilities(void);
+	bool			hasCapability(uint32_t flags);
+	const amu_capabilities_t*	getCapabilities(void) { return &capabilities; }
 
 	int8_t			setActiveChannels(uint16_t channels);
 	int8_t			setTimeStamp(uint32_t timestamp);
+	static int8_t	broadcastTimeStamp(uint32_t timestamp);
+
+	int8_t			sampleClock(void);
+	void			resetClockModel(void) { amu_timesync_reset(&clock_sync); clock_epoch_seen = clock_epoch; }
+	uint32_t		toHostTime(uint32_t device_ms);
+	uint32_t *		toHostTime(uint32_t* timestamps, uint16_t count);
+	void			setClockMapping(bool enable) { clock_map_enabled = enable; }
+	const amu_timesync_t * getClockModel(void) { return &clock_sync; }
 
 	int8_t			setLEDcolor(float red, float grn, float blu);
 	int8_t			setLEDmode(amu_led_pattern_t mode);
 
 	uint8_t			getPGA(AMU_ADC_CH_t channel);
 
+	int8_t			loadADCCalibration(bool reload = false);
+	int8_t			readADCRaw(adc_channels_t* raw);
+	int8_t			readADCChannels(float* values);
+	const amu_adc_cal_t*	getADCCalibration(void);
+
+	static void		convertADCRaw(const amu_adc_cal_t* cal, const adc_channels_t* raw, float* values);
+	static void		clearADCCalibrationCache(void);
+
 	float			measureVoltage(void);
 	float			measureCurrent(void);
 	float			measureTSensor(void);
@@ -74,6 +135,8 @@ public:
 
 
 	ivsweep_config_t *		readSweepConfig(void);
+	ivsweep_config_v2_t *	readSweepConfigV2(void);
+	int8_t					writeSweepConfigV2(const ivsweep_config_v2_t* config);
 	ivsweep_meta_t *		readMeta(void);
 	float					readIsc(void);
 	float					readVoc(void);
@@ -89,11 +152,29 @@ public:
 	ivsweep_packet_t *	readSweepIV(ivsweep_packet_t*);
 	ivsweep_packet_t *	readSweepSunAngle(ivsweep_packet_t*);
 	ivsweep_packet_t *	readSweepAll(ivsweep_packet_t*);
+	bool				verifySweep(ivsweep_packet_t*);
+	void				setSweepVerify(bool enable, uint8_t maxRetries = 2) { sweep_verify_enabled = enable; sweep_verify_retries = maxRetries; }
+	amu_sweep_verify_t	getSweepVerifyResult(void) { return sweep_verify; }
+	float *				readSweepEncoded(uint8_t reg, float* data, amu_sweep_encoding_t encoding);
+	ivsweep_packet_t *	readSweepIVEncoded(ivsweep_packet_t*, amu_sweep_encoding_t encoding);
+	uint16_t			readSweepColumn(uint8_t reg, void* data, uint16_t maxPoints);
+	uint16_t			readSweepIV(float* voltage, float* current, uint16_t maxPoints);
 
 	void			loadSweepDatapoints(uint8_t offset);
 
+	amu_sweep_status_t	readSweepStatus(void);
+	int8_t				readSweepBuffer(ivsweep_packet_t* sweep_packet);
+
+	int8_t				startHistory(uint16_t channels, uint32_t period);
+	int8_t				stopHistory(void);
+	amu_history_ctrl_t	readHistoryStatus(void);
+	uint16_t			readHistory(amu_history_entry_t* entries, uint16_t maxEntries);
+
 	uint8_t			getAddress(void) { return address; }
 
+	bool					isOnline(void) { return amu_link_is_online(address); }
+	const amu_link_state_t*	getLinkState(void) { return amu_link_get_state(address); }
+
 	amu_dut_t*		getDUT(void) { return &dut; }
 	char *			getDutManufacturer(void) { return dut.manufacturer; }
 	char*			getDutModel(void) { return dut.model; }
@@ -109,6 +190,8 @@ public:
 	char*			getSerialNumber(void) { return serial_number; }
 
 	ivsweep_config_t *	getSweepConfig(void) { return &sweep_config; }
+	ivsweep_config_v2_t *	getSweepConfigV2(void) { return &sweep_config_v2; }
+	uint16_t			getSweepPoints(void) { return sweep_config_v2.numPoints; }
 	ivsweep_meta_t *	getMetaData(void) { return &meta; }
 
 	float			getDACgainCorrection(void);
@@ -126,6 +209,7 @@ public:
 
 	amu_coeff_t		getYawCoefficients(void);
 	amu_coeff_t		getPitchCoefficients(void);
+	amu_coeff_t		getTSensorCoefficients(void);
 	float			getSSHVal(void);
 	float			getSSRVal(void);
 
@@ -158,6 +242,9 @@ public:
 public:
 
 	static void setErrorPrintFunction(errorPrintFncPtr_t fptr) { errorPrintFncPtr = fptr; }
+	static void	setMaxTransferLength(uint16_t len) { amu_device.max_transfer_len = len; }
+	static void	setRetryPolicy(amu_retry_policy_t policy) { memcpy((void*)&amu_device.retry, &policy, sizeof(amu_retry_policy_t)); }
+	static void	setBusRecoveryFuncPtr(amu_bus_recover_fptr_t fptr) { amu_device.bus_recover = fptr; }
 	static void	setAMUResetFuncPtr(resetFncPtr_t fptr) { amuResetFncPtr = fptr; }
 	static void	setEYASResetFuncPtr(resetFncPtr_t fptr) { eyasResetFncPtr = fptr; }
 
@@ -175,14 +262,32 @@ protected:
 	amu_dut_t dut;
 
 	ivsweep_config_t sweep_config;
+	ivsweep_config_v2_t sweep_config_v2 = {};		// the finer view of sweep_config, kept unless sweep_config disagrees with it
 	ivsweep_meta_t meta;
 
+	amu_capabilities_t capabilities = {};			// length is 0 until read
+
 	quad_photo_sensor_t sun_sensor;
 
+	int8_t adc_cal_entry = -1;		// index into the ADC coefficient cache, checked against serial_number on use
+
+	static bool		identity_cache_enabled;			// begin() skips the full identity read of devices whose block CRC is unchanged
+
+	amu_timesync_t	clock_sync = {};
+	bool			clock_map_enabled = false;		// map sweep and meta timestamps to host time as they are read
+	uint16_t		clock_epoch_seen = 0;			// clock_epoch when clock_sync was last reset
+	static uint16_t	clock_epoch;					// incremented by every broadcastTimeStamp()
+
+	bool				sweep_verify_enabled = false;
+	uint8_t				sweep_verify_retries = 2;
+	amu_sweep_verify_t	sweep_verify = { false, 0, 0, 0 };
+
 	uint8_t		busy(void);
 
+	void		followSweepConfig(void);
+
 	int8_t		sendCommand(CMD_t cmd);
-	int8_t		sendCommand(CMD_t cmd, void* params, uint8_t param_len);
+	int8_t		sendCommand(CMD_t cmd, void* params, uint16_t param_len);
 	int8_t		sendCommandandWait(CMD_t cmd, uint32_t wait);
 
 	template <typename T>
@@ -195,7 +300,7 @@ protected:
 	T * query(CMD_t command, T *data, size_t len);
 
 	template <typename T>
-	T queryChannel(CMD_t command, uint8_t channel);
+	T queryChannel(CMD_t command, uint8_t channel, int8_t* result = NULL);
 
 	template <typename T>
 	T read_twi_reg(uint8_t reg);
@@ -631,6 +631,15 @@ typedef enum {
 	 *  `SWEEP:DATApoint:LOAD`
 	 */
 	CMD_SWEEP_DATAPOINT_LOAD =				CMD_SWEEP_OFFSET + 0x0C,
+
+	/** @brief Encodes a sweep array into the transfer register
+	 *  @details Transfer register holds the AMU_REG_DATA_PTR array register and the requested amu_sweep_encoding_t,
+	 *  the encoded array (amu_sweep_enc_header_t followed by the data) is then read from AMU_REG_TRANSFER_PTR
+	 *  @return Encoded sweep array
+	 *  @par SCPI Equivalent:
+	 *  None, binary data
+	 */
+	CMD_SWEEP_ENCODE =						CMD_SWEEP_OFFSET + 0x0D,
 } CMD_SWEEP_t;
 #undef CMD_SWEEP_OFFSET
 
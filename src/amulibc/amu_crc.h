@@ -0,0 +1,33 @@
+/**
+ * @file amu_crc.h
+ * @brief CRC-32 used to verify sweep data
+ *
+ * Standard CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320, as used by zlib). Uses the ARMv8 CRC32
+ * instructions when available, slicing-by-8 tables otherwise, and a 16 entry nibble table under
+ * __AMU_LOW_MEMORY__ so the 8K of tables is not pulled into small parts.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_CRC_H__
+#define __AMU_CRC_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	uint32_t	amu_crc32_update(uint32_t crc, const void* data, size_t len);
+	uint32_t	amu_sweep_crc32(const ivsweep_packet_t* sweep_packet, uint16_t numPoints);
+
+	static inline uint32_t amu_crc32(const void* data, size_t len) { return amu_crc32_update(0, data, len); }
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_CRC_H__ */
@@ -13,6 +13,12 @@
 #include "amu_types.h"
 #include "amu_regs.h"
 #include "amu_commands.h"
+#include "amu_history.h"
+#include "amu_sweep_buffer.h"
+#include "amu_sweep_encode.h"
+#include "amu_identity.h"
+#include "amu_sweep_config.h"
+#include "amu_link.h"
 
 #ifdef __AMU_USE_SCPI__
 #include "scpi.h"
@@ -23,6 +29,8 @@ static uint8_t amu_device_addresses[AMU_MAX_CONNECTED_DEVICES];
 static volatile uint8_t amu_transfer_reg[AMU_TRANSFER_REG_SIZE];
 static uint16_t transfer_reg_data_len = 0;
 
+static size_t _amu_dev_max_chunk(uint8_t rw);
+
 #ifdef __AMU_DEVICE__
 static uint8_t amu_num_devices = 1;
 
@@ -33,6 +41,10 @@ char dev_serialNumber_str[AMU_SERIALNUM_STR_LEN] = AMU_SERIALNUM_DEFAULT_STR;
 char dev_firmware_str[AMU_FIRMWARE_STR_LEN] = AMU_FIRMWARE_DEFAULT_STR;
 
 
+static volatile amu_ext_addr_t amu_ext_addr = { .reg = 0, .offset = 0 };
+
+static amu_data_reg_t* _amu_get_ext_data_ptr(void);
+
 #else
 static uint8_t amu_num_devices = 0;
 #endif
@@ -43,10 +55,20 @@ volatile amu_device_t amu_device = {
 	.amu_regs = NULL,
 
 	.transfer = NULL,
+	.max_transfer_len = 0,
+	.retry = {
+		.max_retries = AMU_LINK_DEFAULT_RETRIES,
+		.backoff_ms = AMU_LINK_DEFAULT_BACKOFF_MS,
+		.breaker_threshold = AMU_LINK_DEFAULT_BREAKER_THRESHOLD,
+		.reserved = 0,
+		.breaker_cooldown_ms = AMU_LINK_DEFAULT_COOLDOWN_MS,
+	},
+	.bus_recover = NULL,
 	.delay = NULL,
 	.watchdog_kick = NULL,
 	.hardware_reset = NULL,
 	.millis = NULL,
+	.measure_channel = NULL,
 	.process_cmd = NULL,
 };
 
@@ -95,14 +117,77 @@ volatile amu_device_t* amu_dev_init(amu_transfer_fptr_t transfer_ptr) {
  * @return int8_t
  */
 int8_t amu_dev_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t rw) {
-	return amu_device.transfer(address, reg, data, len, rw);
+	size_t chunk = _amu_dev_max_chunk(rw);
+
+	if ((chunk == 0) || (len <= chunk) || (reg == AMU_REG_DATA_PTR_EXT_DATA))
+		return amu_link_transfer(address, reg, data, len, rw);
+	else
+		return amu_dev_transfer_ext(address, reg, 0, data, len, rw);
+}
+
+/**
+ * @brief Largest number of data bytes in one transaction, the register byte is sent with the data on writes
+ *
+ * @param rw 		AMU_TWI_TRANSFER_READ or AMU_TWI_TRANSFER_WRITE
+ * @return size_t 	0 if the transport has no limit or it is too small to chunk through the extended registers
+ */
+static size_t _amu_dev_max_chunk(uint8_t rw) {
+	size_t max = amu_device.max_transfer_len;
+
+	if (max <= sizeof(amu_ext_addr_t))
+		return 0;
+
+	return (rw == AMU_TWI_TRANSFER_WRITE) ? (max - 1) : max;
+}
+
+/**
+ * @brief Transfers any part of a register through AMU_REG_DATA_PTR_EXT_ADDR/EXT_DATA
+ *
+ * Each chunk selects the register and offset, then moves up to max_transfer_len bytes through the
+ * data window, so blocks larger than the transport buffer (or 255 bytes) move in one call and
+ * registers past 0xFF can be reached.
+ *
+ * @param address 	TWI address of the device
+ * @param reg 		16-bit register address
+ * @param offset 	byte offset into the register
+ * @param data 		data to read or write
+ * @param len 		number of bytes
+ * @param rw 		AMU_TWI_TRANSFER_READ or AMU_TWI_TRANSFER_WRITE
+ * @return int8_t 	0 on success, otherwise the first error returned by the transport
+ */
+int8_t amu_dev_transfer_ext(uint8_t address, uint16_t reg, uint16_t offset, uint8_t* data, size_t len, uint8_t rw) {
+	size_t chunk = _amu_dev_max_chunk(rw);
+	amu_ext_addr_t ext;
+	int8_t result;
+
+	if ((chunk == 0) || (chunk > len))
+		chunk = len;
+
+	do {
+		size_t n = (len < chunk) ? len : chunk;
+
+		ext.reg = reg;
+		ext.offset = offset;
+
+		if ((result = amu_link_transfer(address, AMU_REG_DATA_PTR_EXT_ADDR, (uint8_t*)&ext, sizeof(amu_ext_addr_t), AMU_TWI_TRANSFER_WRITE)) != 0)
+			return result;
+
+		if ((result = amu_link_transfer(address, AMU_REG_DATA_PTR_EXT_DATA, data, n, rw)) != 0)
+			return result;
+
+		data += n;
+		offset += n;
+		len -= n;
+	} while (len > 0);
+
+	return 0;
 }
 
 /**
  * @brief Checks to see if the AMU device is busy
  *
  * @param address 	TODO
- * @return uint8_t 	1 is busy, 0 otherwise
+ * @return uint8_t 	1 is busy, 0 otherwise or if the device could not be read
  */
 uint8_t amu_dev_busy(uint8_t address) {
 // #ifdef __AMU_DEVICE__
@@ -110,7 +195,8 @@ uint8_t amu_dev_busy(uint8_t address) {
 // 	return amu_device.amu_regs->twi_status;
 // #else
 	uint8_t cmd;
-	amu_dev_transfer(address, (uint8_t)AMU_REG_CMD, &cmd, sizeof(uint8_t), AMU_TWI_TRANSFER_READ);
+	if (amu_dev_transfer(address, (uint8_t)AMU_REG_CMD, &cmd, sizeof(uint8_t), AMU_TWI_TRANSFER_READ) != 0)
+		return 0;
 	return cmd;
 // #endif
 }
@@ -132,11 +218,13 @@ int8_t amu_dev_send_command(uint8_t address, CMD_t command) {
  * @param address 	TODO
  * @param command 	Command for the device
  * @param len 		Length of TODO
- * @return int8_t TODO
+ * @return int8_t 	0 on success, the command is not sent if writing the transfer register failed
  */
-int8_t amu_dev_send_command_data(uint8_t address, CMD_t command, uint8_t len) {
-	if (len > 0)
-		amu_dev_transfer(address, (uint8_t)AMU_REG_TRANSFER_PTR, (uint8_t*)amu_transfer_reg, len, AMU_TWI_TRANSFER_WRITE);
+int8_t amu_dev_send_command_data(uint8_t address, CMD_t command, uint16_t len) {
+	int8_t result;
+
+	if ((len > 0) && ((result = amu_dev_transfer(address, (uint8_t)AMU_REG_TRANSFER_PTR, (uint8_t*)amu_transfer_reg, len, AMU_TWI_TRANSFER_WRITE)) != 0))
+		return result;
 	return amu_dev_send_command(address, command);
 }
 
@@ -149,11 +237,13 @@ int8_t amu_dev_send_command_data(uint8_t address, CMD_t command, uint8_t len) {
  * @param responseLength 	TODO
  * @return int8_t
  */
-int8_t amu_dev_query_command(uint8_t address, CMD_t command, uint8_t commandDataLen, uint8_t responseLength) {
+int8_t amu_dev_query_command(uint8_t address, CMD_t command, uint16_t commandDataLen, uint16_t responseLength) {
 	
 	uint8_t repeat = 0;
+	int8_t result;
 
-	amu_dev_send_command_data(address, (command | CMD_READ), commandDataLen);
+	if ((result = amu_dev_send_command_data(address, (command | CMD_READ), commandDataLen)) != 0)
+		return result;
 
 	do {
 		if (amu_device.delay)
@@ -192,7 +282,8 @@ uint8_t amu_scan_for_devices(uint8_t startAddress, uint8_t endAddress) {
 		if (i == AMU_TWI_ALLCALL_ADDRESS)
 			continue;
 		else {
-			if (amu_dev_transfer(i, 0, NULL, 0, AMU_TWI_TRANSFER_READ) == 0) {
+			if (amu_device.transfer(i, 0, NULL, 0, AMU_TWI_TRANSFER_READ) == 0) {		// probe once, without retries
+				amu_link_reset(i);
 				amu_device_addresses[amu_num_devices] = i;
 				amu_num_devices = amu_num_devices + 1;
 				if (amu_num_devices == AMU_MAX_CONNECTED_DEVICES) {
@@ -207,6 +298,33 @@ uint8_t amu_scan_for_devices(uint8_t startAddress, uint8_t endAddress) {
 	return amu_num_devices;
 }
 
+/**
+ * @brief Replaces the device table with addresses found by other means, i.e. amu_discovery_publish()
+ *
+ * @param addresses 	TWI addresses of the devices, in the order they are numbered
+ * @param num 			number of addresses
+ * @return uint8_t 	Number of devices, including this device if __AMU_DEVICE__ is defined
+ */
+uint8_t amu_set_device_addresses(const uint8_t* addresses, uint8_t num) {
+
+#ifdef __AMU_DEVICE__
+	amu_num_devices = 1;
+	amu_device_addresses[0] = AMU_THIS_DEVICE;
+#else
+	amu_num_devices = 0;
+#endif
+
+	for (uint8_t i = 0; (i < num) && (amu_num_devices < AMU_MAX_CONNECTED_DEVICES - 1); i++) {
+		amu_link_reset(addresses[i]);
+		amu_device_addresses[amu_num_devices] = addresses[i];
+		amu_num_devices = amu_num_devices + 1;
+	}
+
+	amu_device_addresses[amu_num_devices] = AMU_NO_ADDRESS_MATCH;		//termination
+
+	return amu_num_devices;
+}
+
 int8_t amu_get_num_devices() {
 	return amu_num_devices;
 }
@@ -237,11 +355,12 @@ uint8_t amu_get_device_address(uint8_t deviceNum) {
  * @param cmd 			TODO
  * @param transferLen 	TODO
  * @param query 		TODO
- * @return uint8_t TODO
+ * @return uint8_t 	true if the command was routed, false if there is no such device or the transfer to it failed
  */
 uint8_t _amu_route_command(uint8_t deviceNum, CMD_t cmd, size_t  transferLen, bool query) {
 
 	uint8_t twi_address;
+	int8_t result = 0;
 
 	if (cmd == (CMD_t)CMD_SYSTEM_NO_CMD)
 		return 0;
@@ -258,21 +377,23 @@ uint8_t _amu_route_command(uint8_t deviceNum, CMD_t cmd, size_t  transferLen, bo
 
 			if (cmd >= CMD_I2C_USB) {
 				if (cmd & CMD_READ) {
-					amu_dev_query_command(twi_address, (uint8_t)cmd, 1, transferLen);
+					result = amu_dev_query_command(twi_address, (uint8_t)cmd, 1, transferLen);
 				}
 				else {
-					amu_dev_send_command_data(twi_address, (uint8_t)cmd, transferLen);
+					result = amu_dev_send_command_data(twi_address, (uint8_t)cmd, transferLen);
 				}
 			}
 			else {
 				if (query) {
 					memset((void *)amu_transfer_reg, 0x00, transferLen);			//clear transfer reg to zeros before new data is read in.
-					amu_dev_transfer(twi_address, (uint8_t)cmd, (uint8_t*)amu_transfer_reg, transferLen, AMU_TWI_TRANSFER_READ);
+					result = amu_dev_transfer(twi_address, (uint8_t)cmd, (uint8_t*)amu_transfer_reg, transferLen, AMU_TWI_TRANSFER_READ);
 				}
 				else
-					amu_dev_transfer(twi_address, (uint8_t)cmd, (uint8_t*)amu_transfer_reg, transferLen, AMU_TWI_TRANSFER_WRITE);
+					result = amu_dev_transfer(twi_address, (uint8_t)cmd, (uint8_t*)amu_transfer_reg, transferLen, AMU_TWI_TRANSFER_WRITE);
 			}
 		}
+		else
+			return false;
 	}
 	else {
 		if (cmd >= CMD_I2C_USB) {
@@ -293,7 +414,7 @@ uint8_t _amu_route_command(uint8_t deviceNum, CMD_t cmd, size_t  transferLen, bo
 		}
 	}
 
-	return true;
+	return (result == 0);
 }
 
 
@@ -328,6 +449,15 @@ void _amu_transfer_write(size_t offset, void* data, size_t len) {
 	
 }
 
+/**
+ * @brief Sets the length of data in the transfer register after it was written in place
+ *
+ * @param len 		number of valid bytes at the start of the transfer register
+ */
+void _amu_transfer_set_length(size_t len) {
+	transfer_reg_data_len = (len < AMU_TRANSFER_REG_SIZE) ? len : AMU_TRANSFER_REG_SIZE;
+}
+
 volatile uint8_t* amu_dev_get_transfer_reg_ptr(void) { return amu_transfer_reg; }
 	
 amu_data_reg_t* amu_get_register_ptr(uint8_t reg) {
@@ -406,16 +536,33 @@ amu_data_reg_t* amu_get_register_ptr(uint8_t reg) {
         case AMU_REG_SWEEP_META_TIMESTAMP:            return (amu_data_reg_t*)&amu_device.amu_regs->meta.timestamp;                 break;
         case AMU_REG_SWEEP_META_CRC:                  return (amu_data_reg_t*)&amu_device.amu_regs->meta.crc;                        break;
 
+#ifdef __AMU_DEVICE__
+        case AMU_REG_DATA_PTR_TIMESTAMP:
+        case AMU_REG_DATA_PTR_VOLTAGE:
+        case AMU_REG_DATA_PTR_CURRENT:
+        case AMU_REG_DATA_PTR_SS_YAW:
+        case AMU_REG_DATA_PTR_SS_PITCH:     return (amu_data_reg_t*)amu_sweep_get_column_ptr(reg);                        break;
+#else
         case AMU_REG_DATA_PTR_TIMESTAMP:    return (amu_data_reg_t*)amu_device.sweep_data->timestamp;               break;
         case AMU_REG_DATA_PTR_VOLTAGE:      return (amu_data_reg_t*)amu_device.sweep_data->voltage;                 break;
         case AMU_REG_DATA_PTR_CURRENT:      return (amu_data_reg_t*)amu_device.sweep_data->current;                 break;
+#ifndef __AMU_LOW_MEMORY__
         case AMU_REG_DATA_PTR_SS_YAW:       return (amu_data_reg_t*)amu_device.sweep_data->yaw;                     break;
         case AMU_REG_DATA_PTR_SS_PITCH:     return (amu_data_reg_t*)amu_device.sweep_data->pitch;                   break;
+#endif
+#endif
 
         case AMU_REG_DATA_PTR_SWEEP_CONFIG: return (amu_data_reg_t*)&amu_device.amu_regs->sweep_config;                       break;
         case AMU_REG_DATA_PTR_SWEEP_META:   return (amu_data_reg_t*)&amu_device.amu_regs->meta;                               break;
         case AMU_REG_DATA_PTR_SUNSENSOR:    return (amu_data_reg_t*)&amu_device.amu_regs->ss_angle;                           break;
         case AMU_REG_DATA_PTR_PRESSURE:     return (amu_data_reg_t*)&amu_device.amu_regs->adc_raw.val.ss_tl;             break;	// assume request is for quad_photo_sensor_t includeing 4 raw values, not just yaw/pitch
+#ifdef __AMU_DEVICE__
+        case AMU_REG_DATA_PTR_HISTORY_CTRL: return (amu_data_reg_t*)amu_history_get_ctrl_ptr();                          break;
+        case AMU_REG_DATA_PTR_HISTORY:      return (amu_data_reg_t*)amu_history_get_tail_ptr();                          break;
+        case AMU_REG_DATA_PTR_SWEEP_STATUS: return (amu_data_reg_t*)amu_sweep_get_status_ptr();                          break;
+        case AMU_REG_DATA_PTR_EXT_ADDR:     return (amu_data_reg_t*)&amu_ext_addr;                                         break;
+        case AMU_REG_DATA_PTR_EXT_DATA:     return _amu_get_ext_data_ptr();                                                break;
+#endif
         case AMU_REG_TRANSFER_PTR:          return (amu_data_reg_t*)amu_device.transfer_reg;							break;
 
 		default:                            return NULL;                                                                 break;
@@ -455,10 +602,83 @@ uint16_t amu_reg_get_length(uint8_t reg) {
 	if(reg == AMU_REG_TRANSFER_PTR) {
 		return transfer_reg_data_len;
 	}
+	else if (reg == AMU_REG_DATA_PTR_HISTORY) {
+		return amu_history_readable() * sizeof(amu_history_entry_t);
+	}
+	else if (reg == AMU_REG_DATA_PTR_EXT_DATA) {
+		uint16_t len = amu_ext_reg_get_length(amu_ext_addr.reg);
+		return (amu_ext_addr.offset < len) ? (len - amu_ext_addr.offset) : 0;
+	}
 	else {
 		return amu_regs_get_register_length(reg);
 	}
 	
 }
 
-#endif
\ No newline at end of file
+/**
+ * @brief Pointer to a register by its 16-bit extended address
+ *
+ * Addresses below 0x100 are the regular registers, except for the extended address registers
+ * themselves.
+ *
+ * @param reg 		extended register address
+ * @return amu_data_reg_t* NULL if the register does not exist
+ */
+amu_data_reg_t* amu_get_ext_register_ptr(uint16_t reg) {
+
+	switch (reg) {
+		case AMU_REG_DATA_PTR_EXT_ADDR:
+		case AMU_REG_DATA_PTR_EXT_DATA:		return NULL;		break;
+		case AMU_REG_EXT_IDENTITY:			return (amu_data_reg_t*)amu_identity_get_ptr();		break;
+		case AMU_REG_EXT_CAPABILITIES:		return (amu_data_reg_t*)amu_capabilities_get_ptr();	break;
+		case AMU_REG_EXT_SWEEP_CONFIG_V2:	return (amu_data_reg_t*)amu_sweep_config_get_v2_ptr();	break;
+		case AMU_REG_EXT_ADC_RAW:			return (amu_data_reg_t*)&amu_device.amu_regs->adc_raw;	break;
+
+		default:
+			if (reg <= 0xFF)
+				return amu_get_register_ptr((uint8_t)reg);
+			else
+				return NULL;
+			break;
+	}
+}
+
+/**
+ * @brief Length of a register by its 16-bit extended address
+ *
+ * The transfer register can be written in full through the extended window, so its length is its
+ * size rather than the length of the last response.
+ *
+ * @param reg 		extended register address
+ * @return uint16_t 0 if the register does not exist
+ */
+uint16_t amu_ext_reg_get_length(uint16_t reg) {
+
+	switch (reg) {
+		case AMU_REG_DATA_PTR_EXT_ADDR:
+		case AMU_REG_DATA_PTR_EXT_DATA:		return 0;										break;
+		case AMU_REG_TRANSFER_PTR:			return AMU_TRANSFER_REG_SIZE;					break;
+		case AMU_REG_EXT_IDENTITY:			return sizeof(amu_identity_t);					break;
+		case AMU_REG_EXT_CAPABILITIES:		return sizeof(amu_capabilities_t);				break;
+		case AMU_REG_EXT_SWEEP_CONFIG_V2:	return sizeof(ivsweep_config_v2_t);				break;
+		case AMU_REG_EXT_ADC_RAW:			return sizeof(adc_channels_t);					break;
+
+		default:
+			if (reg <= 0xFF)
+				return amu_reg_get_length((uint8_t)reg);
+			else
+				return 0;
+			break;
+	}
+}
+
+static amu_data_reg_t* _amu_get_ext_data_ptr(void) {
+	amu_data_reg_t* ptr = amu_get_ext_register_ptr(amu_ext_addr.reg);
+
+	if ((ptr == NULL) || (amu_ext_addr.offset >= amu_ext_reg_get_length(amu_ext_addr.reg)))
+		return NULL;
+
+	return ptr + amu_ext_addr.offset;
+}
+
+#endif
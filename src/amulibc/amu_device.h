@@ -11,6 +11,10 @@
 
 #include "amu_commands.h"
 #include "amu_types.h"
+#include "amu_history.h"
+#include "amu_sweep_buffer.h"
+#include "amu_sweep_encode.h"
+#include "amu_link.h"
 #include "amu_config_internal.h"
 
 #define AMU_TWI_DEFAULT_ADDRESS			0x0F
@@ -49,16 +53,18 @@ extern "C" {
 	volatile amu_device_t* 		amu_dev_init(amu_transfer_fptr_t);
 
 	int8_t						amu_dev_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t rw);
+	int8_t						amu_dev_transfer_ext(uint8_t address, uint16_t reg, uint16_t offset, uint8_t* data, size_t len, uint8_t rw);
 	uint8_t						amu_dev_busy(uint8_t address);
 
 	int8_t						amu_dev_send_command(uint8_t address, CMD_t command);
-	int8_t						amu_dev_send_command_data(uint8_t address, CMD_t command, uint8_t len);
-	int8_t						amu_dev_query_command(uint8_t address, CMD_t command, uint8_t commandDataLen, uint8_t responseLength);
+	int8_t						amu_dev_send_command_data(uint8_t address, CMD_t command, uint16_t len);
+	int8_t						amu_dev_query_command(uint8_t address, CMD_t command, uint16_t commandDataLen, uint16_t responseLength);
 
 	static inline CMD_t			amu_get_next_twi_command(void) { return (CMD_t)(amu_device.amu_regs->command + CMD_I2C_USB); }
 	static inline void			amu_command_complete(void) { amu_device.amu_regs->command = 0;}
 
 	uint8_t						amu_scan_for_devices(uint8_t startAddress, uint8_t endAddress);
+	uint8_t						amu_set_device_addresses(const uint8_t* addresses, uint8_t num);
 	int8_t						amu_get_num_devices(void);
 	int8_t						amu_get_num_connected_devices(void);
 	uint8_t						amu_get_device_address(uint8_t deviceNum);
@@ -67,6 +73,7 @@ extern "C" {
 
 	void						_amu_transfer_read(size_t offset, void *data, size_t len);
 	void						_amu_transfer_write(size_t offset, void *data, size_t len);
+	void						_amu_transfer_set_length(size_t len);
 
 	volatile uint8_t*			amu_dev_get_transfer_reg_ptr(void);
 
@@ -90,6 +97,9 @@ extern "C" {
 
 	uint16_t 					amu_reg_get_length(uint8_t reg);
 
+	amu_data_reg_t*				amu_get_ext_register_ptr(uint16_t reg);
+	uint16_t					amu_ext_reg_get_length(uint16_t reg);
+
 
 #endif
 
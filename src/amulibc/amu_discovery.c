@@ -0,0 +1,267 @@
+/**
+ * @file amu_discovery.c
+ * @brief Bus discovery with identity fingerprints and incremental rescans
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_discovery.h"
+#include "amu_identity.h"
+#include "amu_regs.h"
+#include "amu_crc.h"
+
+static inline bool _amu_discovery_probe(amu_discovery_t* discovery, uint8_t address) {
+	discovery->probes++;
+	return discovery->transfer(address, 0, NULL, 0, AMU_TWI_TRANSFER_READ) == 0;		// probe once, without retries
+}
+
+static inline void _amu_discovery_notify(amu_discovery_t* discovery, const amu_discovery_entry_t* entry, uint8_t event) {
+	if (discovery->on_change)
+		discovery->on_change(discovery, entry, event);
+}
+
+/**
+ * @brief Reads the identity block of a device through the transport of the bus
+ *
+ * The block moves in chunks of amu_device.max_transfer_len like amu_dev_transfer_ext(), without
+ * the retries of the link layer.
+ *
+ * @return int8_t 		0 if the block checks out, otherwise the error of the transport or amu_identity_check()
+ */
+static int8_t _amu_discovery_read_identity(amu_discovery_t* discovery, uint8_t address, amu_identity_t* identity) {
+	amu_ext_addr_t ext = { (uint16_t)AMU_REG_EXT_IDENTITY, 0 };
+	size_t chunk = amu_device.max_transfer_len;
+	int8_t result;
+
+	if ((chunk <= sizeof(amu_ext_addr_t)) || (chunk > sizeof(amu_identity_t)))
+		chunk = sizeof(amu_identity_t);
+
+	while (ext.offset < sizeof(amu_identity_t)) {
+		size_t n = sizeof(amu_identity_t) - ext.offset;
+
+		if (n > chunk)
+			n = chunk;
+
+		discovery->probes += 2;
+
+		if ((result = discovery->transfer(address, (uint8_t)AMU_REG_DATA_PTR_EXT_ADDR, (uint8_t*)&ext, sizeof(amu_ext_addr_t), AMU_TWI_TRANSFER_WRITE)) != 0)
+			return result;
+
+		if ((result = discovery->transfer(address, (uint8_t)AMU_REG_DATA_PTR_EXT_DATA, (uint8_t*)identity + ext.offset, n, AMU_TWI_TRANSFER_READ)) != 0)
+			return result;
+
+		ext.offset += (uint16_t)n;
+	}
+
+	return amu_identity_check(identity);
+}
+
+/**
+ * @brief Reads the serial number and hardware revision of a device into entry
+ *
+ * Both come from the identity block, which is only used if its version, length and CRC check out,
+ * so firmware without one cannot pass whatever its extended window returns off as a serial number.
+ */
+static void _amu_discovery_fingerprint(amu_discovery_t* discovery, amu_discovery_entry_t* entry) {
+	amu_identity_t identity;
+
+	memset(&identity, 0, sizeof(amu_identity_t));
+
+	if (_amu_discovery_read_identity(discovery, entry->address, &identity) == 0) {
+		memcpy(entry->serial, identity.serial, AMU_SERIALNUM_STR_LEN);
+		entry->serial[AMU_SERIALNUM_STR_LEN - 1] = 0;
+		entry->hardware_revision = identity.hardware_revision;
+		entry->has_serial = 1;
+	}
+	else {
+		// no identity block, the hardware revision register is all there is without a command query
+		memset(entry->serial, 0, AMU_SERIALNUM_STR_LEN);
+		entry->has_serial = 0;
+		discovery->probes++;
+		if (discovery->transfer(entry->address, (uint8_t)AMU_REG_SYSTEM_HARDWARE_REVISION, &entry->hardware_revision, sizeof(uint8_t), AMU_TWI_TRANSFER_READ) != 0)
+			entry->hardware_revision = 0;
+	}
+
+	entry->fingerprint = amu_crc32_update(amu_crc32(entry->serial, AMU_SERIALNUM_STR_LEN), &entry->hardware_revision, sizeof(uint8_t));
+}
+
+static void _amu_discovery_add(amu_discovery_t* discovery, uint8_t address) {
+	amu_discovery_entry_t* entry;
+
+	if (discovery->num >= AMU_MAX_CONNECTED_DEVICES)
+		return;
+
+	entry = &discovery->entry[discovery->num++];
+	memset(entry, 0, sizeof(amu_discovery_entry_t));
+	entry->address = address;
+
+	_amu_discovery_fingerprint(discovery, entry);
+	_amu_discovery_notify(discovery, entry, AMU_DISCOVERY_ADDED);
+}
+
+static void _amu_discovery_remove(amu_discovery_t* discovery, uint8_t index) {
+	amu_discovery_entry_t removed = discovery->entry[index];
+
+	discovery->entry[index] = discovery->entry[--discovery->num];
+	_amu_discovery_notify(discovery, &removed, AMU_DISCOVERY_REMOVED);
+}
+
+/**
+ * @brief Probes a known device, removing it after AMU_DISCOVERY_MISSES failed probes in a row
+ *
+ * @return bool 	true if the device is still in the list at index
+ */
+static bool _amu_discovery_check(amu_discovery_t* discovery, uint8_t index) {
+	amu_discovery_entry_t* entry = &discovery->entry[index];
+
+	if (_amu_discovery_probe(discovery, entry->address)) {
+		entry->misses = 0;
+		return true;
+	}
+
+	if (++entry->misses < AMU_DISCOVERY_MISSES)
+		return true;
+
+	_amu_discovery_remove(discovery, index);
+	return false;
+}
+
+/**
+ * @brief Initializes the discovery of one bus with no known devices
+ *
+ * @param discovery 	state of the bus
+ * @param transfer 		transport of the bus
+ * @param first 		first address to probe, i.e. AMU_DISCOVERY_FIRST_ADDRESS
+ * @param last 			first address past the range, i.e. AMU_DISCOVERY_LAST_ADDRESS
+ */
+void amu_discovery_init(amu_discovery_t* discovery, amu_transfer_fptr_t transfer, uint8_t first, uint8_t last) {
+	memset(discovery, 0, sizeof(amu_discovery_t));
+
+	discovery->transfer = transfer;
+	discovery->first = first;
+	discovery->last = (last > 0x80) ? 0x80 : last;
+	discovery->cursor = first;
+}
+
+/**
+ * @brief Probes the known devices, then every other address of the range, and fingerprints them all
+ *
+ * @param discovery 	state of the bus
+ * @return uint8_t 		devices present
+ */
+uint8_t amu_discovery_scan(amu_discovery_t* discovery) {
+	uint8_t probed[16];
+
+	memset(probed, 0, sizeof(probed));
+
+	for (uint8_t i = 0; i < discovery->num; ) {
+		amu_discovery_entry_t* entry = &discovery->entry[i];
+		uint32_t fingerprint = entry->fingerprint;
+
+		probed[(entry->address >> 3) & 0x0F] |= (uint8_t)(1 << (entry->address & 0x07));
+
+		if (!_amu_discovery_check(discovery, i))
+			continue;
+
+		if (entry->misses == 0) {
+			_amu_discovery_fingerprint(discovery, entry);
+			if (entry->fingerprint != fingerprint)
+				_amu_discovery_notify(discovery, entry, AMU_DISCOVERY_CHANGED);
+		}
+		i++;
+	}
+
+	for (uint8_t address = discovery->first; address < discovery->last; address++) {
+		if ((address == AMU_TWI_ALLCALL_ADDRESS) || (probed[address >> 3] & (1 << (address & 0x07))))
+			continue;
+
+		if (_amu_discovery_probe(discovery, address))
+			_amu_discovery_add(discovery, address);
+	}
+
+	discovery->cursor = discovery->first;
+
+	return discovery->num;
+}
+
+/**
+ * @brief Probes the known devices and the next window addresses of the range, without fingerprinting known devices
+ *
+ * Calling it with a window of a few addresses from a periodic task covers the whole range over
+ * several calls while every call stays short. A window of (last - first) covers it at once.
+ *
+ * @param discovery 	state of the bus
+ * @param window 		unknown addresses to probe, 0 to only check the known devices
+ * @return uint8_t 		devices added or removed
+ */
+uint8_t amu_discovery_rescan(amu_discovery_t* discovery, uint8_t window) {
+	uint8_t range = discovery->last - discovery->first;
+	uint8_t changes = 0;
+
+	for (uint8_t i = 0; i < discovery->num; ) {
+		if (_amu_discovery_check(discovery, i))
+			i++;
+		else
+			changes++;
+	}
+
+	if (window > range)
+		window = range;
+
+	for (uint8_t n = 0; n < window; n++) {
+		uint8_t address = discovery->cursor;
+
+		if ((address < discovery->first) || (address >= discovery->last))
+			address = discovery->first;
+		discovery->cursor = address + 1;
+		if (discovery->cursor >= discovery->last)
+			discovery->cursor = discovery->first;
+
+		if ((address == AMU_TWI_ALLCALL_ADDRESS) || amu_discovery_find(discovery, address))
+			continue;
+
+		if (_amu_discovery_probe(discovery, address)) {
+			_amu_discovery_add(discovery, address);
+			changes++;
+		}
+	}
+
+	return changes;
+}
+
+/**
+ * @brief The entry of a device present at address, NULL if there is none
+ */
+const amu_discovery_entry_t* amu_discovery_find(const amu_discovery_t* discovery, uint8_t address) {
+	for (uint8_t i = 0; i < discovery->num; i++) {
+		if (discovery->entry[i].address == address)
+			return &discovery->entry[i];
+	}
+	return NULL;
+}
+
+/**
+ * @brief Makes the devices of this bus the device table used by amu_get_device_address() and command routing
+ *
+ * Only for the bus of amu_device.transfer. Devices are numbered in address order, as by
+ * amu_scan_for_devices().
+ *
+ * @param discovery 	state of the bus
+ * @return uint8_t 		number of devices, including this device if __AMU_DEVICE__ is defined
+ */
+uint8_t amu_discovery_publish(const amu_discovery_t* discovery) {
+	uint8_t addresses[AMU_MAX_CONNECTED_DEVICES];
+	uint8_t num = discovery->num;
+
+	for (uint8_t i = 0; i < num; i++) {
+		uint8_t address = discovery->entry[i].address;
+		uint8_t j = i;
+
+		for (; (j > 0) && (addresses[j - 1] > address); j--)
+			addresses[j] = addresses[j - 1];
+		addresses[j] = address;
+	}
+
+	return amu_set_device_addresses(addresses, num);
+}
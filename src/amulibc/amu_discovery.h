@@ -0,0 +1,85 @@
+/**
+ * @file amu_discovery.h
+ * @brief Bus discovery with identity fingerprints and incremental rescans
+ *
+ * An amu_discovery_t tracks the devices on one bus through its own transfer function. A full scan
+ * probes the devices it already knows first, then the rest of the address range, and reads the
+ * identity block of every new device in the same pass through the AMU_REG_EXT_IDENTITY window. The
+ * serial number and hardware revision are taken from the block once its version, length and CRC
+ * check out. Firmware without the identity block only reports its hardware revision.
+ *
+ * A rescan probes the known devices and a window of the other addresses, continuing from where the
+ * last rescan stopped, and reports only the devices that were added or removed, so a hot-plug check
+ * costs one empty transaction per device. A device answering on a known address with a different
+ * fingerprint is reported as changed by a full scan.
+ *
+ * The state of each bus is separate and nothing global is touched until amu_discovery_publish(),
+ * so several buses can be scanned at the same time, one thread each.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_DISCOVERY_H__
+#define __AMU_DISCOVERY_H__
+
+#include "amu_device.h"
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_DISCOVERY_FIRST_ADDRESS		0x08
+#define AMU_DISCOVERY_LAST_ADDRESS		0x78			// first address past the range
+
+#ifndef AMU_DISCOVERY_MISSES
+#define AMU_DISCOVERY_MISSES			1				// failed probes in a row before a device is removed
+#endif
+
+typedef enum {
+	AMU_DISCOVERY_ADDED = 1,
+	AMU_DISCOVERY_REMOVED = 2,
+	AMU_DISCOVERY_CHANGED = 3,			/*!< Same address, different serial number or hardware revision */
+} amu_discovery_event_t;
+
+typedef struct {
+	uint8_t address;
+	uint8_t misses;						/*!< Failed probes in a row */
+	uint8_t hardware_revision;			/*!< amu_hardware_revision_t */
+	uint8_t has_serial;					/*!< serial was read from the identity block */
+	uint32_t fingerprint;				/*!< CRC-32 of serial and hardware_revision */
+	char serial[AMU_SERIALNUM_STR_LEN];
+} amu_discovery_entry_t;
+
+typedef struct amu_discovery_s amu_discovery_t;
+
+typedef void (*amu_discovery_cb_t)(amu_discovery_t* discovery, const amu_discovery_entry_t* entry, uint8_t event);
+
+struct amu_discovery_s {
+	amu_transfer_fptr_t transfer;		/*!< Transport of this bus */
+	amu_discovery_cb_t on_change;		/*!< Called for every amu_discovery_event_t, may be NULL */
+	void* ctx;							/*!< For the callback */
+	uint8_t first;						/*!< First address probed */
+	uint8_t last;						/*!< First address past the range */
+	uint8_t cursor;						/*!< Next unknown address probed by a rescan */
+	uint8_t num;						/*!< Devices present */
+	uint32_t probes;					/*!< Transactions made, probes and fingerprint reads */
+	amu_discovery_entry_t entry[AMU_MAX_CONNECTED_DEVICES];
+};
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	void		amu_discovery_init(amu_discovery_t* discovery, amu_transfer_fptr_t transfer, uint8_t first, uint8_t last);
+
+	uint8_t		amu_discovery_scan(amu_discovery_t* discovery);
+	uint8_t		amu_discovery_rescan(amu_discovery_t* discovery, uint8_t window);
+
+	const amu_discovery_entry_t*	amu_discovery_find(const amu_discovery_t* discovery, uint8_t address);
+	uint8_t		amu_discovery_publish(const amu_discovery_t* discovery);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_DISCOVERY_H__ */
@@ -0,0 +1,159 @@
+/**
+ * @file amu_history.c
+ * @brief On-device measurement history ring buffer
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_history.h"
+#include "amu_device.h"
+
+#ifdef __AMU_DEVICE__
+
+static volatile amu_history_entry_t amu_history[AMU_HISTORY_SIZE];
+
+static volatile amu_history_ctrl_t amu_history_ctrl = {
+	.tail = 0,
+	.channels = 0,
+	.period = 0,
+	.head = 0,
+	.size = AMU_HISTORY_SIZE,
+	.overflows = 0,
+	.reserved = 0,
+};
+
+static uint32_t amu_history_next_acquisition = 0;
+
+/**
+ * @brief Returns the tail index, the tail is written by the host so anything outside of the buffer empties it
+ *
+ * @return uint16_t tail index
+ */
+static inline uint16_t _amu_history_tail(void) {
+	uint16_t tail = amu_history_ctrl.tail;
+
+	if (tail >= AMU_HISTORY_SIZE) {
+		tail = amu_history_ctrl.head;
+		amu_history_ctrl.tail = tail;
+	}
+
+	return tail;
+}
+
+volatile amu_history_ctrl_t* amu_history_get_ctrl_ptr(void) {
+	amu_history_ctrl.size = AMU_HISTORY_SIZE;
+	return &amu_history_ctrl;
+}
+
+volatile amu_history_entry_t* amu_history_get_tail_ptr(void) {
+	return &amu_history[_amu_history_tail()];
+}
+
+/**
+ * @brief Discards all unread entries and resets the overflow count
+ */
+void amu_history_clear(void) {
+	amu_history_ctrl.tail = amu_history_ctrl.head;
+	amu_history_ctrl.overflows = 0;
+}
+
+/**
+ * @brief Number of unread entries in the history buffer
+ *
+ * @return uint16_t number of entries between the tail and the head
+ */
+uint16_t amu_history_count(void) {
+	uint16_t head = amu_history_ctrl.head;
+	uint16_t tail = _amu_history_tail();
+
+	return (head >= tail) ? (head - tail) : (AMU_HISTORY_SIZE - tail + head);
+}
+
+/**
+ * @brief Number of unread entries that can be read in one transfer starting at the tail
+ *
+ * Entries that wrap around the end of the buffer are returned by the next read once the
+ * host has moved the tail.
+ *
+ * @return uint16_t number of contiguous entries starting at the tail
+ */
+uint16_t amu_history_readable(void) {
+	uint16_t head = amu_history_ctrl.head;
+	uint16_t tail = _amu_history_tail();
+
+	return (head >= tail) ? (head - tail) : (AMU_HISTORY_SIZE - tail);
+}
+
+/**
+ * @brief Adds a measurement to the history buffer
+ *
+ * @param timestamp		device milliseconds at time of measurement
+ * @param channel		amu_adc_ch_t channel that was measured
+ * @param meas			measurement and DUT temperature
+ * @return true if the entry was stored, false if the buffer is full
+ */
+bool amu_history_push(uint32_t timestamp, uint8_t channel, amu_meas_t meas) {
+	uint16_t head = amu_history_ctrl.head;
+	uint16_t next = (head + 1) % AMU_HISTORY_SIZE;
+
+	if (next == _amu_history_tail()) {
+		if (amu_history_ctrl.overflows < UINT16_MAX)
+			amu_history_ctrl.overflows++;
+		return false;
+	}
+
+	amu_history[head].timestamp = timestamp;
+	amu_history[head].channel = channel;
+	amu_history[head].meas.measurement = meas.measurement;
+	amu_history[head].meas.temperature = meas.temperature;
+
+	amu_history_ctrl.head = next;		// publish the entry only once it is complete
+
+	return true;
+}
+
+/**
+ * @brief Periodic acquisition, call from the main loop
+ *
+ * When the acquisition period set by the host has elapsed, every channel in the channel
+ * mask is measured through amu_device.measure_channel and pushed along with the DUT
+ * temperature. The next acquisition is scheduled from the previous one so the period
+ * does not drift with loop latency.
+ *
+ * @return uint8_t number of entries pushed
+ */
+uint8_t amu_history_update(void) {
+	uint32_t now;
+	uint32_t period = amu_history_ctrl.period;
+	uint16_t channels = amu_history_ctrl.channels;
+	uint8_t pushed = 0;
+	amu_meas_t meas;
+
+	if ((period == 0) || (channels == 0) || !amu_device.millis || !amu_device.measure_channel)
+		return 0;
+
+	now = amu_device.millis();
+
+	if ((int32_t)(now - amu_history_next_acquisition) < 0)
+		return 0;
+
+	amu_history_next_acquisition += period;
+
+	if ((int32_t)(now - amu_history_next_acquisition) >= 0)		// more than a period behind, or acquisition just enabled
+		amu_history_next_acquisition = now + period;
+
+	meas.temperature = amu_device.measure_channel(AMU_ADC_CH_TSENSOR0);
+
+	for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++) {
+		if (channels & (1 << ch)) {
+			meas.measurement = (ch == AMU_ADC_CH_TSENSOR0) ? meas.temperature : amu_device.measure_channel(ch);
+			if (amu_history_push(now, ch, meas))
+				pushed++;
+		}
+	}
+
+	return pushed;
+}
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * @file amu_history.h
+ * @brief On-device measurement history ring buffer
+ *
+ * Timestamped measurements are pushed by the device into a fixed ring buffer and
+ * drained by the host in bulk through AMU_REG_DATA_PTR_HISTORY_CTRL and
+ * AMU_REG_DATA_PTR_HISTORY. The device only ever moves the head and the host only
+ * ever moves the tail, so a full buffer drops new entries (counted in overflows)
+ * rather than overwriting entries the host has not read yet.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_HISTORY_H__
+#define __AMU_HISTORY_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#ifdef __AMU_DEVICE__
+
+	volatile amu_history_ctrl_t*	amu_history_get_ctrl_ptr(void);
+	volatile amu_history_entry_t*	amu_history_get_tail_ptr(void);
+
+	void							amu_history_clear(void);
+	uint16_t						amu_history_count(void);
+	uint16_t						amu_history_readable(void);
+
+	bool							amu_history_push(uint32_t timestamp, uint8_t channel, amu_meas_t meas);
+	uint8_t							amu_history_update(void);
+
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_HISTORY_H__ */
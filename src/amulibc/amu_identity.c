@@ -0,0 +1,214 @@
+/**
+ * @file amu_identity.c
+ * @brief Identity and configuration of a device in one block, with a host cache checked by CRC
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_identity.h"
+#include "amu_regs.h"
+#include "amu_crc.h"
+
+#define AMU_IDENTITY_BODY_LEN	(sizeof(amu_identity_t) - sizeof(amu_identity_header_t))
+
+static inline uint32_t _amu_identity_crc(const amu_identity_t* identity) {
+	return amu_crc32((const uint8_t*)identity + sizeof(amu_identity_header_t), AMU_IDENTITY_BODY_LEN);
+}
+
+static amu_identity_entry_t* _amu_identity_find(amu_identity_cache_t* cache, uint8_t address) {
+	for (uint16_t i = 0; i < cache->num; i++) {
+		if (cache->entry[i].valid && (cache->entry[i].address == address))
+			return &cache->entry[i];
+	}
+	return NULL;
+}
+
+static void _amu_identity_store(amu_identity_cache_t* cache, uint8_t address, const amu_identity_t* identity) {
+	amu_identity_entry_t* entry = _amu_identity_find(cache, address);
+
+	if (!entry) {
+		for (uint16_t i = 0; i < cache->num; i++) {
+			if (!cache->entry[i].valid) {
+				entry = &cache->entry[i];
+				break;
+			}
+		}
+	}
+
+	if (!entry) {
+		if (cache->num < AMU_IDENTITY_CACHE_SIZE)
+			entry = &cache->entry[cache->num++];
+		else {
+			entry = &cache->entry[cache->next];
+			cache->next = (cache->next + 1) % AMU_IDENTITY_CACHE_SIZE;
+		}
+	}
+
+	entry->address = address;
+	entry->valid = 1;
+	memcpy(&entry->identity, identity, sizeof(amu_identity_t));
+}
+
+/**
+ * @brief Checks that a block read from a device is an identity block of this version and matches its CRC
+ *
+ * @param identity 		block read
+ * @return int8_t 		0 if the block can be used, AMU_IDENTITY_ERROR_UNSUPPORTED if it is not an identity block
+ * 						of this version, i.e. the firmware has none, AMU_IDENTITY_ERROR_CRC if it was damaged
+ */
+int8_t amu_identity_check(const amu_identity_t* identity) {
+	if ((identity->header.version != AMU_IDENTITY_VERSION) || (identity->header.length != sizeof(amu_identity_t)))
+		return AMU_IDENTITY_ERROR_UNSUPPORTED;
+
+	if (identity->header.crc != _amu_identity_crc(identity))
+		return AMU_IDENTITY_ERROR_CRC;
+
+	return 0;
+}
+
+/**
+ * @brief Empties a cache
+ *
+ * @param cache 		cache
+ */
+void amu_identity_cache_init(amu_identity_cache_t* cache) {
+	memset(cache, 0, sizeof(amu_identity_cache_t));
+
+	cache->version = AMU_IDENTITY_VERSION;
+	cache->size = sizeof(amu_identity_cache_t);
+}
+
+/**
+ * @brief Restores a cache saved as sizeof(amu_identity_cache_t) bytes, e.g. from a file
+ *
+ * Every entry is checked against its CRC, so a damaged entry is dropped rather than used. Devices
+ * that changed since the cache was saved are read again by amu_identity_read().
+ *
+ * @param cache 		cache to fill
+ * @param data 			saved cache
+ * @param len 			bytes in data
+ * @return bool 		false if data is not a cache of this version and size, the cache is then empty
+ */
+bool amu_identity_cache_load(amu_identity_cache_t* cache, const void* data, size_t len) {
+	const amu_identity_cache_t* saved = (const amu_identity_cache_t*)data;
+
+	if (!data || (len != sizeof(amu_identity_cache_t)) || (saved->version != AMU_IDENTITY_VERSION) ||
+		(saved->size != sizeof(amu_identity_cache_t)) || (saved->num > AMU_IDENTITY_CACHE_SIZE)) {
+		amu_identity_cache_init(cache);
+		return false;
+	}
+
+	if (cache != saved)
+		memcpy(cache, saved, sizeof(amu_identity_cache_t));
+
+	cache->next %= AMU_IDENTITY_CACHE_SIZE;
+	cache->hits = 0;
+	cache->misses = 0;
+
+	for (uint16_t i = 0; i < cache->num; i++) {
+		if (amu_identity_check(&cache->entry[i].identity) != 0)
+			cache->entry[i].valid = 0;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Drops the entry of a device, its next read is a full read
+ */
+void amu_identity_cache_remove(amu_identity_cache_t* cache, uint8_t address) {
+	amu_identity_entry_t* entry = _amu_identity_find(cache, address);
+
+	if (entry)
+		entry->valid = 0;
+}
+
+/**
+ * @brief Reads the identity block of a device, from the cache if the device has not changed
+ *
+ * With a cached entry for the address only the block header is read, and the cached block is
+ * returned if its length and CRC still match. Otherwise the whole block is read in one extended
+ * transfer, checked against its CRC and stored in the cache.
+ *
+ * @param address 		TWI address of the device
+ * @param cache 		host cache, NULL to always read the whole block
+ * @param identity 		receives the block
+ * @return int8_t 		0 if read from the device, 1 if the cached block was used, AMU_IDENTITY_ERROR_UNSUPPORTED
+ * 						or AMU_IDENTITY_ERROR_CRC if the block cannot be used, otherwise the error of the transport
+ */
+int8_t amu_identity_read(uint8_t address, amu_identity_cache_t* cache, amu_identity_t* identity) {
+	amu_identity_entry_t* entry = NULL;
+	int8_t result;
+
+	if (cache) {
+		if ((cache->version != AMU_IDENTITY_VERSION) || (cache->size != sizeof(amu_identity_cache_t)))
+			amu_identity_cache_init(cache);
+
+		entry = _amu_identity_find(cache, address);
+	}
+
+	if (entry) {
+		amu_identity_header_t header;
+
+		if ((result = amu_dev_transfer_ext(address, (uint16_t)AMU_REG_EXT_IDENTITY, 0, (uint8_t*)&header, sizeof(amu_identity_header_t), AMU_TWI_TRANSFER_READ)) != 0)
+			return result;
+
+		if ((header.version == entry->identity.header.version) && (header.length == entry->identity.header.length) &&
+			(header.crc == entry->identity.header.crc)) {
+			memcpy(identity, &entry->identity, sizeof(amu_identity_t));
+			cache->hits++;
+			return 1;
+		}
+
+		entry->valid = 0;
+	}
+
+	if ((result = amu_dev_transfer_ext(address, (uint16_t)AMU_REG_EXT_IDENTITY, 0, (uint8_t*)identity, sizeof(amu_identity_t), AMU_TWI_TRANSFER_READ)) != 0)
+		return result;
+
+	if ((result = amu_identity_check(identity)) != 0)
+		return result;
+
+	if (cache) {
+		_amu_identity_store(cache, address, identity);
+		cache->misses++;
+	}
+
+	return 0;
+}
+
+#ifdef __AMU_DEVICE__
+
+static amu_identity_t amu_identity;
+
+/**
+ * @brief The identity block of this device, rebuilt from the current registers on every access
+ *
+ * Called when AMU_REG_EXT_IDENTITY is selected through the extended window, so the block and its
+ * CRC always describe the configuration at the time of the read.
+ *
+ * @return amu_identity_t*
+ */
+amu_identity_t* amu_identity_get_ptr(void) {
+
+	memset(&amu_identity, 0, sizeof(amu_identity_t));
+
+	amu_identity.header.version = AMU_IDENTITY_VERSION;
+	amu_identity.header.length = sizeof(amu_identity_t);
+
+	memcpy(amu_identity.firmware, dev_firmware_str, AMU_FIRMWARE_STR_LEN);
+	memcpy(amu_identity.serial, dev_serialNumber_str, AMU_SERIALNUM_STR_LEN);
+
+	if (amu_device.amu_regs) {
+		amu_identity.hardware_revision = amu_device.amu_regs->hardware_revision;
+		memcpy(&amu_identity.sweep_config, (const void*)&amu_device.amu_regs->sweep_config, sizeof(ivsweep_config_t));
+		memcpy(&amu_identity.dut, (const void*)&amu_device.amu_regs->dut, sizeof(amu_dut_t));
+	}
+
+	amu_identity.header.crc = _amu_identity_crc(&amu_identity);
+
+	return &amu_identity;
+}
+
+#endif
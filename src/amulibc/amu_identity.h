@@ -0,0 +1,93 @@
+/**
+ * @file amu_identity.h
+ * @brief Identity and configuration of a device in one block, with a host cache checked by CRC
+ *
+ * The firmware string, serial number, hardware revision, sweep configuration and DUT description
+ * are exposed together as the extended register AMU_REG_EXT_IDENTITY, so a host reads them in one
+ * transfer instead of two command queries and three register reads. The block starts with a
+ * version, its length and a CRC-32 of the rest.
+ *
+ * The host keeps the blocks it has read in an amu_identity_cache_t keyed by address. When a device
+ * is already in the cache only the 8 byte header is read, and the cached block is used if its CRC
+ * is unchanged. The CRC covers the serial number, so a different device answering on the same
+ * address misses. The cache is plain data and can be saved to a file or flash between runs and
+ * restored with amu_identity_cache_load().
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_IDENTITY_H__
+#define __AMU_IDENTITY_H__
+
+#include "amu_device.h"
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_IDENTITY_VERSION			1
+
+#ifndef AMU_IDENTITY_CACHE_SIZE
+	#ifdef __AMU_LOW_MEMORY__
+		#define AMU_IDENTITY_CACHE_SIZE	4
+	#else
+		#define AMU_IDENTITY_CACHE_SIZE	AMU_MAX_CONNECTED_DEVICES
+	#endif
+#endif
+
+#define AMU_IDENTITY_ERROR_UNSUPPORTED	(-13)		/*!< Device has no identity block of this version */
+#define AMU_IDENTITY_ERROR_CRC			(-14)		/*!< Block read did not match its CRC */
+
+typedef struct {
+	uint16_t version;				/*!< AMU_IDENTITY_VERSION, anything else means the block cannot be used */
+	uint16_t length;				/*!< sizeof(amu_identity_t) */
+	uint32_t crc;					/*!< CRC-32 of the block after the header */
+} amu_identity_header_t;
+
+typedef struct {
+	amu_identity_header_t header;
+	char firmware[AMU_FIRMWARE_STR_LEN];
+	char serial[AMU_SERIALNUM_STR_LEN];
+	uint8_t hardware_revision;		/*!< amu_hardware_revision_t */
+	uint8_t reserved;
+	ivsweep_config_t sweep_config;
+	amu_dut_t dut;
+} amu_identity_t;
+
+typedef struct {
+	uint8_t address;
+	uint8_t valid;
+	uint16_t reserved;
+	amu_identity_t identity;
+} amu_identity_entry_t;
+
+typedef struct {
+	uint16_t version;				/*!< AMU_IDENTITY_VERSION of the library that filled the cache */
+	uint16_t size;					/*!< sizeof(amu_identity_cache_t), a cache saved by another build is discarded */
+	uint16_t num;					/*!< Entries in use */
+	uint16_t next;					/*!< Entry replaced next when the cache is full */
+	uint32_t hits;					/*!< Reads answered from the cache */
+	uint32_t misses;				/*!< Reads of the full block */
+	amu_identity_entry_t entry[AMU_IDENTITY_CACHE_SIZE];
+} amu_identity_cache_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	void				amu_identity_cache_init(amu_identity_cache_t* cache);
+	bool				amu_identity_cache_load(amu_identity_cache_t* cache, const void* data, size_t len);
+	void				amu_identity_cache_remove(amu_identity_cache_t* cache, uint8_t address);
+
+	int8_t				amu_identity_read(uint8_t address, amu_identity_cache_t* cache, amu_identity_t* identity);
+	int8_t				amu_identity_check(const amu_identity_t* identity);
+
+#ifdef __AMU_DEVICE__
+	amu_identity_t*		amu_identity_get_ptr(void);
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_IDENTITY_H__ */
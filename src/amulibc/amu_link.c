@@ -0,0 +1,204 @@
+/**
+ * @file amu_link.c
+ * @brief Per-device transaction retry and circuit breaker
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_link.h"
+#include "amu_device.h"
+#include "amu_regs.h"
+
+static amu_link_state_t amu_link_states[AMU_MAX_CONNECTED_DEVICES];
+static uint8_t amu_link_count = 0;
+
+/**
+ * @brief Finds the link state of a device, adding it the first time it is seen
+ *
+ * @param address 	TWI address of the device
+ * @param add 		add the device if it is not in the table yet
+ * @return amu_link_state_t* 	NULL if the device is not in the table, or the table is full, transfers to the device are then not tracked
+ */
+static amu_link_state_t* _amu_link_find(uint8_t address, bool add) {
+	for (uint8_t i = 0; i < amu_link_count; i++) {
+		if (amu_link_states[i].address == address)
+			return &amu_link_states[i];
+	}
+
+	if (!add || (amu_link_count >= AMU_MAX_CONNECTED_DEVICES))
+		return NULL;
+
+	memset(&amu_link_states[amu_link_count], 0, sizeof(amu_link_state_t));
+	amu_link_states[amu_link_count].address = address;
+
+	return &amu_link_states[amu_link_count++];
+}
+
+static inline void _amu_link_count(uint16_t* counter) {
+	if (*counter < UINT16_MAX)
+		(*counter)++;
+}
+
+/**
+ * @brief Checks whether a transfer to the device is allowed, moving an offline device to half open once its cooldown expired
+ *
+ * @param state 	link state of the device
+ * @return true if the transfer should be attempted
+ */
+static bool _amu_link_allow(amu_link_state_t* state) {
+	if (state->breaker != AMU_LINK_OPEN)
+		return true;
+
+	if (amu_device.millis && ((int32_t)(amu_device.millis() - state->open_until) >= 0)) {
+		state->breaker = AMU_LINK_HALF_OPEN;
+		return true;
+	}
+
+	_amu_link_count(&state->rejected);
+	return false;
+}
+
+/**
+ * @brief Updates the breaker with the final result of a transfer
+ *
+ * A failed trial transfer while half open takes the device straight back offline. The breaker
+ * needs amu_device.millis to time the cooldown, without it devices are never taken offline.
+ *
+ * @param state 	link state of the device
+ * @param result 	result of the transfer after all retries
+ */
+static void _amu_link_record(amu_link_state_t* state, int8_t result) {
+	uint8_t threshold = amu_device.retry.breaker_threshold;
+
+	if (result == 0) {
+		state->failures = 0;
+		state->breaker = AMU_LINK_CLOSED;
+		return;
+	}
+
+	_amu_link_count(&state->errors);
+
+	if (state->failures < UINT8_MAX)
+		state->failures++;
+
+	if (amu_device.millis && (threshold > 0) && ((state->breaker == AMU_LINK_HALF_OPEN) || (state->failures >= threshold))) {
+		state->breaker = AMU_LINK_OPEN;
+		state->open_until = amu_device.millis() + amu_device.retry.breaker_cooldown_ms;
+	}
+}
+
+/**
+ * @brief Checks whether a transfer can be repeated without side effects
+ *
+ * A write to AMU_REG_CMD executes the command. If only its acknowledgement was lost, a retry would
+ * run it a second time, i.e. trigger a second sweep or set the clock again.
+ */
+static inline bool _amu_link_idempotent(uint8_t reg, uint8_t rw) {
+	return (rw == AMU_TWI_TRANSFER_READ) || (reg != (uint8_t)AMU_REG_CMD);
+}
+
+/**
+ * @brief Transfers to a remote device with retries, bus recovery and the circuit breaker
+ *
+ * Reads and register writes are retried, command writes are attempted once and a failure is
+ * returned to the caller, which knows whether the command is safe to send again.
+ *
+ * @param address 	TWI address of the device
+ * @param reg 		register to read or write
+ * @param data 		data to read or write
+ * @param len 		number of bytes
+ * @param rw 		AMU_TWI_TRANSFER_READ or AMU_TWI_TRANSFER_WRITE
+ * @return int8_t 	0 on success, AMU_LINK_ERROR_OFFLINE if the device is offline, otherwise the last error returned by the transport
+ */
+int8_t amu_link_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t rw) {
+	amu_link_state_t* state = _amu_link_find(address, true);
+	uint8_t retries = amu_device.retry.max_retries;
+	uint32_t backoff = amu_device.retry.backoff_ms;
+	int8_t result;
+
+	if (state != NULL) {
+		if (!_amu_link_allow(state))
+			return AMU_LINK_ERROR_OFFLINE;
+		if (state->breaker == AMU_LINK_HALF_OPEN)
+			retries = 0;							// a single trial, don't spend retries on a device that is likely still gone
+	}
+
+	if (!_amu_link_idempotent(reg, rw))
+		retries = 0;
+
+	result = amu_device.transfer(address, reg, data, len, rw);
+
+	for (uint8_t attempt = 0; (result != 0) && (attempt < retries); attempt++) {
+
+		if ((attempt == 0) && amu_device.bus_recover) {
+			amu_device.bus_recover(address);
+			if (state != NULL)
+				_amu_link_count(&state->recoveries);
+		}
+
+		if (amu_device.watchdog_kick)
+			amu_device.watchdog_kick();
+
+		if (amu_device.delay && (backoff > 0)) {
+			amu_device.delay(backoff);
+			backoff <<= 1;
+		}
+
+		if (state != NULL)
+			_amu_link_count(&state->retries);
+
+		result = amu_device.transfer(address, reg, data, len, rw);
+	}
+
+	if (state != NULL)
+		_amu_link_record(state, result);
+
+	return result;
+}
+
+/**
+ * @brief Link statistics of a device, the retry and error totals show how much of the bus time the device is costing
+ *
+ * @param address 	TWI address of the device
+ * @return const amu_link_state_t* 	NULL if nothing has been transferred to the device yet
+ */
+const amu_link_state_t* amu_link_get_state(uint8_t address) {
+	return _amu_link_find(address, false);
+}
+
+/**
+ * @brief Checks whether the device is online, a device in half open state is reported online
+ *
+ * @param address 	TWI address of the device
+ * @return true if transfers to the device are allowed
+ */
+bool amu_link_is_online(uint8_t address) {
+	amu_link_state_t* state = _amu_link_find(address, false);
+
+	if ((state == NULL) || (state->breaker != AMU_LINK_OPEN))
+		return true;
+
+	return amu_device.millis && ((int32_t)(amu_device.millis() - state->open_until) >= 0);
+}
+
+/**
+ * @brief Brings a device back online and clears its statistics, used when it answers a scan
+ *
+ * @param address 	TWI address of the device
+ */
+void amu_link_reset(uint8_t address) {
+	amu_link_state_t* state = _amu_link_find(address, false);
+
+	if (state != NULL) {
+		memset(state, 0, sizeof(amu_link_state_t));
+		state->address = address;
+	}
+}
+
+/**
+ * @brief Brings every device back online and clears all statistics
+ */
+void amu_link_reset_all(void) {
+	amu_link_count = 0;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file amu_link.h
+ * @brief Per-device transaction retry and circuit breaker
+ *
+ * Every transfer to a remote device goes through amu_link_transfer(). A failed read or register
+ * write calls amu_device.bus_recover once and is retried with an exponential backoff as set by
+ * amu_device.retry. Command writes are not retried, as a command whose acknowledgement was lost has
+ * already run. A device that keeps failing is taken offline for a cooldown period, during
+ * which its transfers fail immediately with AMU_LINK_ERROR_OFFLINE instead of spending retries
+ * on it, so one dead device does not stall transfers to the rest of the bus.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_LINK_H__
+#define __AMU_LINK_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_LINK_ERROR_OFFLINE				(-10)
+
+#define AMU_LINK_DEFAULT_RETRIES			2
+#define AMU_LINK_DEFAULT_BACKOFF_MS			2
+#define AMU_LINK_DEFAULT_BREAKER_THRESHOLD	3
+#define AMU_LINK_DEFAULT_COOLDOWN_MS		1000
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	int8_t						amu_link_transfer(uint8_t address, uint8_t reg, uint8_t* data, size_t len, uint8_t rw);
+
+	const amu_link_state_t*		amu_link_get_state(uint8_t address);
+	bool						amu_link_is_online(uint8_t address);
+	void						amu_link_reset(uint8_t address);
+	void						amu_link_reset_all(void);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_LINK_H__ */
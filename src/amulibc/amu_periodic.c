@@ -0,0 +1,328 @@
+/**
+ * @file amu_periodic.c
+ * @brief Cooperative multi-rate scheduler for periodic channel measurements
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_periodic.h"
+#include "amu_regs.h"
+
+static inline bool _amu_periodic_reached(uint32_t time, uint32_t now) {
+	return (int32_t)(now - time) >= 0;
+}
+
+static inline uint32_t _amu_periodic_now(const amu_periodic_t* periodic) {
+	if (periodic->ops.millis)
+		return periodic->ops.millis();
+	return amu_device.millis ? amu_device.millis() : 0;
+}
+
+static amu_periodic_mask_t* _amu_periodic_mask(amu_periodic_t* periodic, uint8_t address) {
+	amu_periodic_mask_t* free_slot = NULL;
+
+	for (uint8_t i = 0; i < AMU_MAX_CONNECTED_DEVICES; i++) {
+		amu_periodic_mask_t* mask = &periodic->mask[i];
+
+		if (mask->valid && (mask->address == address))
+			return mask;
+		if (!mask->valid && !free_slot)
+			free_slot = mask;
+	}
+
+	return free_slot ? free_slot : &periodic->mask[address % AMU_MAX_CONNECTED_DEVICES];
+}
+
+/**
+ * @brief Default measure, sets the active channels of the device if they changed and queries them in one command
+ *
+ * Blocks in amu_dev_query_command() until the device has converted the channels.
+ */
+static int8_t _amu_periodic_measure(amu_periodic_t* periodic, uint8_t address, uint16_t channels, float* values) {
+	amu_periodic_mask_t* mask = _amu_periodic_mask(periodic, address);
+	const uint8_t* reg = (const uint8_t*)amu_dev_get_transfer_reg_ptr();
+	uint8_t n = 0;
+	int8_t result;
+
+	if (!mask->valid || (mask->address != address) || (mask->channels != channels)) {
+		mask->valid = 0;
+		if ((result = amu_dev_transfer(address, (uint8_t)AMU_REG_SYSTEM_ADC_ACTIVE_CHANNELS, (uint8_t*)&channels, sizeof(uint16_t), AMU_TWI_TRANSFER_WRITE)) != 0)
+			return result;
+
+		mask->address = address;
+		mask->channels = channels;
+		mask->valid = 1;
+	}
+
+	for (uint8_t ch = 0; ch < AMU_ADC_CH_NUM; ch++) {
+		if (channels & (1 << ch))
+			n++;
+	}
+
+	if ((result = amu_dev_query_command(address, (CMD_t)CMD_EXEC_MEAS_ACTIVE_CHANNELS, 0, n * sizeof(float))) != 0)
+		return result;
+
+	// the device answers with the active channels in ascending order
+	for (uint8_t ch = 0, k = 0; ch < AMU_ADC_CH_NUM; ch++) {
+		if (channels & (1 << ch))
+			memcpy(&values[ch], reg + sizeof(float) * k++, sizeof(float));
+	}
+
+	return 0;
+}
+
+/**
+ * @brief Initializes a scheduler with no jobs, measuring through the amu_dev_* functions
+ *
+ * @param periodic 		scheduler
+ */
+void amu_periodic_init(amu_periodic_t* periodic) {
+	memset(periodic, 0, sizeof(amu_periodic_t));
+
+	periodic->ops.measure = _amu_periodic_measure;
+	periodic->ops.millis = NULL;				// amu_device.millis at the time of use
+	periodic->merge_ms = AMU_PERIODIC_MERGE_MS;
+}
+
+/**
+ * @brief Adds a job, due at once
+ *
+ * @param periodic 		scheduler
+ * @param address 		TWI address of the device
+ * @param channels 		amu_ch_en_t mask of the channels to measure
+ * @param period 		ms between measurements
+ * @param callback 		receives every measurement
+ * @param ctx 			stored in the job for the callback
+ * @return int8_t 		job number on success, -1 if all AMU_PERIODIC_MAX_JOBS are in use, -2 on invalid arguments
+ */
+int8_t amu_periodic_add(amu_periodic_t* periodic, uint8_t address, uint16_t channels, uint32_t period, amu_periodic_cb_t callback, void* ctx) {
+	amu_periodic_job_t* job = NULL;
+	uint8_t slot;
+
+	if ((channels == 0) || (period == 0) || (period > 0x7FFFFFFFUL) || !callback)
+		return -2;
+
+	for (slot = 0; slot < periodic->num; slot++) {
+		if (periodic->job[slot].period == 0)
+			break;
+	}
+
+	if (slot >= AMU_PERIODIC_MAX_JOBS)
+		return -1;
+	if (slot == periodic->num)
+		periodic->num++;
+
+	job = &periodic->job[slot];
+	memset(job, 0, sizeof(amu_periodic_job_t));
+
+	job->address = address;
+	job->channels = channels;
+	job->period = period;
+	job->due = _amu_periodic_now(periodic);
+	job->callback = callback;
+	job->ctx = ctx;
+
+	return (int8_t)slot;
+}
+
+/**
+ * @brief Removes a job, its slot is reused by the next amu_periodic_add()
+ */
+void amu_periodic_remove(amu_periodic_t* periodic, int8_t job) {
+	if ((job < 0) || (job >= periodic->num))
+		return;
+
+	periodic->job[job].period = 0;
+
+	while ((periodic->num > 0) && (periodic->job[periodic->num - 1].period == 0))
+		periodic->num--;
+}
+
+/**
+ * @brief Schedules every job from now and clears the statistics
+ *
+ * The jobs of one device stay in phase, so their coinciding runs share a query. Devices are spread
+ * evenly over the shortest period, and their slower jobs over different short periods, so they do
+ * not all queue for the bus at the same moment.
+ *
+ * @param periodic 		scheduler
+ */
+void amu_periodic_start(amu_periodic_t* periodic) {
+	uint8_t addresses[AMU_PERIODIC_MAX_JOBS];
+	uint8_t devices = 0;
+	uint32_t now = _amu_periodic_now(periodic);
+	uint32_t shortest = 0xFFFFFFFFUL;
+
+	for (uint8_t i = 0; i < periodic->num; i++) {
+		const amu_periodic_job_t* job = &periodic->job[i];
+		uint8_t d = 0;
+
+		if (job->period == 0)
+			continue;
+		if (job->period < shortest)
+			shortest = job->period;
+
+		while ((d < devices) && (addresses[d] != job->address))
+			d++;
+		if (d == devices)
+			addresses[devices++] = job->address;
+	}
+
+	for (uint8_t i = 0; i < periodic->num; i++) {
+		amu_periodic_job_t* job = &periodic->job[i];
+		uint8_t d = 0;
+
+		while ((d < devices) && (addresses[d] != job->address))
+			d++;
+
+		job->due = now;
+
+		if (d < devices) {
+			uint32_t cycles = job->period / shortest;
+
+			job->due += (shortest * d) / devices;
+
+			// a slower job that is a multiple of the shortest period starts a whole number of short periods late,
+			// it still coincides with the fast jobs of its device but the devices take turns in carrying it
+			if ((cycles > 1) && ((job->period % shortest) == 0))
+				job->due += (d % cycles) * shortest;
+		}
+
+		job->runs = 0;
+		job->missed = 0;
+		job->errors = 0;
+		job->max_late = 0;
+	}
+
+	periodic->queries = 0;
+	periodic->shared = 0;
+}
+
+static void _amu_periodic_advance(amu_periodic_job_t* job, uint32_t now) {
+	int32_t late = (int32_t)(now - job->due);
+
+	if (late > 0) {
+		if ((uint32_t)late > job->max_late)
+			job->max_late = ((uint32_t)late > 0xFFFF) ? 0xFFFF : (uint16_t)late;
+
+		// more than a period behind, skip the periods that can no longer be met instead of bunching up
+		if ((uint32_t)late >= job->period) {
+			uint32_t skipped = (uint32_t)late / job->period;
+
+			job->missed += skipped;
+			job->due += skipped * job->period;
+		}
+	}
+
+	job->due += job->period;
+}
+
+static void _amu_periodic_run(amu_periodic_t* periodic, const amu_periodic_job_t* lead, uint32_t now) {
+	bool selected[AMU_PERIODIC_MAX_JOBS];
+	float values[AMU_ADC_CH_NUM];
+	uint8_t address = lead->address;
+	uint16_t channels = 0;
+	uint8_t runs = 0;
+	int8_t result;
+
+	for (uint8_t i = 0; i < periodic->num; i++) {
+		const amu_periodic_job_t* job = &periodic->job[i];
+
+		selected[i] = (job->period != 0) && (job->address == address) && _amu_periodic_reached(job->due, now + periodic->merge_ms);
+		if (selected[i])
+			channels |= job->channels;
+	}
+
+	memset(values, 0, sizeof(values));
+	result = periodic->ops.measure(periodic, address, channels, values);
+	periodic->queries++;
+
+	for (uint8_t i = 0; i < periodic->num; i++) {
+		amu_periodic_job_t* job = &periodic->job[i];
+
+		if (!selected[i])
+			continue;
+
+		_amu_periodic_advance(job, now);
+
+		if (result != 0) {
+			job->errors++;
+			continue;
+		}
+
+		if (runs++ > 0)
+			periodic->shared++;
+
+		job->runs++;
+		job->callback(job, values, now);
+	}
+}
+
+/**
+ * @brief Runs every job that is due, earliest first, call again after the returned time
+ *
+ * Only jobs that were due on entry are run, once each, so an overloaded bus still returns to the
+ * caller.
+ *
+ * @param periodic 		scheduler
+ * @return uint32_t 	ms until the next job falls due, 0 if there are no jobs
+ */
+uint32_t amu_periodic_poll(amu_periodic_t* periodic) {
+	const amu_periodic_job_t* lead;
+	uint32_t start, now, wait;
+
+	if (!periodic->ops.measure)
+		return 0;
+
+	start = _amu_periodic_now(periodic);
+
+	do {
+		lead = NULL;
+
+		for (uint8_t i = 0; i < periodic->num; i++) {
+			const amu_periodic_job_t* job = &periodic->job[i];
+
+			if ((job->period != 0) && _amu_periodic_reached(job->due, start) && (!lead || ((int32_t)(job->due - lead->due) < 0)))
+				lead = job;
+		}
+
+		if (lead)
+			_amu_periodic_run(periodic, lead, _amu_periodic_now(periodic));
+	} while (lead);
+
+	now = _amu_periodic_now(periodic);
+	wait = 0xFFFFFFFFUL;
+
+	for (uint8_t i = 0; i < periodic->num; i++) {
+		int32_t left = (int32_t)(periodic->job[i].due - now);
+
+		if (periodic->job[i].period == 0)
+			continue;
+		if (left <= 0)
+			return 0;
+		if ((uint32_t)left < wait)
+			wait = (uint32_t)left;
+	}
+
+	return (wait != 0xFFFFFFFFUL) ? wait : 0;
+}
+
+/**
+ * @brief Periods skipped by all jobs since the start
+ */
+uint32_t amu_periodic_missed(const amu_periodic_t* periodic) {
+	uint32_t total = 0;
+
+	for (uint8_t i = 0; i < periodic->num; i++)
+		total += periodic->job[i].missed;
+
+	return total;
+}
+
+/**
+ * @brief Forgets the active channels written to the devices, call after changing them with AMU::setActiveChannels() or a device reset
+ */
+void amu_periodic_invalidate(amu_periodic_t* periodic) {
+	memset(periodic->mask, 0, sizeof(periodic->mask));
+}
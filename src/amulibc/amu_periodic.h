@@ -0,0 +1,112 @@
+/**
+ * @file amu_periodic.h
+ * @brief Cooperative multi-rate scheduler for periodic channel measurements
+ *
+ * Each job asks for a channel mask of one device at a fixed period, e.g. the temperature sensors at
+ * 1 Hz, voltage and current at 50 Hz and the sun sensor at 10 Hz. Jobs of the same device that fall
+ * due within merge_ms of each other are served by one CMD_EXEC_MEAS_ACTIVE_CHANNELS query of the
+ * union of their masks. The jobs of a device start in phase, so jobs with harmonic periods always
+ * coincide with the fastest one and cost no extra bus transactions, while different devices are
+ * spread over the shortest period so their queries do not wait on each other.
+ *
+ * Due times advance by whole periods from the start, not from the time a job ran, so lateness does
+ * not accumulate into drift. The lateness of every run is tracked per job, and a job that falls more
+ * than a period behind skips the periods it missed and counts them instead of running back to back
+ * to catch up.
+ *
+ * Everything lives in amu_periodic_t, there is no heap use. Call amu_periodic_poll() from the main
+ * loop, it returns the time until the next job falls due.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_PERIODIC_H__
+#define __AMU_PERIODIC_H__
+
+#include "amu_device.h"
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#ifndef AMU_PERIODIC_MAX_JOBS
+	#ifdef __AMU_LOW_MEMORY__
+		#define AMU_PERIODIC_MAX_JOBS	8
+	#else
+		#define AMU_PERIODIC_MAX_JOBS	32
+	#endif
+#endif
+
+#ifndef AMU_PERIODIC_MERGE_MS
+#define AMU_PERIODIC_MERGE_MS			2			// jobs due this close together share a query
+#endif
+
+typedef struct amu_periodic_job_s amu_periodic_job_t;
+typedef struct amu_periodic_s amu_periodic_t;
+
+/**
+ * @brief Receives the measurement of a job
+ *
+ * @param job 		the job, its channels select the entries of values it asked for
+ * @param values 	AMU_ADC_CH_NUM values indexed by amu_adc_ch_t, more channels may be filled if the query was shared
+ * @param time 		millis() at which the query was made
+ */
+typedef void (*amu_periodic_cb_t)(const amu_periodic_job_t* job, const float* values, uint32_t time);
+
+struct amu_periodic_job_s {
+	uint8_t address;				/*!< TWI address of the device */
+	uint8_t reserved;
+	uint16_t channels;				/*!< amu_ch_en_t mask */
+	uint32_t period;				/*!< ms, 0 for a removed job */
+	uint32_t due;					/*!< millis() of the next run */
+	uint32_t runs;					/*!< Measurements delivered */
+	uint32_t missed;				/*!< Periods skipped because the job ran more than a period late */
+	uint16_t errors;				/*!< Failed queries */
+	uint16_t max_late;				/*!< Worst start lateness of a run, ms */
+	amu_periodic_cb_t callback;
+	void* ctx;						/*!< For the callback */
+};
+
+typedef struct {
+	int8_t(*measure)(amu_periodic_t* periodic, uint8_t address, uint16_t channels, float* values);	/*!< Measures channels into values indexed by channel, 0 on success */
+	amu_milis_fptr_t millis;																			/*!< Time base */
+	void* ctx;																							/*!< For a replaced measure */
+} amu_periodic_ops_t;
+
+typedef struct {
+	uint8_t address;
+	uint8_t valid;
+	uint16_t channels;				/*!< Last value written to AMU_REG_SYSTEM_ADC_ACTIVE_CHANNELS */
+} amu_periodic_mask_t;
+
+struct amu_periodic_s {
+	amu_periodic_ops_t ops;
+	uint8_t num;					/*!< Job slots in use */
+	uint8_t merge_ms;				/*!< Window for sharing a query, AMU_PERIODIC_MERGE_MS */
+	uint16_t reserved;
+	uint32_t queries;				/*!< Queries made */
+	uint32_t shared;				/*!< Runs served by a query made for another job */
+	amu_periodic_job_t job[AMU_PERIODIC_MAX_JOBS];
+	amu_periodic_mask_t mask[AMU_MAX_CONNECTED_DEVICES];
+};
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	void		amu_periodic_init(amu_periodic_t* periodic);
+
+	int8_t		amu_periodic_add(amu_periodic_t* periodic, uint8_t address, uint16_t channels, uint32_t period, amu_periodic_cb_t callback, void* ctx);
+	void		amu_periodic_remove(amu_periodic_t* periodic, int8_t job);
+
+	void		amu_periodic_start(amu_periodic_t* periodic);
+	uint32_t	amu_periodic_poll(amu_periodic_t* periodic);
+
+	uint32_t	amu_periodic_missed(const amu_periodic_t* periodic);
+	void		amu_periodic_invalidate(amu_periodic_t* periodic);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_PERIODIC_H__ */
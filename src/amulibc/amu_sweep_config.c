@@ -0,0 +1,210 @@
+/**
+ * @file amu_sweep_config.c
+ * @brief Versioned sweep configuration, negotiated through the capability register
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_sweep_config.h"
+#include "amu_sweep_buffer.h"
+#include "amu_regs.h"
+
+/**
+ * @brief Converts a v1 configuration, every v1 configuration has an exact v2 equivalent
+ *
+ * @param config 		receives the v2 configuration
+ * @param v1 			v1 configuration
+ */
+void amu_sweep_config_from_v1(ivsweep_config_v2_t* config, const ivsweep_config_t* v1) {
+	memset(config, 0, sizeof(ivsweep_config_v2_t));
+
+	config->version = AMU_SWEEP_CONFIG_VERSION;
+	config->numPoints = v1->numPoints;
+	config->delay_us = (uint32_t)v1->delay * 1000;
+	config->type = v1->type;
+	config->ratio = v1->ratio;
+	config->power = v1->power;
+	config->dac_gain = v1->dac_gain;
+	config->sweep_averages = v1->sweep_averages;
+	config->adc_averages = v1->adc_averages;
+	config->am0 = v1->am0;
+	config->area = v1->area;
+}
+
+/**
+ * @brief Converts a v2 configuration, clamping the points to 255 and rounding the delay up to whole milliseconds
+ *
+ * @param v1 			receives the v1 configuration
+ * @param config 		v2 configuration
+ * @return bool 		true if the v1 configuration is exact
+ */
+bool amu_sweep_config_to_v1(ivsweep_config_t* v1, const ivsweep_config_v2_t* config) {
+	uint32_t delay_ms = (config->delay_us / 1000) + ((config->delay_us % 1000) ? 1 : 0);
+
+	v1->type = config->type;
+	v1->numPoints = (config->numPoints > UINT8_MAX) ? UINT8_MAX : (uint8_t)config->numPoints;
+	v1->delay = (delay_ms > UINT8_MAX) ? UINT8_MAX : (uint8_t)delay_ms;
+	v1->ratio = config->ratio;
+	v1->power = config->power;
+	v1->dac_gain = config->dac_gain;
+	v1->sweep_averages = config->sweep_averages;
+	v1->adc_averages = config->adc_averages;
+	v1->am0 = config->am0;
+	v1->area = config->area;
+
+	return (config->numPoints == v1->numPoints) && (config->delay_us == (uint32_t)v1->delay * 1000);
+}
+
+/**
+ * @brief Reads the capabilities of a device
+ *
+ * Firmware without AMU_REG_EXT_CAPABILITIES answers with something that is not a capability block of
+ * this version, capabilities then reports no features and IVSWEEP_MAX_POINTS.
+ *
+ * @param address 		TWI address of the device
+ * @param capabilities 	receives the capabilities, filled in even if the transfer fails
+ * @return int8_t 		0 on success, otherwise the error of the transport
+ */
+int8_t amu_capabilities_read(uint8_t address, amu_capabilities_t* capabilities) {
+	int8_t result = amu_dev_transfer_ext(address, (uint16_t)AMU_REG_EXT_CAPABILITIES, 0, (uint8_t*)capabilities, sizeof(amu_capabilities_t), AMU_TWI_TRANSFER_READ);
+
+	if ((result != 0) || (capabilities->version != AMU_CAPABILITIES_VERSION) || (capabilities->length != sizeof(amu_capabilities_t))) {
+		capabilities->version = 0;
+		capabilities->length = sizeof(amu_capabilities_t);
+		capabilities->flags = 0;
+		capabilities->maxPoints = IVSWEEP_MAX_POINTS;
+		capabilities->sweepConfigVersion = 1;
+	}
+
+	return result;
+}
+
+/**
+ * @brief Reads the sweep configuration of a device, through the v1 registers if it has no AMU_CAP_SWEEP_CONFIG_V2
+ *
+ * @param address 		TWI address of the device
+ * @param capabilities 	from amu_capabilities_read(), NULL to use the v1 registers
+ * @param config 		receives the configuration
+ * @return int8_t 		0 on success, otherwise the error of the transport
+ */
+int8_t amu_sweep_config_read(uint8_t address, const amu_capabilities_t* capabilities, ivsweep_config_v2_t* config) {
+	ivsweep_config_t v1;
+	int8_t result;
+
+	if (capabilities && (capabilities->flags & AMU_CAP_SWEEP_CONFIG_V2))
+		return amu_dev_transfer_ext(address, (uint16_t)AMU_REG_EXT_SWEEP_CONFIG_V2, 0, (uint8_t*)config, sizeof(ivsweep_config_v2_t), AMU_TWI_TRANSFER_READ);
+
+	if ((result = amu_dev_transfer(address, AMU_REG_DATA_PTR_SWEEP_CONFIG, (uint8_t*)&v1, sizeof(ivsweep_config_t), AMU_TWI_TRANSFER_READ)) != 0)
+		return result;
+
+	amu_sweep_config_from_v1(config, &v1);
+
+	return 0;
+}
+
+/**
+ * @brief Writes the sweep configuration of a device, through the v1 registers if it has no AMU_CAP_SWEEP_CONFIG_V2
+ *
+ * @param address 		TWI address of the device
+ * @param capabilities 	from amu_capabilities_read(), NULL to use the v1 registers
+ * @param config 		configuration, its version is ignored
+ * @return int8_t 		0 on success, AMU_SWEEP_CONFIG_ERROR_RANGE if only the v1 registers are available and
+ * 						the configuration does not fit them, otherwise the error of the transport
+ */
+int8_t amu_sweep_config_write(uint8_t address, const amu_capabilities_t* capabilities, const ivsweep_config_v2_t* config) {
+	ivsweep_config_v2_t v2;
+	ivsweep_config_t v1;
+
+	if (capabilities && (capabilities->flags & AMU_CAP_SWEEP_CONFIG_V2)) {
+		v2 = *config;
+		v2.version = AMU_SWEEP_CONFIG_VERSION;
+		v2.reserved = 0;
+		return amu_dev_transfer_ext(address, (uint16_t)AMU_REG_EXT_SWEEP_CONFIG_V2, 0, (uint8_t*)&v2, sizeof(ivsweep_config_v2_t), AMU_TWI_TRANSFER_WRITE);
+	}
+
+	if (!amu_sweep_config_to_v1(&v1, config))
+		return AMU_SWEEP_CONFIG_ERROR_RANGE;
+
+	return amu_dev_transfer(address, AMU_REG_DATA_PTR_SWEEP_CONFIG, (uint8_t*)&v1, sizeof(ivsweep_config_t), AMU_TWI_TRANSFER_WRITE);
+}
+
+#ifdef __AMU_DEVICE__
+
+static ivsweep_config_v2_t amu_sweep_config_v2;
+static ivsweep_config_v2_t amu_sweep_config_v2_synced;		// both as of the last amu_sweep_config_sync()
+static ivsweep_config_t amu_sweep_config_v1_synced;
+
+static amu_capabilities_t amu_capabilities;
+
+static inline uint16_t _amu_sweep_config_max_points(void) {
+	uint16_t max = amu_sweep_max_points();
+	return (max > AMU_SWEEP_CONFIG_MAX_POINTS) ? (uint16_t)AMU_SWEEP_CONFIG_MAX_POINTS : max;
+}
+
+/**
+ * @brief Brings the v1 registers and the v2 configuration in step, whichever changed since the last call wins
+ *
+ * The v1 registers win if both changed. Called on every access of AMU_REG_EXT_SWEEP_CONFIG_V2 and by
+ * amu_sweep_config_get(), the firmware only needs to call it after changing amu_regs->sweep_config itself.
+ */
+void amu_sweep_config_sync(void) {
+	ivsweep_config_t v1;
+
+	if (amu_device.amu_regs == NULL)
+		return;
+
+	memcpy(&v1, (const void*)&amu_device.amu_regs->sweep_config, sizeof(ivsweep_config_t));
+
+	if (memcmp(&v1, &amu_sweep_config_v1_synced, sizeof(ivsweep_config_t)) != 0) {
+		amu_sweep_config_from_v1(&amu_sweep_config_v2, &v1);
+	}
+	else if (memcmp(&amu_sweep_config_v2, &amu_sweep_config_v2_synced, sizeof(ivsweep_config_v2_t)) != 0) {
+		if (amu_sweep_config_v2.numPoints > _amu_sweep_config_max_points())
+			amu_sweep_config_v2.numPoints = _amu_sweep_config_max_points();
+
+		amu_sweep_config_to_v1(&v1, &amu_sweep_config_v2);
+		memcpy((void*)&amu_device.amu_regs->sweep_config, &v1, sizeof(ivsweep_config_t));
+	}
+
+	amu_sweep_config_v2.version = AMU_SWEEP_CONFIG_VERSION;
+	amu_sweep_config_v2.reserved = 0;
+
+	memcpy(&amu_sweep_config_v1_synced, &v1, sizeof(ivsweep_config_t));
+	memcpy(&amu_sweep_config_v2_synced, &amu_sweep_config_v2, sizeof(ivsweep_config_v2_t));
+}
+
+/**
+ * @brief The sweep configuration to run, call when a sweep is triggered
+ *
+ * @return const ivsweep_config_v2_t*
+ */
+const ivsweep_config_v2_t* amu_sweep_config_get(void) {
+	amu_sweep_config_sync();
+	return &amu_sweep_config_v2;
+}
+
+/**
+ * @brief Points of the current configuration, for the lengths of the AMU_REG_DATA_PTR sweep registers
+ */
+uint16_t amu_sweep_config_points(void) {
+	return amu_sweep_config_get()->numPoints;
+}
+
+ivsweep_config_v2_t* amu_sweep_config_get_v2_ptr(void) {
+	amu_sweep_config_sync();
+	return &amu_sweep_config_v2;
+}
+
+amu_capabilities_t* amu_capabilities_get_ptr(void) {
+
+	amu_capabilities.version = AMU_CAPABILITIES_VERSION;
+	amu_capabilities.length = sizeof(amu_capabilities_t);
+	amu_capabilities.flags = AMU_CAP_IDENTITY | AMU_CAP_SWEEP_CONFIG_V2 | AMU_CAP_SWEEP_STATUS | AMU_CAP_HISTORY | AMU_CAP_ADC_RAW;
+	amu_capabilities.maxPoints = _amu_sweep_config_max_points();
+	amu_capabilities.sweepConfigVersion = AMU_SWEEP_CONFIG_VERSION;
+
+	return &amu_capabilities;
+}
+
+#endif
@@ -0,0 +1,67 @@
+/**
+ * @file amu_sweep_config.h
+ * @brief Versioned sweep configuration, negotiated through the capability register
+ *
+ * ivsweep_config_t limits a sweep to 255 points and the settling time per point to whole
+ * milliseconds. Firmware that reports AMU_CAP_SWEEP_CONFIG_V2 in AMU_REG_EXT_CAPABILITIES also
+ * exposes an ivsweep_config_v2_t, with 16-bit points and a microsecond delay, as the extended register
+ * AMU_REG_EXT_SWEEP_CONFIG_V2. Both views stay in step on the device: a write to the v1 registers
+ * replaces the v2 configuration, and a write of the v2 configuration is mirrored into the v1
+ * registers, clamped to what they can hold, so hosts that only know ivsweep_config_t keep working.
+ *
+ * The host reads the capabilities once per device. Firmware without the register reports no
+ * capabilities, and the v2 functions then fall back to the v1 registers.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_SWEEP_CONFIG_H__
+#define __AMU_SWEEP_CONFIG_H__
+
+#include "amu_device.h"
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_SWEEP_CONFIG_VERSION		2
+#define AMU_CAPABILITIES_VERSION		1
+
+#define AMU_SWEEP_CONFIG_MAX_POINTS		(UINT16_MAX / sizeof(float))		// longest column the 16-bit offset of the extended window reaches
+
+#define AMU_CAP_IDENTITY				0x00000001		/*!< AMU_REG_EXT_IDENTITY */
+#define AMU_CAP_SWEEP_CONFIG_V2			0x00000002		/*!< AMU_REG_EXT_SWEEP_CONFIG_V2 */
+#define AMU_CAP_SWEEP_STATUS			0x00000004		/*!< AMU_REG_DATA_PTR_SWEEP_STATUS */
+#define AMU_CAP_HISTORY					0x00000008		/*!< AMU_REG_DATA_PTR_HISTORY_CTRL and AMU_REG_DATA_PTR_HISTORY */
+#define AMU_CAP_ADC_RAW					0x00000010		/*!< AMU_REG_EXT_ADC_RAW */
+
+#define AMU_SWEEP_CONFIG_ERROR_RANGE	(-15)		/*!< Configuration does not fit ivsweep_config_t and the firmware has no AMU_CAP_SWEEP_CONFIG_V2 */
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	void		amu_sweep_config_from_v1(ivsweep_config_v2_t* config, const ivsweep_config_t* v1);
+	bool		amu_sweep_config_to_v1(ivsweep_config_t* v1, const ivsweep_config_v2_t* config);
+
+	int8_t		amu_capabilities_read(uint8_t address, amu_capabilities_t* capabilities);
+
+	int8_t		amu_sweep_config_read(uint8_t address, const amu_capabilities_t* capabilities, ivsweep_config_v2_t* config);
+	int8_t		amu_sweep_config_write(uint8_t address, const amu_capabilities_t* capabilities, const ivsweep_config_v2_t* config);
+
+#ifdef __AMU_DEVICE__
+
+	void					amu_sweep_config_sync(void);
+	const ivsweep_config_v2_t*	amu_sweep_config_get(void);
+	uint16_t				amu_sweep_config_points(void);
+
+	ivsweep_config_v2_t*	amu_sweep_config_get_v2_ptr(void);
+	amu_capabilities_t*		amu_capabilities_get_ptr(void);
+
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_SWEEP_CONFIG_H__ */
@@ -0,0 +1,294 @@
+/**
+ * @file amu_sweep_encode.c
+ * @brief Compact integer encoding for sweep array readout
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include <math.h>
+
+#include "amu_sweep_encode.h"
+#include "amu_device.h"
+#include "amu_regs.h"
+#include "amu_sweep_config.h"
+
+#define HEADER_LEN		sizeof(amu_sweep_enc_header_t)
+
+static inline void _put_code(uint8_t* out, uint32_t code) {
+	out[0] = (uint8_t)(code);
+	out[1] = (uint8_t)(code >> 8);
+	out[2] = (uint8_t)(code >> 16);
+}
+
+static inline uint32_t _get_code(const uint8_t* in) {
+	return (uint32_t)in[0] | ((uint32_t)in[1] << 8) | ((uint32_t)in[2] << 16);
+}
+
+static inline uint32_t _quantize(float x, float offset, float scale) {
+	float code;
+
+	if (scale <= 0.0f)
+		return 0;
+
+	code = ((x - offset) / scale) + 0.5f;
+
+	if (code <= 0.0f)
+		return 0;
+	if (code >= (float)AMU_SWEEP_CODE_MAX)
+		return AMU_SWEEP_CODE_MAX;
+
+	return (uint32_t)code;
+}
+
+static size_t _encode_float(const float* data, uint16_t numPoints, uint8_t* out, size_t maxLen) {
+	size_t len = HEADER_LEN + (size_t)numPoints * sizeof(float);
+
+	if (len > maxLen)
+		return 0;
+
+	memcpy(&out[HEADER_LEN], data, (size_t)numPoints * sizeof(float));
+
+	return len;
+}
+
+static size_t _encode_int24(const float* data, uint16_t numPoints, float offset, float scale, uint8_t* out, size_t maxLen) {
+	size_t len = HEADER_LEN + (size_t)numPoints * 3;
+
+	if (len > maxLen)
+		return 0;
+
+	for (uint16_t i = 0; i < numPoints; i++)
+		_put_code(&out[HEADER_LEN + (size_t)i * 3], _quantize(data[i], offset, scale));
+
+	return len;
+}
+
+// linear prediction from the previous two codes, the first delta is predicted from the first code alone
+static inline int32_t _predict(uint32_t prev, int32_t slope) {
+	int32_t predicted = (int32_t)prev + slope;
+
+	if (predicted < 0)
+		return 0;
+	if (predicted > (int32_t)AMU_SWEEP_CODE_MAX)
+		return (int32_t)AMU_SWEEP_CODE_MAX;
+
+	return predicted;
+}
+
+// returns 0 as soon as the delta stream is no shorter than the INT24 encoding would be
+static size_t _encode_delta16(const float* data, uint16_t numPoints, float offset, float scale, uint8_t* out, size_t maxLen) {
+	size_t int24Len = HEADER_LEN + (size_t)numPoints * 3;
+	size_t limit = (int24Len < maxLen) ? int24Len : maxLen;
+	size_t pos = HEADER_LEN;
+	uint32_t prev, code;
+	int32_t slope = 0, residual;
+
+	if (numPoints == 0 || (pos + 3) > limit)
+		return 0;
+
+	prev = _quantize(data[0], offset, scale);
+	_put_code(&out[pos], prev);
+	pos += 3;
+
+	for (uint16_t i = 1; i < numPoints; i++) {
+		code = _quantize(data[i], offset, scale);
+		residual = (int32_t)code - _predict(prev, slope);
+
+		if ((residual > INT16_MAX) || (residual <= AMU_SWEEP_DELTA16_ESCAPE)) {
+			if ((pos + 5) > limit)
+				return 0;
+			out[pos++] = (uint8_t)((uint16_t)AMU_SWEEP_DELTA16_ESCAPE);
+			out[pos++] = (uint8_t)((uint16_t)AMU_SWEEP_DELTA16_ESCAPE >> 8);
+			_put_code(&out[pos], code);
+			pos += 3;
+		}
+		else {
+			if ((pos + 2) > limit)
+				return 0;
+			out[pos++] = (uint8_t)((uint16_t)residual);
+			out[pos++] = (uint8_t)((uint16_t)residual >> 8);
+		}
+
+		slope = (int32_t)code - (int32_t)prev;
+		prev = code;
+	}
+
+	return (pos < int24Len) ? pos : 0;
+}
+
+/**
+ * @brief Encodes a sweep array
+ *
+ * @param data			sweep array, i.e. amu_device.sweep_data->voltage
+ * @param numPoints		number of points in the array
+ * @param encoding		requested amu_sweep_encoding_t, the header records the one actually used
+ * @param out			output buffer, starts with an amu_sweep_enc_header_t
+ * @param maxLen		size of the output buffer
+ * @return size_t length of the encoded array, 0 if it does not fit in maxLen
+ */
+size_t amu_sweep_encode(const float* data, uint16_t numPoints, uint8_t encoding, uint8_t* out, size_t maxLen) {
+	amu_sweep_enc_header_t header = { 0, AMU_SWEEP_ENC_FLOAT, 0, 0.0f, 0.0f };
+	float min, max;
+	size_t len = 0;
+
+	if (!data || !out || (maxLen < HEADER_LEN))
+		return 0;
+
+	// 3 byte codes plus scale and offset only pay off past a few points
+	if ((numPoints * 3) + (2 * sizeof(float)) >= (numPoints * sizeof(float)))
+		encoding = AMU_SWEEP_ENC_FLOAT;
+
+	min = max = (numPoints > 0) ? data[0] : 0.0f;
+
+	for (uint16_t i = 0; (i < numPoints) && (encoding != AMU_SWEEP_ENC_FLOAT); i++) {
+		if (!isfinite(data[i]))
+			encoding = AMU_SWEEP_ENC_FLOAT;
+		else if (data[i] < min)
+			min = data[i];
+		else if (data[i] > max)
+			max = data[i];
+	}
+
+	header.offset = min;
+	header.scale = (max - min) / (float)AMU_SWEEP_CODE_MAX;
+
+	if (encoding == AMU_SWEEP_ENC_DELTA16) {
+		if ((len = _encode_delta16(data, numPoints, header.offset, header.scale, out, maxLen)) == 0)
+			encoding = AMU_SWEEP_ENC_INT24;
+	}
+
+	if (encoding == AMU_SWEEP_ENC_INT24) {
+		if ((len = _encode_int24(data, numPoints, header.offset, header.scale, out, maxLen)) == 0)
+			encoding = AMU_SWEEP_ENC_FLOAT;
+	}
+
+	if ((encoding != AMU_SWEEP_ENC_DELTA16) && (encoding != AMU_SWEEP_ENC_INT24)) {
+		encoding = AMU_SWEEP_ENC_FLOAT;
+		header.scale = header.offset = 0.0f;
+		if ((len = _encode_float(data, numPoints, out, maxLen)) == 0)
+			return 0;
+	}
+
+	header.length = (uint16_t)len;
+	header.encoding = encoding;
+	memcpy(out, &header, HEADER_LEN);
+
+	return len;
+}
+
+/**
+ * @brief Decodes an array produced by amu_sweep_encode()
+ *
+ * @param in			encoded array starting with its amu_sweep_enc_header_t
+ * @param len			number of bytes available in the input
+ * @param data			decoded sweep array
+ * @param maxPoints		size of the output array
+ * @return int16_t number of points decoded, -1 if the encoded array is malformed
+ */
+int16_t amu_sweep_decode(const uint8_t* in, size_t len, float* data, uint16_t maxPoints) {
+	amu_sweep_enc_header_t header;
+	size_t pos = HEADER_LEN;
+	uint16_t n = 0;
+	uint32_t code = 0, prev;
+	int32_t slope = 0;
+
+	if (!in || !data || (len < HEADER_LEN))
+		return -1;
+
+	memcpy(&header, in, HEADER_LEN);
+
+	if ((header.length < HEADER_LEN) || (header.length > len))
+		return -1;
+
+	len = header.length;
+
+	switch (header.encoding) {
+	case AMU_SWEEP_ENC_FLOAT:
+		for (; ((pos + sizeof(float)) <= len) && (n < maxPoints); pos += sizeof(float))
+			memcpy(&data[n++], &in[pos], sizeof(float));
+		break;
+
+	case AMU_SWEEP_ENC_INT24:
+		for (; ((pos + 3) <= len) && (n < maxPoints); pos += 3)
+			data[n++] = header.offset + (float)_get_code(&in[pos]) * header.scale;
+		break;
+
+	case AMU_SWEEP_ENC_DELTA16:
+		if ((pos + 3) > len)
+			return -1;
+
+		code = _get_code(&in[pos]);
+		pos += 3;
+
+		while (n < maxPoints) {
+			data[n++] = header.offset + (float)code * header.scale;
+
+			if ((pos + 2) > len)
+				break;
+
+			int16_t residual = (int16_t)((uint16_t)in[pos] | ((uint16_t)in[pos + 1] << 8));
+			pos += 2;
+
+			prev = code;
+
+			if (residual == AMU_SWEEP_DELTA16_ESCAPE) {
+				if ((pos + 3) > len)
+					return -1;
+				code = _get_code(&in[pos]);
+				pos += 3;
+			}
+			else
+				code = (uint32_t)(_predict(prev, slope) + residual) & AMU_SWEEP_CODE_MAX;
+
+			slope = (int32_t)code - (int32_t)prev;
+		}
+		break;
+
+	default:
+		return -1;
+	}
+
+	return (int16_t)n;
+}
+
+#ifdef __AMU_DEVICE__
+
+/**
+ * @brief Handles CMD_SWEEP_ENCODE, call from process_cmd
+ *
+ * Reads the AMU_REG_DATA_PTR array register and requested encoding from the first two bytes of the
+ * transfer register, then replaces them with the encoded array of the readable sweep.
+ *
+ * @return size_t length of the encoded array now in the transfer register, 0 on error
+ */
+size_t amu_sweep_encode_transfer_reg(void) {
+	uint8_t* transfer_reg = (uint8_t*)amu_dev_get_transfer_reg_ptr();
+	uint8_t reg = transfer_reg[0];
+	uint8_t encoding = transfer_reg[1];
+	uint16_t numPoints = amu_sweep_config_points();
+	const float* data;
+	size_t len = 0;
+
+	switch (reg) {
+	case AMU_REG_DATA_PTR_VOLTAGE:
+	case AMU_REG_DATA_PTR_CURRENT:
+	case AMU_REG_DATA_PTR_SS_YAW:
+	case AMU_REG_DATA_PTR_SS_PITCH:
+		data = (const float*)amu_get_register_ptr(reg);
+		if (data != NULL) {
+			if (numPoints > amu_sweep_max_points())
+				numPoints = amu_sweep_max_points();
+			len = amu_sweep_encode(data, numPoints, encoding, transfer_reg, AMU_TRANSFER_REG_SIZE);
+		}
+		break;
+	default:
+		break;
+	}
+
+	_amu_transfer_set_length(len);
+
+	return len;
+}
+
+#endif
@@ -0,0 +1,42 @@
+/**
+ * @file amu_sweep_encode.h
+ * @brief Compact integer encoding for sweep array readout
+ *
+ * Sweep arrays are quantized to 24-bit codes over the range of the sweep itself, which is never
+ * coarser than the 24-bit ADC code over the PGA full scale the data came from. The codes are sent
+ * either as 3 bytes each (AMU_SWEEP_ENC_INT24) or as int16 residuals from a linear prediction
+ * off the previous two points (AMU_SWEEP_ENC_DELTA16), which are small for the evenly stepped
+ * voltages and the flat and linear parts of the current. The encoder falls back to INT24 when deltas would not save anything and
+ * to plain floats for short or non-finite arrays, so the encoded array is never larger than the
+ * float array plus its amu_sweep_enc_header_t.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_SWEEP_ENCODE_H__
+#define __AMU_SWEEP_ENCODE_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_SWEEP_CODE_MAX				0x00FFFFFFUL
+#define AMU_SWEEP_DELTA16_ESCAPE		((int16_t)0x8000)
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	size_t		amu_sweep_encode(const float* data, uint16_t numPoints, uint8_t encoding, uint8_t* out, size_t maxLen);
+	int16_t		amu_sweep_decode(const uint8_t* in, size_t len, float* data, uint16_t maxPoints);
+
+#ifdef __AMU_DEVICE__
+	size_t		amu_sweep_encode_transfer_reg(void);
+#endif
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_SWEEP_ENCODE_H__ */
@@ -0,0 +1,135 @@
+/**
+ * @file amu_timesync.c
+ * @brief Device clock offset and drift model for mapping device timestamps to host time
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include "amu_timesync.h"
+
+/**
+ * @brief Clears all samples, call after the device clock was set
+ *
+ * @param sync 		model
+ */
+void amu_timesync_reset(amu_timesync_t* sync) {
+	memset(sync, 0, sizeof(amu_timesync_t));
+}
+
+/**
+ * @brief Refits the line through the samples, relative to the newest one
+ */
+static void _amu_timesync_fit(amu_timesync_t* sync) {
+	const amu_timesync_sample_t* ref = &sync->samples[(sync->next + AMU_TIMESYNC_SAMPLES - 1) % AMU_TIMESYNC_SAMPLES];
+	uint32_t base = ref->device - ref->host;
+	uint16_t min_rtt = 0xFFFF;
+	float x[AMU_TIMESYNC_SAMPLES], y[AMU_TIMESYNC_SAMPLES];
+	float mx = 0.0f, my = 0.0f, sxx = 0.0f, sxy = 0.0f;
+	float a, b = 0.0f;
+	uint8_t n = 0;
+
+	for (uint8_t i = 0; i < sync->count; i++) {
+		if (sync->samples[i].rtt < min_rtt)
+			min_rtt = sync->samples[i].rtt;
+	}
+
+	// slow round trips say little about when the clock was read
+	for (uint8_t i = 0; i < sync->count; i++) {
+		const amu_timesync_sample_t* s = &sync->samples[i];
+
+		if (s->rtt > 2 * min_rtt + 1)
+			continue;
+
+		x[n] = (float)(int32_t)(s->host - ref->host) + 0.5f * s->rtt;
+		y[n] = (float)(int32_t)((s->device - s->host) - base) - 0.5f * s->rtt;
+		mx += x[n];
+		my += y[n];
+		n++;
+	}
+
+	mx /= n;
+	my /= n;
+
+	for (uint8_t i = 0; i < n; i++) {
+		sxx += (x[i] - mx) * (x[i] - mx);
+		sxy += (x[i] - mx) * (y[i] - my);
+	}
+
+	if (sxx > 0.0f) {
+		b = sxy / sxx;
+		if (b > AMU_TIMESYNC_MAX_DRIFT)
+			b = AMU_TIMESYNC_MAX_DRIFT;
+		if (b < -AMU_TIMESYNC_MAX_DRIFT)
+			b = -AMU_TIMESYNC_MAX_DRIFT;
+	}
+	a = my - b * mx;
+
+	sync->used = n;
+	sync->device_ref = ref->device;
+	sync->offset = base;
+	sync->offset_q16 = (int32_t)(a * 65536.0f);
+	sync->drift_q32 = (int32_t)(b * 4294967296.0f);
+}
+
+/**
+ * @brief Adds a reading of the device clock and refits the model
+ *
+ * @param sync 			model
+ * @param host_before 	host ms just before the device clock was read
+ * @param device_ms 	device clock read
+ * @param host_after 	host ms just after the read returned
+ * @return false if the sample was rejected because the host clock went backwards or the read took over a minute
+ */
+bool amu_timesync_add(amu_timesync_t* sync, uint32_t host_before, uint32_t device_ms, uint32_t host_after) {
+	uint32_t rtt = host_after - host_before;
+	amu_timesync_sample_t* s;
+
+	if (rtt > 0xFFFF)
+		return false;
+
+	s = &sync->samples[sync->next];
+	s->host = host_before;
+	s->device = device_ms;
+	s->rtt = (uint16_t)rtt;
+	s->reserved = 0;
+
+	sync->next = (sync->next + 1) % AMU_TIMESYNC_SAMPLES;
+	if (sync->count < AMU_TIMESYNC_SAMPLES)
+		sync->count++;
+
+	_amu_timesync_fit(sync);
+
+	return true;
+}
+
+/**
+ * @brief Host time of a device timestamp
+ *
+ * @param sync 			model, timestamps are returned unchanged until it has a sample
+ * @param device_ms 	device timestamp, e.g. from the sweep timestamp array or ivsweep_meta_t
+ * @return uint32_t 	host ms
+ */
+uint32_t amu_timesync_to_host(const amu_timesync_t* sync, uint32_t device_ms) {
+	int64_t corr;
+
+	if (!sync->used)
+		return device_ms;
+
+	corr = (int64_t)sync->offset_q16 + (((int64_t)(int32_t)(device_ms - sync->device_ref) * sync->drift_q32) >> 16);
+
+	return device_ms - sync->offset - (uint32_t)(int32_t)((corr + 0x8000) >> 16);
+}
+
+/**
+ * @brief Maps an array of device timestamps to host time
+ *
+ * @param sync 			model
+ * @param device_ms 	device timestamps
+ * @param host_ms 		host timestamps, may be the same array as device_ms
+ * @param count 		number of timestamps
+ */
+void amu_timesync_map(const amu_timesync_t* sync, const uint32_t* device_ms, uint32_t* host_ms, size_t count) {
+	for (size_t i = 0; i < count; i++)
+		host_ms[i] = amu_timesync_to_host(sync, device_ms[i]);
+}
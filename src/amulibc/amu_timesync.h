@@ -0,0 +1,68 @@
+/**
+ * @file amu_timesync.h
+ * @brief Device clock offset and drift model for mapping device timestamps to host time
+ *
+ * Every sample reads the device millisecond clock between two host clock readings. The offset of
+ * the device clock against the middle of those readings is fitted as a line over the last
+ * AMU_TIMESYNC_SAMPLES samples, skipping samples whose round trip was much slower than the fastest
+ * one. The fit is kept as an offset and a Q32 slope, so mapping a timestamp is one multiply and
+ * shift without float operations, cheap enough to do on every sweep as it is read.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_TIMESYNC_H__
+#define __AMU_TIMESYNC_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#ifndef AMU_TIMESYNC_SAMPLES
+	#ifdef __AMU_LOW_MEMORY__
+		#define AMU_TIMESYNC_SAMPLES	4
+	#else
+		#define AMU_TIMESYNC_SAMPLES	16
+	#endif
+#endif
+
+#define AMU_TIMESYNC_MAX_DRIFT		1e-3f		// 1000 ppm, anything larger is a bad sample rather than a crystal
+
+typedef struct {
+	uint32_t host;					/*!< host ms before the device clock was read */
+	uint32_t device;				/*!< device ms read */
+	uint16_t rtt;					/*!< host ms until the read returned */
+	uint16_t reserved;
+} amu_timesync_sample_t;
+
+typedef struct {
+	amu_timesync_sample_t samples[AMU_TIMESYNC_SAMPLES];
+	uint8_t count;					/*!< samples held */
+	uint8_t next;					/*!< slot of the next sample */
+	uint8_t used;					/*!< samples in the current fit, 0 until the first sample */
+	uint8_t reserved;
+	uint32_t device_ref;			/*!< device ms at the reference point of the fit */
+	uint32_t offset;				/*!< whole ms of device - host at the reference point */
+	int32_t offset_q16;				/*!< rest of device - host at the reference point, Q16 ms */
+	int32_t drift_q32;				/*!< change of device - host per device ms, Q32 (1 ppm is 4295) */
+} amu_timesync_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	void		amu_timesync_reset(amu_timesync_t* sync);
+	bool		amu_timesync_add(amu_timesync_t* sync, uint32_t host_before, uint32_t device_ms, uint32_t host_after);
+
+	uint32_t	amu_timesync_to_host(const amu_timesync_t* sync, uint32_t device_ms);
+	void		amu_timesync_map(const amu_timesync_t* sync, const uint32_t* device_ms, uint32_t* host_ms, size_t count);
+
+	static inline bool	amu_timesync_valid(const amu_timesync_t* sync) { return sync->used > 0; }
+	static inline float	amu_timesync_drift_ppm(const amu_timesync_t* sync) { return (float)sync->drift_q32 * (1e6f / 4294967296.0f); }
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_TIMESYNC_H__ */
@@ -0,0 +1,299 @@
+/**
+ * @file amu_tsensor.c
+ * @brief Temperature sensor conversion shared by the device and the host
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+#include <math.h>
+
+#include "amu_tsensor.h"
+
+#define AMU_TSENSOR_RTD_FRAC		28						// R / R0 - 1
+#define AMU_TSENSOR_T_FRAC			16						// degrees C
+#define AMU_TSENSOR_FIT_SCALE		1024.0f					// fit polynomials are evaluated on t / 1024 C
+#define AMU_TSENSOR_FIT_LIMIT		16384.0f				// sum of the scaled fit coefficients, keeps Q16.16 results in range
+
+#define AMU_TSENSOR_CVD_K_Q16		221761341L				// -A / 2B
+#define AMU_TSENSOR_CVD_k_Q31		-324762638L				// 4B / A^2
+#define AMU_TSENSOR_CVD_U_MAX		(6L << AMU_TSENSOR_RTD_FRAC)	// R / R0 of 7, beyond the range of the CVD equation
+
+#define AMU_TSENSOR_LOW_FRAC		21
+
+/**
+ * @brief The PT100 fit below 0 C in powers of x - 1 = r / 100 - 1, Q21
+ */
+static const int32_t amu_tsensor_low_q21[6] = { -2097, 536594717, 20372154, -1795582, 10073040, 3196689 };
+
+/**
+ * @brief 1 / sqrt(x) in Q30 at the middle of each sixteenth of x from 0.25 to 1
+ */
+static const uint32_t amu_tsensor_rsqrt_q30[12] = {
+	2024667000UL, 1831380208UL, 1684624773UL, 1568300315UL, 1473161629UL, 1393471397UL,
+	1325455684UL, 1266516759UL, 1214800200UL, 1168942037UL, 1127913670UL, 1090922784UL,
+};
+
+static const float amu_tsensor_low[6] = { -242.02f, 2.2228f, 2.5859e-3f, -4.8260e-6f, -2.8183e-8f, 1.5243e-10f };
+
+static inline bool _fit_enabled(const amu_coeff_t* fit) {
+	if ((fit->val.A == 0.0f) && (fit->val.C == 0.0f) && (fit->val.D == 0.0f))
+		return !((fit->val.B == 0.0f) || (fit->val.B == 1.0f));
+	return true;
+}
+
+static inline float _rtd_r0(uint8_t type) {
+	return (type == AMU_TSENSOR_TYPE_PT100_RTD) ? 100.0f : 1000.0f;
+}
+
+/**
+ * @brief RTD temperature from its resistance
+ *
+ * @param resistance 	ohm
+ * @param r0 			resistance at 0 C, i.e. 100 for PT100 and 1000 for PT1000
+ * @return float degrees C
+ */
+float amu_tsensor_rtd_temperature(float resistance, float r0) {
+	float u = (resistance / r0) - 1.0f;
+	float d, r;
+
+	if (u >= 0.0f) {
+		d = 1.0f + (4.0f * AMU_TSENSOR_CVD_B / (AMU_TSENSOR_CVD_A * AMU_TSENSOR_CVD_A)) * u;
+		if (d < 0.0f)
+			d = 0.0f;
+		return (2.0f / AMU_TSENSOR_CVD_A) * u / (1.0f + sqrtf(d));
+	}
+
+	r = 100.0f * (u + 1.0f);
+	return ((((amu_tsensor_low[5] * r + amu_tsensor_low[4]) * r + amu_tsensor_low[3]) * r + amu_tsensor_low[2]) * r + amu_tsensor_low[1]) * r + amu_tsensor_low[0];
+}
+
+/**
+ * @brief Temperature of one raw ADC code
+ *
+ * @param cal 			conversion of the sensor type
+ * @param code 			raw ADC code
+ * @return float degrees C including the fit correction
+ */
+float amu_tsensor_temperature(const amu_tsensor_cal_t* cal, int32_t code) {
+	float value = cal->gain * (float)code + cal->offset;
+	float t;
+
+	if (cal->type == AMU_TSENSOR_TYPE_AD590)
+		t = value - AMU_TSENSOR_KELVIN;
+	else
+		t = amu_tsensor_rtd_temperature(value, _rtd_r0(cal->type));
+
+	if (!_fit_enabled(&cal->fit))
+		return t;
+
+	return ((cal->fit.val.D * t + cal->fit.val.C) * t + cal->fit.val.B) * t + cal->fit.val.A;
+}
+
+/**
+ * @brief Converts the temperature sensor channels of an array of raw ADC readings
+ *
+ * @param cal 			conversion of the sensor type
+ * @param raw 			raw readings
+ * @param count 		number of readings
+ * @param num 			temperature sensors per reading (1-3, the tsensor_num register)
+ * @param temperature 	count * num temperatures, the sensors of each reading next to each other
+ */
+void amu_tsensor_convert(const amu_tsensor_cal_t* cal, const adc_channels_t* raw, size_t count, uint8_t num, float* temperature) {
+	if (num > 3)
+		num = 3;
+
+	for (size_t i = 0; i < count; i++) {
+		for (uint8_t ch = 0; ch < num; ch++)
+			*temperature++ = amu_tsensor_temperature(cal, (int32_t)raw[i].val.tsensors[ch]);
+	}
+}
+
+/**
+ * @brief Square root of d / 2^32 in Q30, from multiplications only
+ *
+ * d is normalized to [0.25, 1) by an even shift, 1 / sqrt is looked up to within 6% and refined by
+ * three Newton steps y (3 - x y^2) / 2 to the last bits of Q30, then multiplied by x.
+ */
+static uint32_t _sqrt_q30(uint32_t d) {
+	uint8_t shift = 0;
+	uint64_t x, y;
+
+	if (d == 0)
+		return 0;
+
+	while (d < (1UL << 30)) {
+		d <<= 2;
+		shift++;
+	}
+
+	x = d >> 2;
+	y = amu_tsensor_rsqrt_q30[(d >> 28) - 4];
+
+	for (uint8_t k = 0; k < 3; k++) {
+		uint64_t xy2 = (x * ((y * y) >> 30)) >> 30;
+		y = (y * ((3ULL << 30) - xy2)) >> 31;
+	}
+
+	return (uint32_t)(((x * y) >> 30) >> shift);
+}
+
+/**
+ * @brief RTD temperature in Q16.16 degrees C from u = R / R0 - 1 in Q28
+ *
+ * At or above 0 C the CVD inverse is written as K (1 - sqrt(1 + k u)), so with the square root
+ * from _sqrt_q30() the conversion has no division, which the M0+ only has in software.
+ */
+static int32_t _rtd_q16(int32_t u) {
+	uint32_t d, s;
+	int64_t acc;
+
+	if (u >= 0) {
+		if (u > AMU_TSENSOR_CVD_U_MAX)
+			u = AMU_TSENSOR_CVD_U_MAX;
+
+		acc = (1LL << 32) + (((int64_t)AMU_TSENSOR_CVD_k_Q31 * u) >> (AMU_TSENSOR_RTD_FRAC - 1));
+		d = (acc > 0xFFFFFFFFLL) ? 0xFFFFFFFFUL : (uint32_t)acc;
+
+		s = _sqrt_q30(d);
+
+		return (int32_t)((((int64_t)(1L << 30) - s) * AMU_TSENSOR_CVD_K_Q16) >> 30);
+	}
+
+	if (u < -(1L << AMU_TSENSOR_RTD_FRAC))
+		u = -(1L << AMU_TSENSOR_RTD_FRAC);
+	u <<= (30 - AMU_TSENSOR_RTD_FRAC);
+
+	acc = amu_tsensor_low_q21[5];
+	for (int8_t k = 4; k >= 0; k--)
+		acc = (((acc * u) + (1L << 29)) >> 30) + amu_tsensor_low_q21[k];
+
+	return (int32_t)((acc + (1L << (AMU_TSENSOR_LOW_FRAC - AMU_TSENSOR_T_FRAC - 1))) >> (AMU_TSENSOR_LOW_FRAC - AMU_TSENSOR_T_FRAC));
+}
+
+/**
+ * @brief Converts a conversion for the fixed-point variant, call again whenever it changes
+ *
+ * @param fixed 		converted conversion
+ * @param cal 			conversion of the sensor type
+ * @return false if the gain, offset or fit cannot be represented
+ */
+bool amu_tsensor_fixed_init(amu_tsensor_fixed_t* fixed, const amu_tsensor_cal_t* cal) {
+	float gain = cal->gain;
+	float offset = cal->offset;
+	int8_t frac = AMU_TSENSOR_T_FRAC;
+	float scaled[4];
+	float scale = 1.0f;
+	float total = 0.0f;
+
+	if (!isfinite(gain) || !isfinite(offset))
+		return false;
+
+	memset(fixed, 0, sizeof(amu_tsensor_fixed_t));
+	fixed->type = cal->type;
+
+	if (cal->type == AMU_TSENSOR_TYPE_AD590)
+		offset -= AMU_TSENSOR_KELVIN;
+	else {
+		gain /= _rtd_r0(cal->type);
+		offset = (offset / _rtd_r0(cal->type)) - 1.0f;
+		frac = AMU_TSENSOR_RTD_FRAC;
+	}
+
+	if ((fabsf(ldexpf(gain, frac)) >= ldexpf(1.0f, 30)) || (fabsf(ldexpf(offset, frac)) >= ldexpf(1.0f, 30)))
+		return false;
+
+	// largest shift that keeps the gain below 1 << 30, codes are at most 32 bits so the product fits in 62
+	fixed->shift = 0;
+	if (gain != 0.0f) {
+		while ((fixed->shift < 60) && (fabsf(ldexpf(gain, frac + fixed->shift + 1)) < ldexpf(1.0f, 30)))
+			fixed->shift++;
+	}
+	fixed->gain = (int32_t)lroundf(ldexpf(gain, frac + fixed->shift));
+	fixed->offset = (int32_t)lroundf(ldexpf(offset, frac));
+
+	if (!_fit_enabled(&cal->fit))
+		return true;
+
+	for (uint8_t k = 0; k < 4; k++) {
+		scaled[k] = cal->fit.f[k] * scale;
+		if (!isfinite(scaled[k]))
+			return false;
+		total += fabsf(scaled[k]);
+		scale *= AMU_TSENSOR_FIT_SCALE;
+	}
+
+	if (total >= AMU_TSENSOR_FIT_LIMIT)
+		return false;
+
+	fixed->fit_frac = 30;
+	while ((fixed->fit_frac > AMU_TSENSOR_T_FRAC) && (ldexpf(total, fixed->fit_frac) >= ldexpf(1.0f, 30)))
+		fixed->fit_frac--;
+
+	for (uint8_t k = 0; k < 4; k++)
+		fixed->fit[k] = (int32_t)lroundf(ldexpf(scaled[k], fixed->fit_frac));
+
+	return true;
+}
+
+/**
+ * @brief Temperature of one raw ADC code without float operations
+ *
+ * @param fixed 		conversion from amu_tsensor_fixed_init()
+ * @param code 			raw ADC code
+ * @return int32_t Q16.16 degrees C including the fit correction
+ */
+int32_t amu_tsensor_temperature_q16(const amu_tsensor_fixed_t* fixed, int32_t code) {
+	int64_t value = (((int64_t)code * fixed->gain) >> fixed->shift) + fixed->offset;
+	int32_t t, x, acc;
+	int8_t shift;
+
+	if (value > INT32_MAX)
+		value = INT32_MAX;
+	if (value < INT32_MIN)
+		value = INT32_MIN;
+
+	if (fixed->type == AMU_TSENSOR_TYPE_AD590)
+		t = (int32_t)value;
+	else
+		t = _rtd_q16((int32_t)value);
+
+	if (fixed->fit_frac == 0)
+		return t;
+
+	// t / 1024 C in Q30
+	if (t >= (1024L << AMU_TSENSOR_T_FRAC))
+		t = (1024L << AMU_TSENSOR_T_FRAC) - 1;
+	if (t <= -(1024L << AMU_TSENSOR_T_FRAC))
+		t = -(1024L << AMU_TSENSOR_T_FRAC) + 1;
+	x = t << 4;
+
+	acc = fixed->fit[3];
+	for (int8_t k = 2; k >= 0; k--)
+		acc = (int32_t)((((int64_t)acc * x) + (1L << 29)) >> 30) + fixed->fit[k];
+
+	shift = fixed->fit_frac - AMU_TSENSOR_T_FRAC;
+	if (shift > 0)
+		acc = (acc + (1L << (shift - 1))) >> shift;
+
+	return acc;
+}
+
+/**
+ * @brief Converts the temperature sensor channels of an array of raw ADC readings without float operations
+ *
+ * @param fixed 		conversion from amu_tsensor_fixed_init()
+ * @param raw 			raw readings
+ * @param count 		number of readings
+ * @param num 			temperature sensors per reading (1-3, the tsensor_num register)
+ * @param temperature 	count * num Q16.16 temperatures, the sensors of each reading next to each other
+ */
+void amu_tsensor_convert_q16(const amu_tsensor_fixed_t* fixed, const adc_channels_t* raw, size_t count, uint8_t num, int32_t* temperature) {
+	if (num > 3)
+		num = 3;
+
+	for (size_t i = 0; i < count; i++) {
+		for (uint8_t ch = 0; ch < num; ch++)
+			*temperature++ = amu_tsensor_temperature_q16(fixed, (int32_t)raw[i].val.tsensors[ch]);
+	}
+}
@@ -0,0 +1,76 @@
+/**
+ * @file amu_tsensor.h
+ * @brief Temperature sensor conversion shared by the device and the host
+ *
+ * Converts raw ADC codes of the AMU_ADC_CH_TSENSOR0..2 channels to degrees C for every
+ * amu_tsensor_type_t. The code is first mapped linearly to ohms (RTDs) or uA (AD590, 1 uA/K).
+ * RTDs at or above 0 C use the closed form inverse of the IEC 60751 Callendar-Van Dusen equation
+ * T = 2 (x - 1) / (A (1 + sqrt(1 + 4B (x - 1) / A^2))) with x = R / R0, and below 0 C the PT100 fit
+ * -242.02 + 2.2228 r + 2.5859e-3 r^2 - 4.8260e-6 r^3 - 2.8183e-8 r^4 + 1.5243e-10 r^5 with
+ * r = 100 x, which follows the CVD C term to 0.001 C down to -200 C. Neither needs iteration. The
+ * DUT:TSENSor:FIT polynomial T = A + B*t + C*t^2 + D*t^3 is then applied to the sensor temperature t,
+ * an all zero fit leaves it unchanged.
+ *
+ * The fixed-point variant returns Q16.16 degrees C from integer operations only, for FPU-less
+ * devices. Its square root comes from a 12 entry table and three Newton steps, so it has no division
+ * either. From -200 C to 850 C it stays within 2e-5 C of a double precision evaluation, where the
+ * float variant is within 3e-4 C.
+ *
+ * @author	CJM28241
+ * @date	10/18/2026
+ */
+
+
+#ifndef __AMU_TSENSOR_H__
+#define __AMU_TSENSOR_H__
+
+#include "amu_types.h"
+#include "amu_config_internal.h"
+
+#define AMU_TSENSOR_CVD_A			3.9083e-3f
+#define AMU_TSENSOR_CVD_B			-5.775e-7f
+#define AMU_TSENSOR_KELVIN			273.15f
+
+#define AMU_TSENSOR_Q16_TO_FLOAT(q)	((float)(q) * (1.0f / 65536.0f))
+
+/**
+ * @brief Conversion of one temperature sensor type from raw ADC codes
+ */
+typedef struct {
+	uint8_t type;				/*!< amu_tsensor_type_t */
+	uint8_t reserved[3];
+	float gain;					/*!< ohm (RTD) or uA (AD590) per ADC code */
+	float offset;				/*!< ohm (RTD) or uA (AD590) at code 0 */
+	amu_coeff_t fit;			/*!< DUT:TSENSor:FIT correction, all zero for none */
+} amu_tsensor_cal_t;
+
+/**
+ * @brief amu_tsensor_cal_t converted for the fixed-point variant
+ */
+typedef struct {
+	uint8_t type;
+	int8_t shift;				/*!< code * gain >> shift + offset is R / R0 - 1 in Q28 (RTD) or degrees C in Q16 (AD590) */
+	int8_t fit_frac;			/*!< fractional bits of the fit coefficients, 0 for no fit */
+	uint8_t reserved;
+	int32_t gain;
+	int32_t offset;
+	int32_t fit[4];				/*!< fit coefficients scaled to t / 1024 C */
+} amu_tsensor_fixed_t;
+
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+	float		amu_tsensor_rtd_temperature(float resistance, float r0);
+	float		amu_tsensor_temperature(const amu_tsensor_cal_t* cal, int32_t code);
+	void		amu_tsensor_convert(const amu_tsensor_cal_t* cal, const adc_channels_t* raw, size_t count, uint8_t num, float* temperature);
+
+	bool		amu_tsensor_fixed_init(amu_tsensor_fixed_t* fixed, const amu_tsensor_cal_t* cal);
+	int32_t		amu_tsensor_temperature_q16(const amu_tsensor_fixed_t* fixed, int32_t code);
+	void		amu_tsensor_convert_q16(const amu_tsensor_fixed_t* fixed, const adc_channels_t* raw, size_t count, uint8_t num, int32_t* temperature);
+
+#ifdef	__cplusplus
+}
+#endif
+
+#endif /* __AMU_TSENSOR_H__ */
@@ -35,6 +35,14 @@
 #define AMU_TRANSFER_REG_SIZE			(IVSWEEP_MAX_POINTS * sizeof(float) * 2)
 #endif
 
+#ifdef __AMU_LOW_MEMORY__
+#define AMU_HISTORY_SIZE				16
+#else
+	#ifndef AMU_HISTORY_SIZE
+		#define AMU_HISTORY_SIZE				64
+	#endif
+#endif
+
 #define AMU_DUT_MANUFACTURER_STR_LEN	16
 #define AMU_DUT_MODEL_STR_LEN			16
 #define AMU_DUT_TECHNOLOGY_STR_LEN		16
@@ -187,6 +195,35 @@ typedef struct {
 	float area;
 } ivsweep_config_t;
 
+/**
+ * @brief Sweep configuration with 16-bit points and a microsecond delay, AMU_REG_EXT_SWEEP_CONFIG_V2
+ */
+typedef struct {
+	uint16_t version;					/*!< AMU_SWEEP_CONFIG_VERSION */
+	uint16_t numPoints;
+	uint32_t delay_us;					/*!< Settling time per point */
+	uint8_t type;
+	uint8_t ratio;
+	uint8_t power;
+	uint8_t dac_gain;
+	uint8_t sweep_averages;
+	uint8_t adc_averages;
+	uint16_t reserved;
+	float am0;
+	float area;
+} ivsweep_config_v2_t;
+
+/**
+ * @brief Features of the firmware, AMU_REG_EXT_CAPABILITIES
+ */
+typedef struct {
+	uint16_t version;					/*!< AMU_CAPABILITIES_VERSION, anything else means the register is missing */
+	uint16_t length;					/*!< sizeof(amu_capabilities_t) */
+	uint32_t flags;						/*!< AMU_CAP_* */
+	uint16_t maxPoints;					/*!< Points a sweep buffer holds */
+	uint16_t sweepConfigVersion;		/*!< Newest sweep configuration understood, 1 without AMU_CAP_SWEEP_CONFIG_V2 */
+} amu_capabilities_t;
+
 typedef struct {
 	float measurement;
 	float temperature;
@@ -212,6 +249,58 @@ typedef struct {
 	float current;
 } ivsweep_datapoint_t;
 
+typedef struct {
+	uint32_t timestamp;		/*!< device milliseconds at time of measurement */
+	uint8_t channel;		/*!< amu_adc_ch_t channel that was measured */
+	uint8_t reserved[3];
+	amu_meas_t meas;		/*!< channel measurement and DUT temperature */
+} amu_history_entry_t;
+
+typedef struct {
+	uint16_t tail;			/*!< next entry to be read, written by the host to consume entries */
+	uint16_t channels;		/*!< amu_ch_en_t mask of channels recorded each period */
+	uint32_t period;		/*!< acquisition period in milliseconds, 0 disables periodic acquisition */
+	uint16_t head;			/*!< next entry to be written, owned by the device */
+	uint16_t size;			/*!< number of entries in the history buffer */
+	uint16_t overflows;		/*!< number of entries dropped because the buffer was full */
+	uint16_t reserved;
+} amu_history_ctrl_t;
+
+typedef enum {
+	AMU_SWEEP_BUF_ACQUIRING = 0x01,		/*!< a sweep is being written into the back buffer */
+	AMU_SWEEP_BUF_READY = 0x02,			/*!< the readable buffer holds a sweep the host has not acknowledged */
+	AMU_SWEEP_BUF_DOUBLE = 0x80,		/*!< device has two sweep buffers, readout can overlap the next acquisition */
+} amu_sweep_buf_state_t;
+
+typedef struct {
+	uint16_t ack;			/*!< sequence number of the last sweep the host finished reading, written by the host */
+	uint16_t sequence;		/*!< incremented every time a completed sweep becomes readable */
+	uint8_t readable;		/*!< index of the buffer exposed through the AMU_REG_DATA_PTR sweep registers */
+	uint8_t state;			/*!< amu_sweep_buf_state_t flags */
+	uint16_t numPoints;		/*!< number of points in the readable buffer */
+	uint16_t overruns;		/*!< number of sweeps that were replaced before the host acknowledged them */
+	uint16_t reserved;
+} amu_sweep_status_t;
+
+typedef enum {
+	AMU_SWEEP_ENC_FLOAT = 0x00,			/*!< 4 byte floats, used when the other encodings would not be smaller or the data is not finite */
+	AMU_SWEEP_ENC_INT24 = 0x01,			/*!< 3 byte codes, value = offset + code * scale */
+	AMU_SWEEP_ENC_DELTA16 = 0x02,		/*!< first code as 3 bytes, then int16 residuals from the linear prediction off the previous two codes, AMU_SWEEP_DELTA16_ESCAPE followed by a 3 byte code when a residual does not fit */
+} amu_sweep_encoding_t;
+
+typedef struct {
+	uint16_t length;		/*!< total length of the encoded array including this header */
+	uint8_t encoding;		/*!< amu_sweep_encoding_t actually used, may differ from the one requested */
+	uint8_t reserved;
+	float scale;			/*!< (max - min) / AMU_SWEEP_CODE_MAX over the sweep */
+	float offset;			/*!< minimum value over the sweep */
+} amu_sweep_enc_header_t;
+
+typedef struct {
+	uint16_t reg;			/*!< register exposed through AMU_REG_DATA_PTR_EXT_DATA, 16 bits so registers past 0xFF can be addressed */
+	uint16_t offset;		/*!< byte offset into the register of the first byte read or written */
+} amu_ext_addr_t;
+
 typedef struct {
 	uint32_t timestamp[IVSWEEP_MAX_POINTS];
 	float voltage[IVSWEEP_MAX_POINTS];
@@ -242,6 +331,21 @@ typedef union {
 	uint32_t channel[16];
 } adc_channels_t;
 
+#define AMU_ADC_CODE_ZERO		0x800000L		/*!< 24-bit HRADC code of a zero input, bipolar */
+#define AMU_ADC_VREF			2.5f			/*!< HRADC reference (V), full scale of channels without a range from the device */
+
+/**
+ * @brief Scaling to convert adc_channels_t codes on the host, value = (code - AMU_ADC_CODE_ZERO) * scale
+ *
+ * The HRADC applies the offset and gain coefficients of each channel on-chip, the codes only need the
+ * bipolar zero removed and the range of the channel applied.
+ */
+typedef struct {
+	uint8_t pga[AMU_ADC_CH_NUM];			/*!< amu_adc_pga_t of each channel */
+	float full_scale[AMU_ADC_CH_NUM];		/*!< input at positive full scale with the channel PGA (V, or A for the current channel) */
+	float scale[AMU_ADC_CH_NUM];			/*!< full_scale per code */
+} amu_adc_cal_t;
+
 typedef struct {
 	float yaw;
 	float pitch;
@@ -309,11 +413,39 @@ typedef void(*amu_watchdog_fptr_t)(void);
 typedef void(*amu_watchdog_reset_fptr_t)(void);
 typedef void(*amu_hardware_reset_fptr_t)(void);
 typedef int(*amu_print_fptr_t)(const char* fmt, ...);
+typedef float(*amu_meas_ch_fptr_t)(uint8_t channel);
+typedef void(*amu_bus_recover_fptr_t)(uint8_t address);
 #if defined(ESP32)
 typedef unsigned long(*amu_milis_fptr_t)(void);
 #else
 typedef uint32_t(*amu_milis_fptr_t)(void);
 #endif
+typedef struct {
+	uint8_t max_retries;			/*!< Retries after a failed transaction, 0 disables retrying */
+	uint8_t backoff_ms;				/*!< Delay before the first retry, doubled on every retry after that */
+	uint8_t breaker_threshold;		/*!< Consecutive failed transfers before a device is taken offline, 0 disables the breaker */
+	uint8_t reserved;
+	uint16_t breaker_cooldown_ms;	/*!< Time an offline device is skipped before a single trial transfer is let through */
+} amu_retry_policy_t;
+
+typedef enum {
+	AMU_LINK_CLOSED		= 0x00,		/*!< Device is online, transfers go through */
+	AMU_LINK_OPEN		= 0x01,		/*!< Device is offline, transfers fail immediately until the cooldown expires */
+	AMU_LINK_HALF_OPEN	= 0x02,		/*!< Cooldown expired, the next transfer decides whether the device comes back */
+} amu_link_breaker_t;
+
+typedef struct {
+	uint8_t address;				/*!< TWI address of the device */
+	uint8_t breaker;				/*!< amu_link_breaker_t */
+	uint8_t failures;				/*!< Consecutive failed transfers */
+	uint8_t reserved;
+	uint16_t retries;				/*!< Total retries spent on this device */
+	uint16_t errors;				/*!< Total transfers that failed after all retries */
+	uint16_t rejected;				/*!< Total transfers rejected while the device was offline */
+	uint16_t recoveries;			/*!< Total bus recoveries attempted for this device */
+	uint32_t open_until;			/*!< millis() at which an offline device gets a trial transfer */
+} amu_link_state_t;
+
 typedef struct {
 	size_t(*write_cmd)(const char* data, size_t len);
 	void(*reset_cmd)(void);
@@ -330,6 +462,13 @@ typedef struct {
 	amu_scpi_dev_t scpi_dev;
 	/*! Read function pointer */
 	amu_transfer_fptr_t transfer;
+	/*! Largest transaction the transport can do, including the register byte on writes. Longer transfers are split
+	    into chunks through AMU_REG_DATA_PTR_EXT_ADDR/EXT_DATA, 0 sends every transfer in one transaction */
+	uint16_t max_transfer_len;
+	/*! Retry, backoff and breaker settings applied to every transfer to a remote device */
+	amu_retry_policy_t retry;
+	/*! Bus recovery function pointer, called with the failing address before the first retry (clock out SCL, reset the peripheral) */
+	amu_bus_recover_fptr_t bus_recover;
 	/*! Delay function pointer */
 	amu_delay_fptr_t delay;
 	/*! Watchdog kick function pointer */
@@ -342,6 +481,8 @@ typedef struct {
 	amu_milis_fptr_t millis;
 	/*! Function to print errors, typically used for debugging, pass through to printf typically */
 	amu_print_fptr_t print;
+	/*! Function to measure a single ADC channel, used for periodic history acquisition */
+	amu_meas_ch_fptr_t measure_channel;
 
 
 	/*! function to execute local commands */
@@ -93,9 +93,38 @@ extern "C" {
 #define USE_DEVICE_DEPENDENT_ERROR_INFORMATION SYSTEM_TYPE
 #endif
 
+/**
+ * Store device dependent error information inside the error queue entry
+ * 0 = Information is duplicated with malloc or the error info heap
+ * 1 = Information is copied into a fixed array of SCPI_ERROR_INFO_LENGTH
+ *     characters in each scpi_error_t, the error path never touches a heap
+ */
+#ifndef USE_ERROR_INFO_FIXED_STORAGE
+#define USE_ERROR_INFO_FIXED_STORAGE 0
+#endif
+
+#ifndef SCPI_ERROR_INFO_LENGTH
+#define SCPI_ERROR_INFO_LENGTH 32
+#endif
+
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
 #ifndef USE_MEMORY_ALLOCATION_FREE
-#define USE_MEMORY_ALLOCATION_FREE 1
+#define USE_MEMORY_ALLOCATION_FREE !USE_ERROR_INFO_FIXED_STORAGE
+#endif
+#endif
+
+/**
+ * Error queue indices are C11 atomics when available, so SYSTem:ERRor? can
+ * drain the queue while errors are pushed. All pushes, including the parser
+ * errors, must come from the task that calls SCPI_Input.
+ * AVR has no lock-free 16 bit atomics and falls back to volatile indices
+ * with a compiler barrier.
+ */
+#ifndef USE_C11_ATOMICS
+#if !defined(__cplusplus) && defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L) && !defined(__STDC_NO_ATOMICS__) && !defined(__AVR__)
+#define USE_C11_ATOMICS 1
+#else
+#define USE_C11_ATOMICS 0
 #endif
 #endif
 
@@ -205,7 +234,11 @@ extern "C" {
 
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
 
-  #if USE_MEMORY_ALLOCATION_FREE
+  #if USE_ERROR_INFO_FIXED_STORAGE
+    #define SCPIDEFINE_DESCRIPTION_MAX_PARTS            2
+    #define SCPIDEFINE_strndup(h, s, l)                 NULL
+    #define SCPIDEFINE_free(h, s, r)
+  #elif USE_MEMORY_ALLOCATION_FREE
     #include <stdlib.h>
     #include <string.h>
     #define SCPIDEFINE_DESCRIPTION_MAX_PARTS            2
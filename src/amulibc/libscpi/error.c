@@ -35,6 +35,7 @@
  */
 
 #include <stdint.h>
+#include <string.h>
 
 #include "parser.h"
 #include "ieee488.h"
@@ -42,7 +43,9 @@
 #include "fifo_private.h"
 #include "constants.h"
 
-#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && USE_ERROR_INFO_FIXED_STORAGE
+#define SCPI_ERROR_SETVAL(e, c, i) do { (e)->error_code = (c); (e)->device_dependent_info[0] = '\0'; (void)(i);} while(0)
+#elif USE_DEVICE_DEPENDENT_ERROR_INFORMATION
 #define SCPI_ERROR_SETVAL(e, c, i) do { (e)->error_code = (c); (e)->device_dependent_info = (i); } while(0)
 #else
 #define SCPI_ERROR_SETVAL(e, c, i) do { (e)->error_code = (c); (void)(i);} while(0)
@@ -130,8 +133,19 @@ int32_t SCPI_ErrorCount(scpi_t * context) {
 
 static scpi_bool_t SCPI_ErrorAddInternal(scpi_t * context, int16_t err, char * info, size_t info_len) {
     scpi_error_t error_value;
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && USE_ERROR_INFO_FIXED_STORAGE
+    SCPI_ERROR_SETVAL(&error_value, err, NULL);
+    if (info) {
+        if (info_len > (SCPI_ERROR_INFO_LENGTH - 1)) {
+            info_len = SCPI_ERROR_INFO_LENGTH - 1;
+        }
+        memcpy(error_value.device_dependent_info, info, info_len);
+        error_value.device_dependent_info[info_len] = '\0';
+    }
+#else
     char * info_ptr = info ? SCPIDEFINE_strndup(&context->error_info_heap, info, info_len) : NULL;
     SCPI_ERROR_SETVAL(&error_value, err, info_ptr);
+#endif
     if (!fifo_add(&context->error_queue, &error_value)) {
         SCPIDEFINE_free(&context->error_info_heap, error_value.device_dependent_info, true);
         fifo_remove_last(&context->error_queue, &error_value);
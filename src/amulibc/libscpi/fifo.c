@@ -1,26 +1,70 @@
 
 #include "fifo_private.h"
 
+/*
+ * The queue is single producer (error push) and single consumer
+ * (SYSTem:ERRor?, *CLS). The producer only stores wr and the consumer only
+ * stores rd, so no read-modify-write is ever shared and plain acquire/release
+ * loads and stores are enough. Indices run from 0 to 2 * size - 1, the
+ * difference gives the count without a shared counter. Queries load rd before
+ * wr so they are exact from the consumer side.
+ *
+ * The consumer context pushes too: parser errors and the failed device errors
+ * of _scpi_route are pushed from inside SCPI_Input. Single producer therefore
+ * means every SCPI_ErrorPush runs in the task that calls SCPI_Input. An
+ * interrupt or another task must hand its error to that task instead of
+ * pushing it directly.
+ *
+ * Without C11 atomics the indices are volatile, which orders them against each
+ * other but not against the entry data. The compiler barrier keeps the entry
+ * write before the wr store and the entry read after the wr load, which is all
+ * a single core target needs.
+ */
+#if USE_C11_ATOMICS
+#define FIFO_LOAD(v, order)         atomic_load_explicit(&(v), (order))
+#define FIFO_STORE(v, x, order)     atomic_store_explicit(&(v), (x), (order))
+#elif defined(__GNUC__)
+#define FIFO_BARRIER()              __asm__ volatile("" ::: "memory")
+#define FIFO_LOAD(v, order)         __extension__ ({ int16_t fifo_v_ = (v); FIFO_BARRIER(); fifo_v_; })
+#define FIFO_STORE(v, x, order)     do { int16_t fifo_x_ = (x); FIFO_BARRIER(); (v) = fifo_x_; } while (0)
+#else
+#define FIFO_LOAD(v, order)         (v)
+#define FIFO_STORE(v, x, order)     ((v) = (x))
+#endif
+
+static inline int16_t fifo_next(const scpi_fifo_t * fifo, int16_t i) {
+    return (i + 1 == 2 * fifo->size) ? 0 : (i + 1);
+}
+
+static inline int16_t fifo_prev(const scpi_fifo_t * fifo, int16_t i) {
+    return (i == 0) ? (2 * fifo->size - 1) : (i - 1);
+}
+
+static inline int16_t fifo_index(const scpi_fifo_t * fifo, int16_t i) {
+    return (i < fifo->size) ? i : (i - fifo->size);
+}
+
+static inline int16_t fifo_used(const scpi_fifo_t * fifo, int16_t wr, int16_t rd) {
+    return (wr >= rd) ? (wr - rd) : (2 * fifo->size - rd + wr);
+}
+
 /**
  * Initialize fifo
  * @param fifo
  */
 void fifo_init(scpi_fifo_t * fifo, scpi_error_t * data, int16_t size) {
-    fifo->wr = 0;
-    fifo->rd = 0;
-    fifo->count = 0;
     fifo->data = data;
     fifo->size = size;
+    FIFO_STORE(fifo->wr, 0, memory_order_relaxed);
+    FIFO_STORE(fifo->rd, 0, memory_order_release);
 }
 
 /**
- * Empty fifo
+ * Empty fifo, consumer side
  * @param fifo
  */
 void fifo_clear(scpi_fifo_t * fifo) {
-    fifo->wr = 0;
-    fifo->rd = 0;
-    fifo->count = 0;
+    FIFO_STORE(fifo->rd, FIFO_LOAD(fifo->wr, memory_order_acquire), memory_order_release);
 }
 
 /**
@@ -29,7 +73,9 @@ void fifo_clear(scpi_fifo_t * fifo) {
  * @return
  */
 scpi_bool_t fifo_is_empty(scpi_fifo_t * fifo) {
-    return fifo->count == 0;
+    int16_t rd = FIFO_LOAD(fifo->rd, memory_order_acquire);
+    int16_t wr = FIFO_LOAD(fifo->wr, memory_order_acquire);
+    return wr == rd;
 }
 
 /**
@@ -38,71 +84,83 @@ scpi_bool_t fifo_is_empty(scpi_fifo_t * fifo) {
  * @return
  */
 scpi_bool_t fifo_is_full(scpi_fifo_t * fifo) {
-    return fifo->count == fifo->size;
+    int16_t rd = FIFO_LOAD(fifo->rd, memory_order_acquire);
+    int16_t wr = FIFO_LOAD(fifo->wr, memory_order_acquire);
+    return fifo_used(fifo, wr, rd) == fifo->size;
 }
 
 /**
- * Add element to fifo. If fifo is full, return FALSE.
+ * Add element to fifo, producer side. If fifo is full, return FALSE.
  * @param fifo
  * @param err
  * @param info
  * @return
  */
 scpi_bool_t fifo_add(scpi_fifo_t * fifo, const scpi_error_t * value) {
+    int16_t wr = FIFO_LOAD(fifo->wr, memory_order_relaxed);
+    int16_t rd = FIFO_LOAD(fifo->rd, memory_order_acquire);
+
     /* FIFO full? */
-    if (fifo_is_full(fifo)) {
+    if (fifo_used(fifo, wr, rd) == fifo->size) {
         return FALSE;
     }
     if (!value) {
         return FALSE;
     }
 
-    fifo->data[fifo->wr] = *value;
-    fifo->wr = (fifo->wr + 1) % (fifo->size);
-    fifo->count += 1;
+    fifo->data[fifo_index(fifo, wr)] = *value;
+    FIFO_STORE(fifo->wr, fifo_next(fifo, wr), memory_order_release);
     return TRUE;
 }
 
 /**
- * Remove element form fifo
+ * Remove element form fifo, consumer side
  * @param fifo
  * @param value
  * @return FALSE - fifo is empty
  */
 scpi_bool_t fifo_remove(scpi_fifo_t * fifo, scpi_error_t * value) {
+    int16_t rd = FIFO_LOAD(fifo->rd, memory_order_relaxed);
+    int16_t wr = FIFO_LOAD(fifo->wr, memory_order_acquire);
+
     /* FIFO empty? */
-    if (fifo_is_empty(fifo)) {
+    if (wr == rd) {
         return FALSE;
     }
 
     if (value) {
-        *value = fifo->data[fifo->rd];
+        *value = fifo->data[fifo_index(fifo, rd)];
     }
 
-    fifo->rd = (fifo->rd + 1) % (fifo->size);
-    fifo->count -= 1;
+    FIFO_STORE(fifo->rd, fifo_next(fifo, rd), memory_order_release);
 
     return TRUE;
 }
 
 /**
- * Remove last element from fifo
+ * Remove last element from fifo, producer side. Used to make room for the
+ * queue overflow error, the consumer is only ever reading the oldest entry
+ * so this does not race with it unless the queue has a single entry.
  * @param fifo
  * @param value
  * @return FALSE - fifo is empty
  */
 scpi_bool_t fifo_remove_last(scpi_fifo_t * fifo, scpi_error_t * value) {
+    int16_t wr = FIFO_LOAD(fifo->wr, memory_order_relaxed);
+    int16_t rd = FIFO_LOAD(fifo->rd, memory_order_acquire);
+
     /* FIFO empty? */
-    if (fifo_is_empty(fifo)) {
+    if (wr == rd) {
         return FALSE;
     }
 
-    fifo->wr = (fifo->wr + fifo->size - 1) % (fifo->size);
+    wr = fifo_prev(fifo, wr);
 
     if (value) {
-        *value = fifo->data[fifo->wr];
+        *value = fifo->data[fifo_index(fifo, wr)];
     }
-    fifo->count -= 1;
+
+    FIFO_STORE(fifo->wr, wr, memory_order_release);
 
     return TRUE;
 }
@@ -114,6 +172,8 @@ scpi_bool_t fifo_remove_last(scpi_fifo_t * fifo, scpi_error_t * value) {
  * @return
  */
 scpi_bool_t fifo_count(scpi_fifo_t * fifo, int16_t * value) {
-    *value = fifo->count;
+    int16_t rd = FIFO_LOAD(fifo->rd, memory_order_acquire);
+    int16_t wr = FIFO_LOAD(fifo->wr, memory_order_acquire);
+    *value = fifo_used(fifo, wr, rd);
     return TRUE;
 }
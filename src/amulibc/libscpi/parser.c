@@ -363,7 +363,7 @@ void SCPI_Init(scpi_t * context,
     SCPI_ErrorInit(context, error_queue_data, error_queue_size);
 }
 
-#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE && !USE_ERROR_INFO_FIXED_STORAGE
 
 /**
  * Initialize context's
@@ -640,10 +640,14 @@ size_t SCPI_ResultError(scpi_t * context, scpi_error_t * error) {
     len[0] = strlen(data[0]);
 
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+#if USE_ERROR_INFO_FIXED_STORAGE
+    data[1] = error->device_dependent_info[0] ? error->device_dependent_info : NULL;
+    len[1] = data[1] ? strlen(data[1]) : 0;
+#elif USE_MEMORY_ALLOCATION_FREE
     data[1] = error->device_dependent_info;
-#if USE_MEMORY_ALLOCATION_FREE
     len[1] = error->device_dependent_info ? strlen(data[1]) : 0;
 #else
+    data[1] = error->device_dependent_info;
     SCPIDEFINE_get_parts(&context->error_info_heap, data[1], &len[1], &data[2], &len[2]);
 #endif
 #endif
@@ -43,6 +43,13 @@
 #include <stdint.h>
 #include "config.h"
 
+#if USE_C11_ATOMICS
+#include <stdatomic.h>
+#define SCPI_ATOMIC _Atomic
+#else
+#define SCPI_ATOMIC volatile
+#endif
+
 
 #if HAVE_STDBOOL
 #include <stdbool.h>
@@ -218,15 +225,22 @@ extern "C" {
     struct _scpi_error_t {
         int16_t error_code;
 #if USE_DEVICE_DEPENDENT_ERROR_INFORMATION
+#if USE_ERROR_INFO_FIXED_STORAGE
+        char device_dependent_info[SCPI_ERROR_INFO_LENGTH];
+#else
         char * device_dependent_info;
+#endif
 #endif
     };
     typedef struct _scpi_error_t scpi_error_t;
 
+    /* Single producer, single consumer queue. wr is only written by the
+     * producer and rd only by the consumer, both run from 0 to 2 * size - 1
+     * so a full queue can be told apart from an empty one without a shared
+     * count. C++ translation units only see the layout, never the indices. */
     struct _scpi_fifo_t {
-        int16_t wr;
-        int16_t rd;
-        int16_t count;
+        SCPI_ATOMIC int16_t wr;
+        SCPI_ATOMIC int16_t rd;
         int16_t size;
         scpi_error_t * data;
     };
@@ -382,7 +396,7 @@ extern "C" {
         int_fast16_t input_count;
         scpi_bool_t cmd_error;
         scpi_fifo_t error_queue;
-#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE
+#if USE_DEVICE_DEPENDENT_ERROR_INFORMATION && !USE_MEMORY_ALLOCATION_FREE && !USE_ERROR_INFO_FIXED_STORAGE
         scpi_error_info_heap_t error_info_heap;
 #endif
         scpi_reg_val_t registers[SCPI_REG_COUNT];
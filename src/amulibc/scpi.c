@@ -25,127 +25,206 @@ static scpi_interface_t scpi_interface;
 
 static size_t o_count = 1;
 
-#define SCPI_Param_amu_pid_t(c, v, b)		SCPI_ParamArrayFloat(c, v, 3, &o_count, SCPI_FORMAT_ASCII, b)
-#define SCPI_Result_amu_pid_t(c, v)			SCPI_ResultArrayFloat(c, (float *)&(v), 3, SCPI_FORMAT_ASCII)
+/**
+ * @brief How a register type is parsed from SCPI parameters and formatted as a SCPI result
+ */
+typedef enum {
+	SCPI_CODEC_UINT,				// unsigned integer of 1, 2 or 4 bytes
+	SCPI_CODEC_INT,					// 32-bit signed integer
+	SCPI_CODEC_FLOAT,				// single float
+	SCPI_CODEC_FLOAT_ARRAY,			// struct made up of `count` floats
+	SCPI_CODEC_TEXT,				// fixed length, null terminated string
+} scpi_codec_t;
 
-#define SCPI_Param_amu_coeff_t(c, v, b)		SCPI_ParamArrayFloat(c, v, 4, &o_count, SCPI_FORMAT_ASCII, b)
-#define SCPI_Result_amu_coeff_t(c, v)		SCPI_ResultArrayFloat(c, (float *)&(v), 4, SCPI_FORMAT_ASCII)
+/**
+ * @brief Per-type descriptor for the generic read/write handler, passed by value so it costs no RAM
+ */
+typedef struct {
+	uint8_t size;					// bytes transferred to/from the device
+	uint8_t count;					// number of elements for SCPI_CODEC_FLOAT_ARRAY
+	uint8_t codec;					// scpi_codec_t
+} scpi_type_desc_t;
 
-#define SCPI_Param_amu_notes_t(c, v, b)		SCPI_ParamCopyText(c, v, AMU_NOTES_SIZE, &o_count, b)
-#define SCPI_Result_amu_notes_t(c, v)		SCPI_ResultText(c, (char *)v)
+#define SCPI_TYPE_DESC(TYPE, COUNT, CODEC)	((scpi_type_desc_t){ sizeof(TYPE), (COUNT), (CODEC) })
 
-#define SCPI_Param_ss_angle_t(c, v, b)		SCPI_ParamArrayFloat(c, v, 6, &o_count, SCPI_FORMAT_ASCII, b)
-#define SCPI_Result_ss_angle_t(c, v)		SCPI_ResultArrayFloat(c, (float *)&(v), 6, SCPI_FORMAT_ASCII)
+amu_notes_t* notes_ptr;
 
-#define SCPI_Param_press_data_t(c, v, b)	SCPI_ParamArrayFloat(c, v, 4, &o_count, SCPI_FORMAT_ASCII, b)
-#define SCPI_Result_press_data_t(c, v)		SCPI_ResultArrayFloat(c, (float *)&(v), 4, SCPI_FORMAT_ASCII)
+/**
+ * @brief Routes a command to one device of the channel list, queueing a SCPI error if the device failed
+ *
+ * A failed device does not stop the rest of the channel list. Failed queries leave zeros in the
+ * transfer register so every device in the list still prints a result.
+ */
+static bool _scpi_route(scpi_t* context, uint8_t device, CMD_t cmd, size_t transferLen, bool query) {
 
-#define SCPI_Param_amu_int_volt_t(c, v, b)	SCPI_ParamArrayFloat(c, v, 4, &o_count, SCPI_FORMAT_ASCII, b)
-#define SCPI_Result_amu_int_volt_t(c, v)	SCPI_ResultArrayFloat(c, (float *)&(v), 4, SCPI_FORMAT_ASCII)
+	if ((cmd == (CMD_t)CMD_SYSTEM_NO_CMD) || _amu_route_command(device, cmd, transferLen, query))
+		return true;
 
-#define SCPI_Param_amu_meas_t(c, v, b)		SCPI_ParamArrayFloat(c, v, 2, &o_count, SCPI_FORMAT_ASCII, b)
-#define SCPI_Result_amu_meas_t(c, v)		SCPI_ResultArrayFloat(c, (float *)&(v), 2, SCPI_FORMAT_ASCII)
+	if (query)
+		memset((void *)scpi_amu_dev->transfer_reg, 0, (transferLen < AMU_TRANSFER_REG_SIZE) ? transferLen : AMU_TRANSFER_REG_SIZE);
 
-amu_notes_t* notes_ptr;
+#if USE_FULL_ERROR_LIST
+	if (!amu_link_is_online(amu_get_device_address(device)))
+		SCPI_ErrorPush(context, SCPI_ERROR_HARDWARE_MISSING);
+	else
+		SCPI_ErrorPush(context, SCPI_ERROR_HARDWARE_ERROR);
+#else
+	SCPI_ErrorPush(context, SCPI_ERROR_EXECUTION_ERROR);
+#endif
 
+	return false;
+}
 
-#define SCPI_CMD_RW(TYPE)																							\
+/**
+ * @brief Parses one parameter of the described type into the transfer register
+ *
+ * Integers are parsed as 32 bits and truncated to the register size, which is what the
+ * little-endian devices would have received before.
+ */
+static scpi_bool_t _scpi_param_decode(scpi_t* context, scpi_type_desc_t desc, void* dst) {
+
+	switch (desc.codec) {
+	case SCPI_CODEC_UINT: {
+		uint32_t value;
+		if (!SCPI_ParamUInt32(context, &value, TRUE)) return FALSE;
+		memcpy(dst, &value, desc.size);
+		return TRUE;
+	}
+	case SCPI_CODEC_INT: {
+		int32_t value;
+		if (!SCPI_ParamInt32(context, &value, TRUE)) return FALSE;
+		memcpy(dst, &value, desc.size);
+		return TRUE;
+	}
+	case SCPI_CODEC_FLOAT: {
+		float value;
+		if (!SCPI_ParamFloat(context, &value, TRUE)) return FALSE;
+		memcpy(dst, &value, sizeof(float));
+		return TRUE;
+	}
+	case SCPI_CODEC_FLOAT_ARRAY:
+		return SCPI_ParamArrayFloat(context, (float*)dst, desc.count, &o_count, SCPI_FORMAT_ASCII, TRUE);
+	case SCPI_CODEC_TEXT:
+		return SCPI_ParamCopyText(context, (char*)dst, desc.size, &o_count, TRUE);
+	default:
+		return FALSE;
+	}
+}
+
+/**
+ * @brief Writes the described type from the transfer register as a SCPI result
+ */
+static void _scpi_result_encode(scpi_t* context, scpi_type_desc_t desc, const void* src) {
+
+	switch (desc.codec) {
+	case SCPI_CODEC_UINT: {
+		uint32_t value = 0;
+		memcpy(&value, src, desc.size);
+		SCPI_ResultUInt32Base(context, value, 10);
+		break;
+	}
+	case SCPI_CODEC_INT: {
+		int32_t value = 0;
+		memcpy(&value, src, desc.size);
+		SCPI_ResultInt32(context, value);
+		break;
+	}
+	case SCPI_CODEC_FLOAT: {
+		float value;
+		memcpy(&value, src, sizeof(float));
+		SCPI_ResultFloat(context, value);
+		break;
+	}
+	case SCPI_CODEC_FLOAT_ARRAY:
+		SCPI_ResultArrayFloat(context, (const float*)src, desc.count, SCPI_FORMAT_ASCII);
+		break;
+	case SCPI_CODEC_TEXT:
+		SCPI_ResultText(context, (const char*)src);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * @brief Generic handler behind every scpi_cmd_rw_* and scpi_cmd_exec_qry_* command
+ *
+ * The optional command number (i.e. the channel in ADC:CH#:GAIN) goes in the first byte of the
+ * transfer register. Queries read desc.size bytes back from each device in the channel list and
+ * print them. Writes either carry a parameter (has_param) which follows the command number, or
+ * execute the command with only the command number.
+ *
+ * @param context		SCPI context
+ * @param desc			register type descriptor
+ * @param has_param		true for read/write registers, false for execute/query commands
+ * @return scpi_result_t
+ */
+static scpi_result_t _scpi_cmd_rw(scpi_t* context, scpi_type_desc_t desc, bool has_param) {
+
+	int32_t channel = -1;
+	size_t write_len;
+
+	SCPI_CommandNumbers(context, &channel, 1, -1);
+
+	memset((void *)scpi_amu_dev->transfer_reg, 0, desc.size + ((channel >= 0) ? 1 : 0));
+
+	scpi_amu_dev->transfer_reg[0] = channel;
+
+	if (has_param) {
+		if (!context->query) {
+			void* dst = (void *)&scpi_amu_dev->transfer_reg[(channel >= 0) ? 1 : 0];
+			if (!_scpi_param_decode(context, desc, dst)) return SCPI_RES_ERR;
+		}
+		write_len = desc.size + ((channel >= 0) ? 1 : 0);
+	}
+	else
+		write_len = (channel >= 0) ? 1 : 0;
+
+	_scpi_get_channelList(context);
+
+	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
+		if (context->query) {
+			if (SCPI_CmdTag(context) >= CMD_I2C_USB)
+				_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), desc.size, true);
+			else
+				_scpi_route(context, *device, SCPI_CmdTag(context), desc.size, true);
+
+			_scpi_result_encode(context, desc, (const void *)scpi_amu_dev->transfer_reg);
+		}
+		else
+			_scpi_route(context, *device, SCPI_CmdTag(context), write_len, false);
+	}
+
+	return SCPI_RES_OK;
+}
+
+#define SCPI_CMD_RW(TYPE, COUNT, CODEC)																				\
 scpi_result_t scpi_cmd_rw_##TYPE(scpi_t *context) {																	\
-																													\
-	int32_t channel = -1;																							\
-																													\
-	memset((void *)scpi_amu_dev->transfer_reg, 0, sizeof(TYPE));													\
-																													\
-	SCPI_CommandNumbers(context, &channel, 1, -1);																	\
-																													\
-	scpi_amu_dev->transfer_reg[0] = channel;																		\
-																													\
-	if(!context->query) {																							\
-		if(channel >= 0) {																							\
-			if( !SCPI_Param_##TYPE(context, (void *)&scpi_amu_dev->transfer_reg[1], TRUE)) return SCPI_RES_ERR;		\
-		}																											\
-		else {																										\
-			channel = 0;																							\
-			if( !SCPI_Param_##TYPE(context, (void *)scpi_amu_dev->transfer_reg, TRUE)) return SCPI_RES_ERR;			\
-		}																											\
-	}																												\
-	else																											\
-		channel = 0;																								\
-																													\
-	_scpi_get_channelList(context);																					\
-																													\
-	for(uint8_t *device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {							\
-		if(context->query)	{																						\
-			if( SCPI_CmdTag(context) >= CMD_I2C_USB )																\
-				_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), sizeof(TYPE), true);					\
-			else																									\
-				_amu_route_command(*device, SCPI_CmdTag(context), sizeof(TYPE), true);								\
-																													\
-			TYPE *data = (TYPE *)scpi_amu_dev->transfer_reg;														\
-			SCPI_Result_##TYPE(context, *data);																		\
-		}																											\
-		else {																										\
-			if( channel == -1)																						\
-				_amu_route_command(*device, SCPI_CmdTag(context), sizeof(TYPE), false);								\
-			else																									\
-				_amu_route_command(*device, SCPI_CmdTag(context), sizeof(TYPE) + 1, false);							\
-		}																											\
-	}																												\
-																													\
-	return SCPI_RES_OK;																								\
-}																													\
-
-SCPI_CMD_RW(uint8_t)
-SCPI_CMD_RW(uint16_t)
-SCPI_CMD_RW(uint32_t)
-SCPI_CMD_RW(int32_t)
-SCPI_CMD_RW(float)
-SCPI_CMD_RW(amu_pid_t)
-SCPI_CMD_RW(amu_coeff_t)
-SCPI_CMD_RW(amu_notes_t)
-SCPI_CMD_RW(ss_angle_t)
-SCPI_CMD_RW(press_data_t)
-SCPI_CMD_RW(amu_int_volt_t)
-SCPI_CMD_RW(amu_meas_t)
-
-#define SCPI_CMD_EXEC_QRY(TYPE)																						\
+	return _scpi_cmd_rw(context, SCPI_TYPE_DESC(TYPE, COUNT, CODEC), true);										\
+}
+
+SCPI_CMD_RW(uint8_t,		1, SCPI_CODEC_UINT)
+SCPI_CMD_RW(uint16_t,		1, SCPI_CODEC_UINT)
+SCPI_CMD_RW(uint32_t,		1, SCPI_CODEC_UINT)
+SCPI_CMD_RW(int32_t,		1, SCPI_CODEC_INT)
+SCPI_CMD_RW(float,			1, SCPI_CODEC_FLOAT)
+SCPI_CMD_RW(amu_pid_t,		3, SCPI_CODEC_FLOAT_ARRAY)
+SCPI_CMD_RW(amu_coeff_t,	4, SCPI_CODEC_FLOAT_ARRAY)
+SCPI_CMD_RW(amu_notes_t,	1, SCPI_CODEC_TEXT)
+SCPI_CMD_RW(ss_angle_t,		6, SCPI_CODEC_FLOAT_ARRAY)
+SCPI_CMD_RW(press_data_t,	4, SCPI_CODEC_FLOAT_ARRAY)
+SCPI_CMD_RW(amu_int_volt_t,	4, SCPI_CODEC_FLOAT_ARRAY)
+SCPI_CMD_RW(amu_meas_t,		2, SCPI_CODEC_FLOAT_ARRAY)
+
+#define SCPI_CMD_EXEC_QRY(TYPE, CODEC)																				\
 scpi_result_t scpi_cmd_exec_qry_##TYPE(scpi_t *context) {															\
-																													\
-	int32_t channel = -1;																							\
-																													\
-	memset((void *)scpi_amu_dev->transfer_reg, 0, sizeof(TYPE));													\
-																													\
-	SCPI_CommandNumbers(context, &channel, 1, -1);																	\
-																													\
-	scpi_amu_dev->transfer_reg[0] = channel;																		\
-																													\
-	_scpi_get_channelList(context);																					\
-																													\
-	for(uint8_t *device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {							\
-		if(context->query)	{																						\
-			if( SCPI_CmdTag(context) >= CMD_I2C_USB )																\
-				_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), sizeof(TYPE), true);					\
-			else																									\
-				_amu_route_command(*device, SCPI_CmdTag(context), sizeof(TYPE), true);								\
-																													\
-			TYPE *data = (TYPE *)scpi_amu_dev->transfer_reg;														\
-			SCPI_Result_##TYPE(context, *data);																		\
-		}																											\
-		else {																										\
-			if( channel == -1)																						\
-				_amu_route_command(*device, SCPI_CmdTag(context), 0, false);										\
-			else																									\
-				_amu_route_command(*device, SCPI_CmdTag(context), 1, false);										\
-		}																											\
-	}																												\
-																													\
-	return SCPI_RES_OK;																								\
-}																													\
-
-SCPI_CMD_EXEC_QRY(uint8_t)
-SCPI_CMD_EXEC_QRY(uint16_t)
-SCPI_CMD_EXEC_QRY(uint32_t)
-SCPI_CMD_EXEC_QRY(float)
+	return _scpi_cmd_rw(context, SCPI_TYPE_DESC(TYPE, 1, CODEC), false);											\
+}
+
+SCPI_CMD_EXEC_QRY(uint8_t,	SCPI_CODEC_UINT)
+SCPI_CMD_EXEC_QRY(uint16_t,	SCPI_CODEC_UINT)
+SCPI_CMD_EXEC_QRY(uint32_t,	SCPI_CODEC_UINT)
+SCPI_CMD_EXEC_QRY(float,	SCPI_CODEC_FLOAT)
 
 // If commmand number exists, it's placed in the first byte of the transfer register
 // NO parameters, otherwise error is thrown.
@@ -159,9 +238,9 @@ scpi_result_t scpi_cmd_execute(scpi_t* context) {
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
 		if (*commandNumber == -1)
-			_amu_route_command(*device, SCPI_CmdTag(context), 0, false);
+			_scpi_route(context, *device, SCPI_CmdTag(context), 0, false);
 		else
-			_amu_route_command(*device, SCPI_CmdTag(context), 1, false);
+			_scpi_route(context, *device, SCPI_CmdTag(context), 1, false);
 	}
 	return SCPI_RES_OK;
 }
@@ -174,37 +253,37 @@ scpi_result_t _scpi_read_ptr(scpi_t* context) {
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
 
-		_amu_route_command(*device, AMU_REG_SWEEP_CONFIG_NUM_POINTS, 1, true);
+		_scpi_route(context, *device, AMU_REG_SWEEP_CONFIG_NUM_POINTS, 1, true);
 		numPoints = scpi_amu_dev->transfer_reg[0];
 
 		switch ((AMU_REG_DATA_PTR_t)SCPI_CmdTag(context)) {
 		case AMU_REG_DATA_PTR_TIMESTAMP:
-			_amu_route_command(*device, SCPI_CmdTag(context), numPoints * sizeof(uint32_t), true);
+			_scpi_route(context, *device, SCPI_CmdTag(context), numPoints * sizeof(uint32_t), true);
 			SCPI_ResultArrayUInt32(context, (uint32_t*)&scpi_amu_dev->transfer_reg[0], numPoints, SCPI_FORMAT_ASCII);
 			break;
 		case AMU_REG_DATA_PTR_VOLTAGE:
 		case AMU_REG_DATA_PTR_CURRENT:
 		case AMU_REG_DATA_PTR_SS_YAW:
 		case AMU_REG_DATA_PTR_SS_PITCH:
-			_amu_route_command(*device, SCPI_CmdTag(context), numPoints * sizeof(float), true);
+			_scpi_route(context, *device, SCPI_CmdTag(context), numPoints * sizeof(float), true);
 			SCPI_ResultArrayFloat(context, (float*)&scpi_amu_dev->transfer_reg[0], numPoints, SCPI_FORMAT_ASCII);
 			break;
 		case AMU_REG_DATA_PTR_SWEEP_CONFIG:
-			_amu_route_command(*device, SCPI_CmdTag(context), sizeof(ivsweep_config_t), true);
+			_scpi_route(context, *device, SCPI_CmdTag(context), sizeof(ivsweep_config_t), true);
 			SCPI_ResultArrayUInt8(context, (uint8_t*)&scpi_amu_dev->transfer_reg[0], 8, SCPI_FORMAT_ASCII);
 			SCPI_ResultArrayFloat(context, (float*)&scpi_amu_dev->transfer_reg[8], 2, SCPI_FORMAT_ASCII);
 			break;
 		case AMU_REG_DATA_PTR_SWEEP_META:
-			_amu_route_command(*device, SCPI_CmdTag(context), sizeof(ivsweep_meta_t), true);
+			_scpi_route(context, *device, SCPI_CmdTag(context), sizeof(ivsweep_meta_t), true);
 			SCPI_ResultArrayFloat(context, (float*)&scpi_amu_dev->transfer_reg[0], 10, SCPI_FORMAT_ASCII);
 			SCPI_ResultArrayUInt32(context, (uint32_t*)&scpi_amu_dev->transfer_reg[40], 2, SCPI_FORMAT_ASCII);
 			break;
 		case AMU_REG_DATA_PTR_SUNSENSOR:
-			_amu_route_command(*device, SCPI_CmdTag(context), sizeof(ss_angle_t), true);
+			_scpi_route(context, *device, SCPI_CmdTag(context), sizeof(ss_angle_t), true);
 			SCPI_ResultArrayFloat(context, (float*)&scpi_amu_dev->transfer_reg[0], 2, SCPI_FORMAT_ASCII);
 			break;
 		case AMU_REG_DATA_PTR_PRESSURE:
-			_amu_route_command(*device, SCPI_CmdTag(context), sizeof(press_data_t), true);
+			_scpi_route(context, *device, SCPI_CmdTag(context), sizeof(press_data_t), true);
 			SCPI_ResultArrayFloat(context, (float*)&scpi_amu_dev->transfer_reg[0], 4, SCPI_FORMAT_ASCII);
 			break;
 		default: break;
@@ -223,7 +302,7 @@ scpi_result_t _scpi_write_sweep_ptr(scpi_t* context) {
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
 		if (o_count <= IVSWEEP_MAX_POINTS)
-			_amu_route_command(*device, SCPI_CmdTag(context), (o_count * sizeof(float)), false);
+			_scpi_route(context, *device, SCPI_CmdTag(context), (o_count * sizeof(float)), false);
 		else
 			return SCPI_RES_ERR;
 	}
@@ -250,7 +329,7 @@ scpi_result_t _scpi_write_config_ptr(scpi_t* context) {
 	}
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
-		_amu_route_command(*device, SCPI_CmdTag(context), sizeof(ivsweep_config_t), context->query);
+		_scpi_route(context, *device, SCPI_CmdTag(context), sizeof(ivsweep_config_t), context->query);
 	}
 
 	return SCPI_RES_OK;
@@ -264,7 +343,7 @@ scpi_result_t _scpi_write_meta_ptr(scpi_t* context) {
 	_scpi_get_channelList(context);
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
-		_amu_route_command(*device, SCPI_CmdTag(context), sizeof(ivsweep_meta_t), context->query);
+		_scpi_route(context, *device, SCPI_CmdTag(context), sizeof(ivsweep_meta_t), context->query);
 	}
 
 	return SCPI_RES_OK;
@@ -277,7 +356,7 @@ scpi_result_t _scpi_cmd_led(scpi_t* context) {
 	_scpi_get_channelList(context);
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
-		_amu_route_command(*device, (CMD_t)(SCPI_CmdTag(context) + scpi_amu_dev->transfer_reg[0]), sizeof(uint8_t), false);
+		_scpi_route(context, *device, (CMD_t)(SCPI_CmdTag(context) + scpi_amu_dev->transfer_reg[0]), sizeof(uint8_t), false);
 	}
 
 	return SCPI_RES_OK;
@@ -308,9 +387,9 @@ scpi_result_t _scpi_cmd_measure_channel(scpi_t* context) {
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
 
 		if (SCPI_CmdTag(context) >= CMD_I2C_USB)
-			_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), 4, true);
+			_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), 4, true);
 		else
-			_amu_route_command(*device, SCPI_CmdTag(context), 4, true);
+			_scpi_route(context, *device, SCPI_CmdTag(context), 4, true);
 
 
 		if (strstr(context->param_list.cmd_raw.data, "RAW"))
@@ -331,14 +410,14 @@ scpi_result_t _scpi_cmd_measure_active_ch(scpi_t* context) {
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
 
-		_amu_route_command(*device, AMU_REG_SYSTEM_ADC_ACTIVE_CHANNELS, sizeof(uint16_t), true);
+		_scpi_route(context, *device, AMU_REG_SYSTEM_ADC_ACTIVE_CHANNELS, sizeof(uint16_t), true);
 
 		for (uint16_t i = 0; i < 16; i++) {
 			if (*activeChannels & (1 << i))
 				numChannels++;
 		}
 
-		_amu_route_command(*device, SCPI_CmdTag(context), numChannels * 4, false);
+		_scpi_route(context, *device, SCPI_CmdTag(context), numChannels * 4, false);
 
 		if (numChannels > 0) {
 			SCPI_ResultArrayFloat(context, (float*)scpi_amu_dev->transfer_reg, numChannels, SCPI_FORMAT_ASCII);
@@ -354,7 +433,7 @@ scpi_result_t _scpi_cmd_measure_tsensors(scpi_t* context) {
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
 
-		_amu_route_command(*device, SCPI_CmdTag(context), 12, true);
+		_scpi_route(context, *device, SCPI_CmdTag(context), 12, true);
 
 		SCPI_ResultArrayFloat(context, (float*)scpi_amu_dev->transfer_reg, 3, SCPI_FORMAT_ASCII);
 	}
@@ -375,23 +454,23 @@ scpi_result_t _scpi_cmd_query_str(scpi_t* context) {
 		if (context->query) {
 			if (SCPI_CmdTag(context) >= CMD_I2C_USB) {
 				switch (SCPI_CmdTag(context)) {
-				case CMD_SYSTEM_FIRMWARE:			_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), AMU_FIRMWARE_STR_LEN, true);										break;
-				case CMD_SYSTEM_SERIAL_NUM:			_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), AMU_SERIALNUM_STR_LEN, true);									break;
-				case CMD_DUT_MANUFACTURER:			_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.manufacturer), true);			break;
-				case CMD_DUT_MODEL:					_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.model), true);				break;
-				case CMD_DUT_TECHNOLOGY:			_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.technology), true);			break;
-				case CMD_DUT_SERIAL_NUMBER:			_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.serial), true);				break;
-				case CMD_DUT_NOTES:					_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), AMU_NOTES_SIZE, true);											break;
-				default:							_amu_route_command(*device, (SCPI_CmdTag(context) | CMD_READ), AMU_TRANSFER_REG_SIZE, true);									break;
+				case CMD_SYSTEM_FIRMWARE:			_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), AMU_FIRMWARE_STR_LEN, true);										break;
+				case CMD_SYSTEM_SERIAL_NUM:			_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), AMU_SERIALNUM_STR_LEN, true);									break;
+				case CMD_DUT_MANUFACTURER:			_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.manufacturer), true);			break;
+				case CMD_DUT_MODEL:					_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.model), true);				break;
+				case CMD_DUT_TECHNOLOGY:			_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.technology), true);			break;
+				case CMD_DUT_SERIAL_NUMBER:			_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), sizeof(scpi_amu_dev->amu_regs->dut.serial), true);				break;
+				case CMD_DUT_NOTES:					_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), AMU_NOTES_SIZE, true);											break;
+				default:							_scpi_route(context, *device, (SCPI_CmdTag(context) | CMD_READ), AMU_TRANSFER_REG_SIZE, true);									break;
 				}
 			}
 			else {
 				switch (SCPI_CmdTag(context)) {
-				default:							_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->transfer_reg), true);									break;
-				case AMU_REG_DUT_MANUFACTURER:		_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.manufacturer), true);					break;
-				case AMU_REG_DUT_MODEL:				_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.model), true);							break;
-				case AMU_REG_DUT_TECHNOLOGY:		_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.technology), true);						break;
-				case AMU_REG_DUT_SERIAL_NUMBER:		_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.serial), true);							break;
+				default:							_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->transfer_reg), true);									break;
+				case AMU_REG_DUT_MANUFACTURER:		_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.manufacturer), true);					break;
+				case AMU_REG_DUT_MODEL:				_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.model), true);							break;
+				case AMU_REG_DUT_TECHNOLOGY:		_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.technology), true);						break;
+				case AMU_REG_DUT_SERIAL_NUMBER:		_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.serial), true);							break;
 				}
 			}
 
@@ -400,14 +479,14 @@ scpi_result_t _scpi_cmd_query_str(scpi_t* context) {
 		else {
 			if (SCPI_CmdTag(context) >= CMD_I2C_USB) {
 				switch (SCPI_CmdTag(context)) {
-				case CMD_SYSTEM_FIRMWARE:		_amu_route_command(*device, (SCPI_CmdTag(context)), AMU_FIRMWARE_STR_LEN, false);													break;
-				case CMD_SYSTEM_SERIAL_NUM:		_amu_route_command(*device, (SCPI_CmdTag(context)), AMU_SERIALNUM_STR_LEN, false);													break;
-				case CMD_DUT_MANUFACTURER:		_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.manufacturer), false);						break;
-				case CMD_DUT_MODEL:				_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.model), false);								break;
-				case CMD_DUT_TECHNOLOGY:		_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.technology), false);							break;
-				case CMD_DUT_SERIAL_NUMBER:		_amu_route_command(*device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.serial), false);								break;
-				case CMD_DUT_NOTES:				_amu_route_command(*device, (SCPI_CmdTag(context)), AMU_NOTES_SIZE, false);															break;
-				default:						_amu_route_command(*device, (SCPI_CmdTag(context)), AMU_TRANSFER_REG_SIZE, false);													break;
+				case CMD_SYSTEM_FIRMWARE:		_scpi_route(context, *device, (SCPI_CmdTag(context)), AMU_FIRMWARE_STR_LEN, false);													break;
+				case CMD_SYSTEM_SERIAL_NUM:		_scpi_route(context, *device, (SCPI_CmdTag(context)), AMU_SERIALNUM_STR_LEN, false);													break;
+				case CMD_DUT_MANUFACTURER:		_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.manufacturer), false);						break;
+				case CMD_DUT_MODEL:				_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.model), false);								break;
+				case CMD_DUT_TECHNOLOGY:		_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.technology), false);							break;
+				case CMD_DUT_SERIAL_NUMBER:		_scpi_route(context, *device, (SCPI_CmdTag(context)), sizeof(scpi_amu_dev->amu_regs->dut.serial), false);								break;
+				case CMD_DUT_NOTES:				_scpi_route(context, *device, (SCPI_CmdTag(context)), AMU_NOTES_SIZE, false);															break;
+				default:						_scpi_route(context, *device, (SCPI_CmdTag(context)), AMU_TRANSFER_REG_SIZE, false);													break;
 				}
 			}
 		}
@@ -426,7 +505,7 @@ scpi_result_t _scpi_cmd_twi_scan(scpi_t* context) {
 
 	for (uint8_t* device = scpi_channel_list; *device != AMU_DEVICE_END_LIST; device++) {
 		if (*device == AMU_THIS_DEVICE) {
-			_amu_route_command(*device, SCPI_CmdTag(context), sizeof(uint8_t), context->query);
+			_scpi_route(context, *device, SCPI_CmdTag(context), sizeof(uint8_t), context->query);
 			SCPI_ResultInt8(context, amu_get_num_devices());
 			for (uint8_t i = 0; i < amu_get_num_devices(); i++) {
 				if (i == AMU_THIS_DEVICE)
@@ -505,7 +584,7 @@ static scpi_result_t SCPI_Flush(scpi_t* context) {
 #endif
 
 
-#ifdef __AMU_LOW_MEMORY__
+#if defined(__AMU_LOW_MEMORY__) && !defined(__AMU_SCPI_EXTENDED_CMD_LIST__)
 	__AMU_DEFAULT_CMD_LIST__
 #else
 	__AMU_DEFAULT_CMD_LIST__
@@ -521,7 +600,7 @@ static scpi_result_t SCPI_Flush(scpi_t* context) {
 	static const scpi_command_t scpi_def_commands[] = {
 #endif
 	
-#ifdef __AMU_LOW_MEMORY__
+#if defined(__AMU_LOW_MEMORY__) && !defined(__AMU_SCPI_EXTENDED_CMD_LIST__)
 	__AMU_DEFAULT_CMD_LIST__
 	SCPI_CMD_LIST_END
 #else
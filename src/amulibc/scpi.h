@@ -13,7 +13,7 @@
 #ifndef __SCPI_H__
 #define __SCPI_H__
 
-#include "libscpi\libscpi.h"
+#include "libscpi/libscpi.h"
 #include "amu_commands.h"
 
 
@@ -31,6 +31,10 @@
 #define SCPI_USE_PROGMEM
 #endif
 
+// __AMU_LOW_MEMORY__ drops __AMU_EXTENDED_CMD_LIST__ (ADC calibration, EEPROM and raw DAC commands),
+// define __AMU_SCPI_EXTENDED_CMD_LIST__ in amulibc_config.h to keep it on parts with enough flash
+// #define __AMU_SCPI_EXTENDED_CMD_LIST__
+
 #endif
 
 